@@ -0,0 +1,1304 @@
+// Exports result sets using the Arrow C stream interface so they can be consumed by pyarrow,
+// pandas, polars, etc. without creating a Python object for every value.
+//
+// Cursor.fetch_arrow returns an ArrowStream object implementing the Arrow PyCapsule protocol
+// (__arrow_c_stream__).  Each call to the stream's get_next reads up to batch_rows rows
+// directly into Arrow buffers and returns them as a struct array with a child per column.
+//
+// The consumer can call the stream callbacks and release the arrays from any thread, so the
+// callbacks acquire the GIL before touching the cursor and all Arrow memory is allocated with
+// PyMem_RawMalloc which does not require it.
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "dbspecific.h"
+#include "getdata.h"
+#include "decimal.h"
+#include "arrow.h"
+#include <errno.h>
+
+enum ArrowKind
+{
+    AK_BOOL,
+    AK_INT32,
+    AK_UINT32,
+    AK_INT64,
+    AK_UINT64,
+    AK_DOUBLE,
+    AK_DECIMAL,
+    AK_SCALED_INT,
+    AK_DATE,
+    AK_TIME,
+    AK_SSTIME,
+    AK_TIMESTAMP,
+    AK_UUID,
+    AK_TEXT,
+    AK_BINARY
+};
+
+struct ArrowColumn
+{
+    ArrowKind kind;
+
+    SQLSMALLINT ctype;
+    // The C type the values are read as.  This matches the type GetBindType uses so the bound
+    // buffers can be read when the cursor is fetching rowsets.
+
+    const TextEnc* enc;
+    // For text and decimals, the encoding of the data read.
+
+    int width;
+    // The number of bytes per value for fixed-width types.  Zero for booleans (which are bits)
+    // and variable-length types.
+
+    char format[32];
+    // The Arrow format string.
+
+    // The buffers for the batch being built.  Ownership of these is transferred to the
+    // ArrowArray when the batch is exported.
+
+    uint8_t* validity;
+    uint8_t* values;
+    int32_t* offsets;
+    uint8_t* data;
+    int64_t cbData;
+    int64_t cbDataAlloc;
+    int64_t null_count;
+};
+
+struct ArrowStreamData
+{
+    // The private data of the ArrowArrayStreams we export.
+
+    Cursor* cur;
+
+    unsigned long result_serial;
+    // The cursor's result_serial when the stream was created.  Used to detect the cursor being
+    // re-executed while the stream is being read.
+
+    Py_ssize_t batch_rows;
+    Py_ssize_t cCols;
+    ArrowColumn* cols;
+
+    char** names;
+    // The UTF-8 column names, allocated with PyMem_RawMalloc.
+
+    Py_UCS4 chDecimal;
+    // The decimal point used when parsing decimals, set by pyodbc.setdecimalsep when the
+    // stream was created.
+
+    bool finished;
+
+    char* last_error;
+    // The message of the last error, allocated with PyMem_RawMalloc, for get_last_error.
+};
+
+struct ArrowStream
+{
+    // The Python object returned by Cursor.fetch_arrow.
+
+    PyObject_HEAD
+
+    Cursor* cur;
+    // Set to zero once __arrow_c_stream__ is called since the rows can only be read once.
+
+    Py_ssize_t batch_rows;
+};
+
+
+static char* RawStrDup(const char* sz)
+{
+    size_t cb = strlen(sz) + 1;
+    char* p = (char*)PyMem_RawMalloc(cb);
+    if (p)
+        memcpy(p, sz, cb);
+    return p;
+}
+
+
+inline void SetBit(uint8_t* bits, int64_t i)
+{
+    bits[i >> 3] |= (uint8_t)(1 << (i & 7));
+}
+
+
+static bool InitColumn(Cursor* cur, Py_ssize_t iCol, ArrowColumn& col)
+{
+    // Determines the Arrow type for a column.  Keep this in sync with GetBindType.
+    //
+    // Output converters are not used since they return Python objects.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+    Connection* cnxn = cur->cnxn;
+
+    memset(&col, 0, sizeof(col));
+
+    switch (pinfo->sql_type)
+    {
+    case SQL_BIT:
+        col.kind  = AK_BOOL;
+        col.ctype = SQL_C_BIT;
+        strcpy(col.format, "b");
+        break;
+
+    case SQL_TINYINT:
+    case SQL_SMALLINT:
+    case SQL_INTEGER:
+        col.kind  = pinfo->is_unsigned ? AK_UINT32 : AK_INT32;
+        col.ctype = pinfo->is_unsigned ? SQL_C_ULONG : SQL_C_LONG;
+        col.width = (int)sizeof(SQLINTEGER);
+        strcpy(col.format, pinfo->is_unsigned ? "I" : "i");
+        break;
+
+    case SQL_BIGINT:
+        col.kind  = pinfo->is_unsigned ? AK_UINT64 : AK_INT64;
+        col.ctype = pinfo->is_unsigned ? SQL_C_UBIGINT : SQL_C_SBIGINT;
+        col.width = (int)sizeof(SQLBIGINT);
+        strcpy(col.format, pinfo->is_unsigned ? "L" : "l");
+        break;
+
+    case SQL_REAL:
+    case SQL_FLOAT:
+    case SQL_DOUBLE:
+        col.kind  = AK_DOUBLE;
+        col.ctype = SQL_C_DOUBLE;
+        col.width = (int)sizeof(double);
+        strcpy(col.format, "g");
+        break;
+
+    case SQL_DECIMAL:
+    case SQL_NUMERIC:
+        if (cur->decimal_mode == DECIMAL_MODE_FLOAT)
+        {
+            // Bound as SQL_C_DOUBLE by GetBindType.
+            col.kind  = AK_DOUBLE;
+            col.ctype = SQL_C_DOUBLE;
+            col.width = (int)sizeof(double);
+            strcpy(col.format, "g");
+            break;
+        }
+        // Decimals are read as text like GetDataDecimal.  If the precision is too large for
+        // decimal128 (or unknown), they are returned as strings.
+        col.enc   = &cnxn->sqlwchar_enc;
+        col.ctype = cnxn->sqlwchar_enc.ctype;
+        if (cur->decimal_mode == DECIMAL_MODE_STR)
+        {
+            col.kind = AK_TEXT;
+            strcpy(col.format, "u");
+        }
+        else if (cur->decimal_mode == DECIMAL_MODE_INT)
+        {
+            // Scaled by 10**scale like GetDataDecimalInt.  Values too large for int64 raise.
+            col.kind  = AK_SCALED_INT;
+            col.width = (int)sizeof(int64_t);
+            strcpy(col.format, "l");
+        }
+        else if (pinfo->column_size > 0 && pinfo->column_size <= 38 && pinfo->decimal_digits >= 0 &&
+            (SQLULEN)pinfo->decimal_digits <= pinfo->column_size)
+        {
+            col.kind  = AK_DECIMAL;
+            col.width = 16;
+            sprintf(col.format, "d:%d,%d", (int)pinfo->column_size, (int)pinfo->decimal_digits);
+        }
+        else
+        {
+            col.kind = AK_TEXT;
+            strcpy(col.format, "u");
+        }
+        break;
+
+    case SQL_DB2_DECFLOAT:
+        col.kind  = AK_TEXT;
+        col.enc   = &cnxn->sqlwchar_enc;
+        col.ctype = cnxn->sqlwchar_enc.ctype;
+        strcpy(col.format, "u");
+        break;
+
+    case SQL_TYPE_DATE:
+    case SQL_DATE:
+        col.kind  = AK_DATE;
+        col.ctype = SQL_C_TYPE_TIMESTAMP;
+        col.width = (int)sizeof(int32_t);
+        strcpy(col.format, "tdD");
+        break;
+
+    case SQL_TYPE_TIME:
+        col.kind  = AK_TIME;
+        col.ctype = SQL_C_TYPE_TIMESTAMP;
+        col.width = (int)sizeof(int64_t);
+        strcpy(col.format, "ttu");
+        break;
+
+    case SQL_SS_TIME2:
+        col.kind  = AK_SSTIME;
+        col.ctype = SQL_C_BINARY;
+        col.width = (int)sizeof(int64_t);
+        strcpy(col.format, "ttu");
+        break;
+
+    case SQL_TYPE_TIMESTAMP:
+    case SQL_TIMESTAMP:
+        col.kind  = AK_TIMESTAMP;
+        col.ctype = SQL_C_TYPE_TIMESTAMP;
+        col.width = (int)sizeof(int64_t);
+        strcpy(col.format, "tsu:");
+        break;
+
+    case SQL_GUID:
+        if (cur->native_uuid)
+        {
+            col.kind  = AK_UUID;
+            col.ctype = SQL_GUID;
+            col.width = 16;
+            strcpy(col.format, "w:16");
+        }
+        else
+        {
+            col.kind  = AK_TEXT;
+            col.enc   = &cnxn->sqlchar_enc;
+            col.ctype = cnxn->sqlchar_enc.ctype;
+            strcpy(col.format, "u");
+        }
+        break;
+
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    case SQL_LONGVARCHAR:
+        col.kind  = AK_TEXT;
+        col.enc   = &cnxn->sqlchar_enc;
+        col.ctype = cnxn->sqlchar_enc.ctype;
+        strcpy(col.format, "u");
+        break;
+
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:
+    case SQL_WLONGVARCHAR:
+    case SQL_SS_XML:
+    case SQL_DB2_XML:
+        col.kind  = AK_TEXT;
+        col.enc   = &cnxn->sqlwchar_enc;
+        col.ctype = cnxn->sqlwchar_enc.ctype;
+        strcpy(col.format, "u");
+        break;
+
+    case SQL_BINARY:
+    case SQL_VARBINARY:
+    case SQL_LONGVARBINARY:
+        col.kind  = AK_BINARY;
+        col.ctype = SQL_C_BINARY;
+        strcpy(col.format, "z");
+        break;
+
+    default:
+        RaiseErrorV("HY106", NotSupportedError, "ODBC SQL type %d is not supported by fetch_arrow.  column-index=%zd",
+                    (int)pinfo->sql_type, iCol);
+        return false;
+    }
+
+    return true;
+}
+
+
+static void FreeBatch(ArrowColumn& col)
+{
+    PyMem_RawFree(col.validity);
+    PyMem_RawFree(col.values);
+    PyMem_RawFree(col.offsets);
+    PyMem_RawFree(col.data);
+    col.validity = 0;
+    col.values   = 0;
+    col.offsets  = 0;
+    col.data     = 0;
+}
+
+
+static bool AllocBatch(ArrowColumn& col, Py_ssize_t cRows)
+{
+    // Allocates the buffers for a batch of up to cRows rows.
+
+    col.null_count  = 0;
+    col.cbData      = 0;
+    col.cbDataAlloc = 0;
+
+    size_t cbBits = (size_t)(cRows + 7) / 8;
+    col.validity = (uint8_t*)PyMem_RawCalloc(cbBits, 1);
+
+    if (col.kind == AK_BOOL)
+    {
+        col.values = (uint8_t*)PyMem_RawCalloc(cbBits, 1);
+    }
+    else if (col.width)
+    {
+        col.values = (uint8_t*)PyMem_RawMalloc((size_t)col.width * (size_t)cRows);
+    }
+    else
+    {
+        col.offsets = (int32_t*)PyMem_RawMalloc(sizeof(int32_t) * (size_t)(cRows + 1));
+        col.cbDataAlloc = max(cRows * 16, 1024);
+        col.data = (uint8_t*)PyMem_RawMalloc((size_t)col.cbDataAlloc);
+        if (col.offsets)
+            col.offsets[0] = 0;
+    }
+
+    if (!col.validity || (!col.values && !col.data) || (col.data && !col.offsets))
+    {
+        FreeBatch(col);
+        PyErr_NoMemory();
+        return false;
+    }
+
+    return true;
+}
+
+
+static uint8_t* ReserveData(ArrowColumn& col, int64_t cbNeed)
+{
+    // Ensures there is room for cbNeed more bytes in the column's data buffer and returns a
+    // pointer to the end of the data.  The buffer grows geometrically.
+
+    if (col.cbData + cbNeed > INT32_MAX)
+    {
+        RaiseErrorV(0, DataError, "The data for an Arrow batch exceeds 2GB.  Use a smaller batch_rows.");
+        return 0;
+    }
+
+    if (col.cbData + cbNeed > col.cbDataAlloc)
+    {
+        int64_t cbNew = max(col.cbDataAlloc * 2, col.cbData + cbNeed);
+        uint8_t* pbNew = (uint8_t*)PyMem_RawRealloc(col.data, (size_t)cbNew);
+        if (!pbNew)
+        {
+            PyErr_NoMemory();
+            return 0;
+        }
+        col.data = pbNew;
+        col.cbDataAlloc = cbNew;
+    }
+
+    return &col.data[col.cbData];
+}
+
+
+static bool AppendUTF16(ArrowColumn& col, const byte* pb, Py_ssize_t cb, bool bigEndian)
+{
+    // Transcodes UTF-16 to UTF-8 directly into the data buffer.  Returns false without setting
+    // an exception if the data is not valid UTF-16 so the caller can let Python's decoder
+    // report the error.
+
+    if (cb % 2)
+        return false;
+
+    Py_ssize_t cch = cb / 2;
+    uint8_t* pDst = ReserveData(col, (int64_t)cch * 3);
+    if (!pDst)
+        return false;
+    uint8_t* pStart = pDst;
+
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        uint32_t ch = bigEndian ? (uint32_t)((pb[i*2] << 8) | pb[i*2+1]) : (uint32_t)((pb[i*2+1] << 8) | pb[i*2]);
+
+        if (ch >= 0xD800 && ch <= 0xDFFF)
+        {
+            if (ch > 0xDBFF || i + 1 >= cch)
+                return false;
+            i++;
+            uint32_t lo = bigEndian ? (uint32_t)((pb[i*2] << 8) | pb[i*2+1]) : (uint32_t)((pb[i*2+1] << 8) | pb[i*2]);
+            if (lo < 0xDC00 || lo > 0xDFFF)
+                return false;
+            ch = 0x10000 + ((ch - 0xD800) << 10) + (lo - 0xDC00);
+        }
+
+        if (ch < 0x80)
+        {
+            *pDst++ = (uint8_t)ch;
+        }
+        else if (ch < 0x800)
+        {
+            *pDst++ = (uint8_t)(0xC0 | (ch >> 6));
+            *pDst++ = (uint8_t)(0x80 | (ch & 0x3F));
+        }
+        else if (ch < 0x10000)
+        {
+            *pDst++ = (uint8_t)(0xE0 | (ch >> 12));
+            *pDst++ = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+            *pDst++ = (uint8_t)(0x80 | (ch & 0x3F));
+        }
+        else
+        {
+            // A surrogate pair is 4 bytes of UTF-16, so this fits in the 6 bytes reserved.
+            *pDst++ = (uint8_t)(0xF0 | (ch >> 18));
+            *pDst++ = (uint8_t)(0x80 | ((ch >> 12) & 0x3F));
+            *pDst++ = (uint8_t)(0x80 | ((ch >> 6) & 0x3F));
+            *pDst++ = (uint8_t)(0x80 | (ch & 0x3F));
+        }
+    }
+
+    col.cbData += (pDst - pStart);
+    return true;
+}
+
+
+static bool AppendText(ArrowColumn& col, const byte* pb, Py_ssize_t cb)
+{
+    // Appends text read using col.enc to the data buffer as UTF-8.
+
+    const TextEnc& enc = *col.enc;
+
+    switch (enc.optenc)
+    {
+    case OPTENC_UTF8:
+    {
+        uint8_t* pDst = ReserveData(col, cb);
+        if (!pDst)
+            return false;
+        memcpy(pDst, pb, (size_t)cb);
+        col.cbData += cb;
+        return true;
+    }
+
+    case OPTENC_LATIN1:
+    {
+        uint8_t* pDst = ReserveData(col, (int64_t)cb * 2);
+        if (!pDst)
+            return false;
+        uint8_t* pStart = pDst;
+        for (Py_ssize_t i = 0; i < cb; i++)
+        {
+            if (pb[i] < 0x80)
+            {
+                *pDst++ = pb[i];
+            }
+            else
+            {
+                *pDst++ = (uint8_t)(0xC0 | (pb[i] >> 6));
+                *pDst++ = (uint8_t)(0x80 | (pb[i] & 0x3F));
+            }
+        }
+        col.cbData += (pDst - pStart);
+        return true;
+    }
+
+    case OPTENC_UTF16LE:
+    case OPTENC_UTF16BE:
+        if (AppendUTF16(col, pb, cb, enc.optenc == OPTENC_UTF16BE))
+            return true;
+        if (PyErr_Occurred())
+            return false;
+        // Invalid UTF-16.  Fall through so Python's decoder raises the usual error.
+        break;
+    }
+
+    // Any other encoding (or an error) is decoded by Python.
+
+    Object str(TextBufferToObject(enc, pb, cb));
+    if (!str)
+        return false;
+
+    Py_ssize_t cbUTF8;
+    const char* pch = PyUnicode_AsUTF8AndSize(str, &cbUTF8);
+    if (!pch)
+        return false;
+
+    uint8_t* pDst = ReserveData(col, cbUTF8);
+    if (!pDst)
+        return false;
+    memcpy(pDst, pch, (size_t)cbUTF8);
+    col.cbData += cbUTF8;
+    return true;
+}
+
+
+static bool ParseDecimal128(const ArrowColumn& col, Py_UCS4 chDecimal, const byte* pb, Py_ssize_t cb, int scale,
+                            uint8_t* pOut)
+{
+    // Parses decimal text into a 128-bit two's complement integer scaled by `scale`.
+    //
+    // Like DecimalFromText, everything other than digits, the minus sign, and the decimal point
+    // is ignored so group separators and currency symbols are skipped.
+
+    const bool wide = (col.enc->ctype == SQL_C_WCHAR);
+    const bool bigEndian = (col.enc->optenc == OPTENC_UTF16BE);
+    const Py_ssize_t cch = wide ? cb / 2 : cb;
+
+    // The value in base 2^32 "limbs", least significant first.
+    uint32_t limbs[4] = { 0, 0, 0, 0 };
+    int cDigits = 0;
+    int cFraction = 0;
+    bool negative = false;
+    bool point = false;
+
+    for (Py_ssize_t i = 0; i <= cch; i++)
+    {
+        unsigned digit;
+
+        if (i < cch)
+        {
+            Py_UCS4 ch;
+            if (wide)
+                ch = bigEndian ? (Py_UCS4)((pb[i*2] << 8) | pb[i*2+1]) : (Py_UCS4)((pb[i*2+1] << 8) | pb[i*2]);
+            else
+                ch = pb[i];
+
+            if (ch == '-')
+            {
+                negative = true;
+                continue;
+            }
+
+            if (ch == chDecimal)
+            {
+                point = true;
+                continue;
+            }
+
+            if (ch < '0' || ch > '9')
+                continue;
+
+            digit = (unsigned)(ch - '0');
+
+            if (point)
+            {
+                if (cFraction == scale)
+                {
+                    // More fractional digits than the column's scale.  Trailing zeros are fine.
+                    if (digit != 0)
+                    {
+                        RaiseErrorV(0, DataError, "The decimal value has more digits than the column's scale of %d.", scale);
+                        return false;
+                    }
+                    continue;
+                }
+                cFraction++;
+            }
+        }
+        else
+        {
+            // The end of the text.  Pad with zeros up to the scale.
+            if (cFraction >= scale)
+                break;
+            digit = 0;
+            cFraction++;
+            i--;
+        }
+
+        if (cDigits == 0 && digit == 0 && !point)
+            continue;           // leading zero
+
+        if (++cDigits > 38)
+        {
+            RaiseErrorV(0, DataError, "The decimal value has more than 38 digits.");
+            return false;
+        }
+
+        // limbs = limbs * 10 + digit
+        uint64_t carry = digit;
+        for (int j = 0; j < 4; j++)
+        {
+            uint64_t n = (uint64_t)limbs[j] * 10 + carry;
+            limbs[j] = (uint32_t)n;
+            carry = n >> 32;
+        }
+    }
+
+    if (negative)
+    {
+        // Two's complement: invert and add one.
+        uint64_t carry = 1;
+        for (int j = 0; j < 4; j++)
+        {
+            uint64_t n = (uint64_t)(uint32_t)~limbs[j] + carry;
+            limbs[j] = (uint32_t)n;
+            carry = n >> 32;
+        }
+    }
+
+    for (int j = 0; j < 4; j++)
+    {
+        pOut[j*4]     = (uint8_t)(limbs[j]);
+        pOut[j*4 + 1] = (uint8_t)(limbs[j] >> 8);
+        pOut[j*4 + 2] = (uint8_t)(limbs[j] >> 16);
+        pOut[j*4 + 3] = (uint8_t)(limbs[j] >> 24);
+    }
+
+    return true;
+}
+
+
+static bool AppendValue(ArrowStreamData* p, Py_ssize_t iCol, SQLULEN iRow, int64_t iValue)
+{
+    // Reads the value of column iCol for the current row and appends it to the column's buffers
+    // at index iValue.
+
+    Cursor* cur = p->cur;
+    ArrowColumn& col = p->cols[iCol];
+    bool isNull = false;
+    uint8_t* pValue = col.width ? &col.values[(int64_t)col.width * iValue] : 0;
+
+    switch (col.kind)
+    {
+    case AK_BOOL:
+    {
+        SQLCHAR ch = 0;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &ch, sizeof(ch), isNull))
+            return false;
+        if (!isNull && ch == SQL_TRUE)
+            SetBit(col.values, iValue);
+        break;
+    }
+
+    case AK_INT32:
+    case AK_UINT32:
+    case AK_INT64:
+    case AK_UINT64:
+    case AK_DOUBLE:
+        // These are read directly into the Arrow buffer.
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, pValue, col.width, isNull))
+            return false;
+        break;
+
+    case AK_DATE:
+    case AK_TIME:
+    case AK_TIMESTAMP:
+    {
+        TIMESTAMP_STRUCT ts;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &ts, sizeof(ts), isNull))
+            return false;
+        if (isNull)
+            break;
+
+        int64_t micros = (((int64_t)ts.hour * 60 + ts.minute) * 60 + ts.second) * 1000000 + ts.fraction / 1000;
+
+        if (col.kind == AK_DATE)
+        {
+            int32_t days = (int32_t)DaysFromCivil(ts.year, ts.month, ts.day);
+            memcpy(pValue, &days, sizeof(days));
+        }
+        else if (col.kind == AK_TIME)
+        {
+            memcpy(pValue, &micros, sizeof(micros));
+        }
+        else
+        {
+            micros += DaysFromCivil(ts.year, ts.month, ts.day) * 86400 * (int64_t)1000000;
+            memcpy(pValue, &micros, sizeof(micros));
+        }
+        break;
+    }
+
+    case AK_SSTIME:
+    {
+        SQL_SS_TIME2_STRUCT t;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &t, sizeof(t), isNull))
+            return false;
+        if (!isNull)
+        {
+            int64_t micros = (((int64_t)t.hour * 60 + t.minute) * 60 + t.second) * 1000000 + t.fraction / 1000;
+            memcpy(pValue, &micros, sizeof(micros));
+        }
+        break;
+    }
+
+    case AK_UUID:
+    {
+        // SQLGUID has the first 3 fields in native byte order (the bytes_le format of
+        // uuid.UUID).  Arrow UUIDs are the 16 bytes in RFC 4122 (big endian) order.
+        PYSQLGUID guid;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &guid, sizeof(guid), isNull))
+            return false;
+        if (!isNull)
+        {
+            pValue[0] = (uint8_t)(guid.Data1 >> 24);
+            pValue[1] = (uint8_t)(guid.Data1 >> 16);
+            pValue[2] = (uint8_t)(guid.Data1 >> 8);
+            pValue[3] = (uint8_t)(guid.Data1);
+            pValue[4] = (uint8_t)(guid.Data2 >> 8);
+            pValue[5] = (uint8_t)(guid.Data2);
+            pValue[6] = (uint8_t)(guid.Data3 >> 8);
+            pValue[7] = (uint8_t)(guid.Data3);
+            memcpy(&pValue[8], guid.Data4, 8);
+        }
+        break;
+    }
+
+    case AK_DECIMAL:
+    case AK_SCALED_INT:
+    case AK_TEXT:
+    case AK_BINARY:
+    {
+        byte* pbData = 0;
+        Py_ssize_t cbData = 0;
+        if (!GetDataBuffer(cur, iCol, iRow, col.ctype, isNull, pbData, cbData))
+            return false;
+
+        if (isNull)
+            break;
+
+        if (col.kind == AK_DECIMAL)
+        {
+            if (!ParseDecimal128(col, p->chDecimal, pbData, cbData, cur->colinfos[iCol].decimal_digits, pValue))
+                return false;
+        }
+        else if (col.kind == AK_SCALED_INT)
+        {
+            // Parse the value as a decimal128 and check the upper half is only the sign of the
+            // lower half.
+            uint8_t wide[16];
+            if (!ParseDecimal128(col, p->chDecimal, pbData, cbData, max((int)cur->colinfos[iCol].decimal_digits, 0), wide))
+                return false;
+            uint8_t sign = (wide[7] & 0x80) ? 0xFF : 0;
+            for (int i = 8; i < 16; i++)
+            {
+                if (wide[i] != sign)
+                {
+                    RaiseErrorV(0, DataError, "The scaled decimal value does not fit in a 64-bit integer.");
+                    return false;
+                }
+            }
+            memcpy(pValue, wide, 8);
+        }
+        else if (col.kind == AK_TEXT)
+        {
+            if (!AppendText(col, pbData, cbData))
+                return false;
+        }
+        else
+        {
+            uint8_t* pDst = ReserveData(col, cbData);
+            if (!pDst)
+                return false;
+            memcpy(pDst, pbData, (size_t)cbData);
+            col.cbData += cbData;
+        }
+        break;
+    }
+    }
+
+    if (isNull)
+    {
+        col.null_count++;
+        if (pValue)
+            memset(pValue, 0, (size_t)col.width);
+    }
+    else
+    {
+        SetBit(col.validity, iValue);
+    }
+
+    if (col.offsets)
+        col.offsets[iValue + 1] = (int32_t)col.cbData;
+
+    return true;
+}
+
+
+static void ReleaseSchema(ArrowSchema* schema)
+{
+    // The release callback for the schemas we export.  The name and format strings and the
+    // children were allocated by us with PyMem_RawMalloc.
+
+    if (schema->children)
+    {
+        for (int64_t i = 0; i < schema->n_children; i++)
+        {
+            ArrowSchema* child = schema->children[i];
+            if (child)
+            {
+                if (child->release)
+                    child->release(child);
+                PyMem_RawFree(child);
+            }
+        }
+        PyMem_RawFree(schema->children);
+    }
+
+    PyMem_RawFree((void*)schema->format);
+    PyMem_RawFree((void*)schema->name);
+    schema->release = 0;
+}
+
+
+static void ReleaseArray(ArrowArray* array)
+{
+    // The release callback for the arrays we export.  The buffers and children were allocated
+    // with PyMem_RawMalloc.
+
+    if (array->children)
+    {
+        for (int64_t i = 0; i < array->n_children; i++)
+        {
+            ArrowArray* child = array->children[i];
+            if (child)
+            {
+                if (child->release)
+                    child->release(child);
+                PyMem_RawFree(child);
+            }
+        }
+        PyMem_RawFree(array->children);
+    }
+
+    if (array->buffers)
+    {
+        for (int64_t i = 0; i < array->n_buffers; i++)
+            PyMem_RawFree((void*)array->buffers[i]);
+        PyMem_RawFree(array->buffers);
+    }
+
+    array->release = 0;
+}
+
+
+static bool ExportSchema(ArrowStreamData* p, ArrowSchema* out)
+{
+    // The schema is a struct with a child per column.
+
+    memset(out, 0, sizeof(ArrowSchema));
+    out->release = ReleaseSchema;
+    out->format = RawStrDup("+s");
+    out->name = RawStrDup("");
+    out->children = (ArrowSchema**)PyMem_RawCalloc((size_t)max(p->cCols, 1), sizeof(ArrowSchema*));
+    if (!out->format || !out->name || !out->children)
+    {
+        ReleaseSchema(out);
+        return false;
+    }
+    out->n_children = p->cCols;
+
+    for (Py_ssize_t i = 0; i < p->cCols; i++)
+    {
+        ArrowSchema* child = (ArrowSchema*)PyMem_RawCalloc(1, sizeof(ArrowSchema));
+        out->children[i] = child;
+        if (!child)
+        {
+            ReleaseSchema(out);
+            return false;
+        }
+
+        child->release = ReleaseSchema;
+        child->flags = ARROW_FLAG_NULLABLE;
+        child->format = RawStrDup(p->cols[i].format);
+        child->name = RawStrDup(p->names[i]);
+        if (!child->format || !child->name)
+        {
+            ReleaseSchema(out);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static bool ExportBatch(ArrowStreamData* p, int64_t cRows, ArrowArray* out)
+{
+    // Moves the buffers of the batch that was just read into `out`.
+
+    memset(out, 0, sizeof(ArrowArray));
+    out->release = ReleaseArray;
+    out->length = cRows;
+    out->n_buffers = 1;
+    out->buffers = (const void**)PyMem_RawCalloc(1, sizeof(void*));
+    out->children = (ArrowArray**)PyMem_RawCalloc((size_t)max(p->cCols, 1), sizeof(ArrowArray*));
+    if (!out->buffers || !out->children)
+    {
+        ReleaseArray(out);
+        return false;
+    }
+    out->n_children = p->cCols;
+
+    for (Py_ssize_t i = 0; i < p->cCols; i++)
+    {
+        ArrowColumn& col = p->cols[i];
+
+        ArrowArray* child = (ArrowArray*)PyMem_RawCalloc(1, sizeof(ArrowArray));
+        out->children[i] = child;
+        if (!child)
+        {
+            ReleaseArray(out);
+            return false;
+        }
+
+        child->release = ReleaseArray;
+        child->n_buffers = col.offsets ? 3 : 2;
+        child->buffers = (const void**)PyMem_RawCalloc(3, sizeof(void*));
+        if (!child->buffers)
+        {
+            ReleaseArray(out);
+            return false;
+        }
+
+        child->length = cRows;
+        child->null_count = col.null_count;
+        child->buffers[0] = col.validity;
+        if (col.offsets)
+        {
+            child->buffers[1] = col.offsets;
+            child->buffers[2] = col.data;
+        }
+        else
+        {
+            child->buffers[1] = col.values;
+        }
+
+        // The array owns the buffers now.
+        col.validity = 0;
+        col.values   = 0;
+        col.offsets  = 0;
+        col.data     = 0;
+    }
+
+    return true;
+}
+
+
+static int SetLastError(ArrowStreamData* p)
+{
+    // Moves the current Python exception into last_error for get_last_error and returns the
+    // errno value for the stream callbacks.  Must be called with the GIL.
+
+    PyMem_RawFree(p->last_error);
+    p->last_error = 0;
+
+    PyObject *type, *value, *traceback;
+    PyErr_Fetch(&type, &value, &traceback);
+    if (value)
+    {
+        Object msg(PyObject_Str(value));
+        const char* sz = msg ? PyUnicode_AsUTF8(msg) : 0;
+        if (sz)
+            p->last_error = RawStrDup(sz);
+    }
+    Py_XDECREF(type);
+    Py_XDECREF(value);
+    Py_XDECREF(traceback);
+    PyErr_Clear();
+
+    return EIO;
+}
+
+
+static int Stream_get_schema(ArrowArrayStream* stream, ArrowSchema* out)
+{
+    ArrowStreamData* p = (ArrowStreamData*)stream->private_data;
+    if (!ExportSchema(p, out))
+        return ENOMEM;
+    return 0;
+}
+
+
+static int Stream_get_next(ArrowArrayStream* stream, ArrowArray* out)
+{
+    ArrowStreamData* p = (ArrowStreamData*)stream->private_data;
+
+    if (p->finished)
+    {
+        // Marks the end of the stream.
+        out->release = 0;
+        return 0;
+    }
+
+    PyGILState_STATE state = PyGILState_Ensure();
+
+    Cursor* cur = p->cur;
+    int64_t cRows = 0;
+    bool success = true;
+    Py_ssize_t iCol;
+
+    if (cur->hstmt == SQL_NULL_HANDLE || cur->cnxn == 0 || cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor was closed while reading the Arrow stream.");
+        success = false;
+    }
+    else if (cur->colinfos == 0 || cur->result_serial != p->result_serial)
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor's results changed while reading the Arrow stream.");
+        success = false;
+    }
+
+    for (iCol = 0; success && iCol < p->cCols; iCol++)
+        success = AllocBatch(p->cols[iCol], p->batch_rows);
+
+    while (success && cRows < p->batch_rows)
+    {
+        SQLULEN iRow;
+        if (!Cursor_NextRow(cur, iRow))
+        {
+            if (PyErr_Occurred())
+                success = false;
+            else
+                p->finished = true;
+            break;
+        }
+
+        for (iCol = 0; success && iCol < p->cCols; iCol++)
+            success = AppendValue(p, iCol, iRow, cRows);
+
+        cRows++;
+    }
+
+    if (success && cRows == 0)
+        out->release = 0;
+    else if (success && !ExportBatch(p, cRows, out))
+    {
+        PyErr_NoMemory();
+        success = false;
+    }
+
+    for (iCol = 0; iCol < p->cCols; iCol++)
+        FreeBatch(p->cols[iCol]);
+
+    int result = success ? 0 : SetLastError(p);
+
+    PyGILState_Release(state);
+
+    return result;
+}
+
+
+static const char* Stream_get_last_error(ArrowArrayStream* stream)
+{
+    ArrowStreamData* p = (ArrowStreamData*)stream->private_data;
+    return p->last_error;
+}
+
+
+static void FreeStreamData(ArrowStreamData* p)
+{
+    // Must be called with the GIL.
+
+    Py_XDECREF(p->cur);
+
+    if (p->cols)
+    {
+        for (Py_ssize_t i = 0; i < p->cCols; i++)
+            FreeBatch(p->cols[i]);
+        PyMem_RawFree(p->cols);
+    }
+
+    if (p->names)
+    {
+        for (Py_ssize_t i = 0; i < p->cCols; i++)
+            PyMem_RawFree(p->names[i]);
+        PyMem_RawFree(p->names);
+    }
+
+    PyMem_RawFree(p->last_error);
+    PyMem_RawFree(p);
+}
+
+
+static void Stream_release(ArrowArrayStream* stream)
+{
+    PyGILState_STATE state = PyGILState_Ensure();
+    FreeStreamData((ArrowStreamData*)stream->private_data);
+    PyGILState_Release(state);
+
+    stream->release = 0;
+}
+
+
+static void StreamCapsule_destructor(PyObject* capsule)
+{
+    ArrowArrayStream* stream = (ArrowArrayStream*)PyCapsule_GetPointer(capsule, "arrow_array_stream");
+    if (!stream)
+        return;
+
+    // If the consumer imported the stream, it moved it out and set release to zero.
+    if (stream->release)
+        stream->release(stream);
+
+    PyMem_RawFree(stream);
+}
+
+
+PyObject* Arrow_ExportStream(Cursor* cur, Py_ssize_t batch_rows)
+{
+    assert(cur->colinfos != 0);
+
+    Py_ssize_t cCols = PyTuple_GET_SIZE(cur->description);
+
+    ArrowStreamData* p = (ArrowStreamData*)PyMem_RawCalloc(1, sizeof(ArrowStreamData));
+    if (!p)
+        return PyErr_NoMemory();
+
+    Py_INCREF(cur);
+    p->cur = cur;
+    p->result_serial = cur->result_serial;
+    p->batch_rows = batch_rows;
+    p->cCols = cCols;
+    p->chDecimal = GetDecimalChar();
+    if (p->chDecimal == 0)
+        p->chDecimal = '.';
+
+    p->cols = (ArrowColumn*)PyMem_RawCalloc((size_t)max(cCols, 1), sizeof(ArrowColumn));
+    p->names = (char**)PyMem_RawCalloc((size_t)max(cCols, 1), sizeof(char*));
+    if (!p->cols || !p->names)
+    {
+        FreeStreamData(p);
+        return PyErr_NoMemory();
+    }
+
+    for (Py_ssize_t i = 0; i < cCols; i++)
+    {
+        PyObject* name = PyTuple_GET_ITEM(PyTuple_GET_ITEM(cur->description, i), 0);
+        const char* sz = PyUnicode_AsUTF8(name);
+        if (!sz || !InitColumn(cur, i, p->cols[i]))
+        {
+            FreeStreamData(p);
+            return 0;
+        }
+
+        p->names[i] = RawStrDup(sz);
+        if (!p->names[i])
+        {
+            FreeStreamData(p);
+            return PyErr_NoMemory();
+        }
+    }
+
+    ArrowArrayStream* stream = (ArrowArrayStream*)PyMem_RawCalloc(1, sizeof(ArrowArrayStream));
+    if (!stream)
+    {
+        FreeStreamData(p);
+        return PyErr_NoMemory();
+    }
+
+    stream->get_schema     = Stream_get_schema;
+    stream->get_next       = Stream_get_next;
+    stream->get_last_error = Stream_get_last_error;
+    stream->release        = Stream_release;
+    stream->private_data   = p;
+
+    PyObject* capsule = PyCapsule_New(stream, "arrow_array_stream", StreamCapsule_destructor);
+    if (!capsule)
+    {
+        FreeStreamData(p);
+        PyMem_RawFree(stream);
+        return 0;
+    }
+
+    return capsule;
+}
+
+
+PyObject* ArrowStream_New(Cursor* cur, Py_ssize_t batch_rows)
+{
+    ArrowStream* stream = PyObject_NEW(ArrowStream, &ArrowStreamType);
+    if (!stream)
+        return 0;
+
+    Py_INCREF(cur);
+    stream->cur = cur;
+    stream->batch_rows = batch_rows;
+
+    return (PyObject*)stream;
+}
+
+
+static void ArrowStream_dealloc(ArrowStream* self)
+{
+    Py_XDECREF(self->cur);
+    PyObject_Del(self);
+}
+
+
+static char arrow_c_stream_doc[] =
+    "__arrow_c_stream__(requested_schema=None) --> PyCapsule\n"
+    "\n"
+    "Exports the rows as an Arrow C stream.  The rows can only be read once.  The\n"
+    "requested_schema is ignored.";
+
+static PyObject* ArrowStream_arrow_c_stream(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static char* kwnames[] = { "requested_schema", 0 };
+    PyObject* requested_schema = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", kwnames, &requested_schema))
+        return 0;
+
+    ArrowStream* stream = (ArrowStream*)self;
+
+    if (!stream->cur)
+        return RaiseErrorV(0, ProgrammingError, "The Arrow stream has already been consumed.");
+
+    Cursor* cur = stream->cur;
+    if (cur->hstmt == SQL_NULL_HANDLE || cur->colinfos == 0)
+        return RaiseErrorV(0, ProgrammingError, "No results.  Previous SQL was not a query.");
+
+    PyObject* capsule = Arrow_ExportStream(cur, stream->batch_rows);
+    if (!capsule)
+        return 0;
+
+    stream->cur = 0;
+    Py_DECREF(cur);
+
+    return capsule;
+}
+
+
+static PyMethodDef ArrowStream_methods[] =
+{
+    { "__arrow_c_stream__", (PyCFunction)ArrowStream_arrow_c_stream, METH_VARARGS|METH_KEYWORDS, arrow_c_stream_doc },
+    { 0, 0, 0, 0 }
+};
+
+
+static char arrowstream_doc[] =
+    "The rows of a result set exported using the Arrow PyCapsule interface.  Pass\n"
+    "this to pyarrow, pandas, polars, etc.:\n"
+    "\n"
+    "  table = pyarrow.table(cursor.fetch_arrow())";
+
+PyTypeObject ArrowStreamType =
+{
+    PyVarObject_HEAD_INIT(0, 0)
+    "pyodbc.ArrowStream",                                   // tp_name
+    sizeof(ArrowStream),                                    // tp_basicsize
+    0,                                                      // tp_itemsize
+    (destructor)ArrowStream_dealloc,                        // destructor tp_dealloc
+    0,                                                      // tp_print
+    0,                                                      // tp_getattr
+    0,                                                      // tp_setattr
+    0,                                                      // tp_compare
+    0,                                                      // tp_repr
+    0,                                                      // tp_as_number
+    0,                                                      // tp_as_sequence
+    0,                                                      // tp_as_mapping
+    0,                                                      // tp_hash
+    0,                                                      // tp_call
+    0,                                                      // tp_str
+    0,                                                      // tp_getattro
+    0,                                                      // tp_setattro
+    0,                                                      // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                                     // tp_flags
+    arrowstream_doc,                                        // tp_doc
+    0,                                                      // tp_traverse
+    0,                                                      // tp_clear
+    0,                                                      // tp_richcompare
+    0,                                                      // tp_weaklistoffset
+    0,                                                      // tp_iter
+    0,                                                      // tp_iternext
+    ArrowStream_methods,                                    // tp_methods
+    0,                                                      // tp_members
+    0,                                                      // tp_getset
+    0,                                                      // tp_base
+    0,                                                      // tp_dict
+    0,                                                      // tp_descr_get
+    0,                                                      // tp_descr_set
+    0,                                                      // tp_dictoffset
+    0,                                                      // tp_init
+    0,                                                      // tp_alloc
+    0,                                                      // tp_new
+    0,                                                      // tp_free
+    0,                                                      // tp_is_gc
+    0,                                                      // tp_bases
+    0,                                                      // tp_mro
+    0,                                                      // tp_cache
+    0,                                                      // tp_subclasses
+    0,                                                      // tp_weaklist
+};
@@ -0,0 +1,93 @@
+#ifndef ARROW_H
+#define ARROW_H
+
+// The Arrow C data and stream interfaces.  These structures are a stable ABI defined by the Arrow
+// project, so they are copied here from the specification rather than requiring Arrow headers
+// to build.
+//
+// https://arrow.apache.org/docs/format/CDataInterface.html
+// https://arrow.apache.org/docs/format/CStreamInterface.html
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray
+{
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+struct ArrowArrayStream
+{
+    // Callbacks providing stream functionality
+    int (*get_schema)(struct ArrowArrayStream*, struct ArrowSchema* out);
+    int (*get_next)(struct ArrowArrayStream*, struct ArrowArray* out);
+    const char* (*get_last_error)(struct ArrowArrayStream*);
+
+    // Release callback
+    void (*release)(struct ArrowArrayStream*);
+
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif // ARROW_C_STREAM_INTERFACE
+
+struct Cursor;
+
+extern PyTypeObject ArrowStreamType;
+
+// The number of rows per record batch when the caller doesn't specify one.
+#define ARROW_DEFAULT_BATCH_ROWS 65536
+
+PyObject* ArrowStream_New(Cursor* cur, Py_ssize_t batch_rows);
+// Returns an ArrowStream object that exports the rest of the cursor's current result set when its
+// __arrow_c_stream__ method is called.
+
+PyObject* Arrow_ExportStream(Cursor* cur, Py_ssize_t batch_rows);
+// Returns an "arrow_array_stream" PyCapsule that reads the rest of the cursor's current result
+// set in record batches of up to batch_rows rows.
+
+bool ExecuteArrow(Cursor* cur, PyObject* pSql, PyObject* reader);
+// Implements Cursor.executemany_arrow: executes pSql for every row of the Arrow stream exported by
+// reader.__arrow_c_stream__(), with one SQLExecute per record batch.
+
+#endif // ARROW_H
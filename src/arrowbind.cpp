@@ -0,0 +1,864 @@
+// Implements Cursor.executemany_arrow, which executes a statement for every row of an Arrow
+// stream, such as a pyarrow Table or RecordBatchReader, using the Arrow PyCapsule interface.
+//
+// Each record batch is bound column-wise and executed with a single SQLExecute, or split into
+// slices if its converted values would not fit in fast_executemany_batch_bytes.  Integer and
+// floating point columns without nulls are bound directly to the Arrow buffers.  Other columns
+// are converted into buffers that are reused for each batch: booleans are unpacked to bytes,
+// dates and timestamps are converted to the ODBC structures, and UTF-8 text is transcoded to
+// the connection's unicode encoding.  Validity bitmaps become indicator arrays.
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "getdata.h"
+#include "params.h"
+#include "colbind.h"
+#include "arrow.h"
+
+enum ArrowParamKind
+{
+    APK_FIXED,
+    APK_BOOL,
+    APK_DATE32,
+    APK_DATE64,
+    APK_TIMESTAMP,
+    APK_TEXT,
+    APK_BINARY
+};
+
+struct ArrowParam
+{
+    ArrowParamKind kind;
+
+    int width;
+    // The number of bytes per value in the Arrow data buffer for APK_FIXED.
+
+    bool large;
+    // For text and binary, true if the offsets are 64-bit ("U" and "Z").
+
+    int64_t unit;
+    // For timestamps, the number of units per second.
+
+    ColumnParam described;
+    // The parameter's C type and the SQL type from SQLDescribeParam.  This is copied into
+    // `param` for each batch.
+
+    ColumnParam param;
+
+    uint8_t* buffer;
+    size_t cbBuffer;
+    // The converted values, reused for each batch.
+
+    SQLLEN* ind;
+    int64_t cInd;
+    // The indicators, reused for each batch.
+
+    Py_ssize_t cbMax;
+    // For text and binary, the most bytes a value of the rows counted so far by GetSliceRows
+    // could need.
+};
+
+
+static bool InitParam(Cursor* cur, Py_ssize_t index, const ArrowSchema* schema, ArrowParam& p)
+{
+    const char* format = schema->format;
+    SQLSMALLINT sqltype = 0;
+    ColumnParam& d = p.described;
+
+    if (schema->dictionary)
+    {
+        RaiseErrorV(0, PyExc_TypeError, "Column %zd is dictionary encoded, which executemany_arrow does not support", index);
+        return false;
+    }
+
+    p.kind = APK_FIXED;
+
+    if (format[0] != 0 && format[1] == 0)
+    {
+        switch (format[0])
+        {
+        case 'b':
+            p.kind = APK_BOOL;
+            d.ValueType = SQL_C_BIT;
+            sqltype = SQL_BIT;
+            break;
+
+        case 'c':
+            p.width = 1;
+            d.ValueType = SQL_C_STINYINT;
+            sqltype = SQL_SMALLINT;
+            break;
+
+        case 'C':
+            p.width = 1;
+            d.ValueType = SQL_C_UTINYINT;
+            sqltype = SQL_TINYINT;
+            break;
+
+        case 's':
+            p.width = 2;
+            d.ValueType = SQL_C_SSHORT;
+            sqltype = SQL_SMALLINT;
+            break;
+
+        case 'S':
+            p.width = 2;
+            d.ValueType = SQL_C_USHORT;
+            sqltype = SQL_INTEGER;
+            break;
+
+        case 'i':
+            p.width = 4;
+            d.ValueType = SQL_C_SLONG;
+            sqltype = SQL_INTEGER;
+            break;
+
+        case 'I':
+            p.width = 4;
+            d.ValueType = SQL_C_ULONG;
+            sqltype = SQL_BIGINT;
+            break;
+
+        case 'l':
+            p.width = 8;
+            d.ValueType = SQL_C_SBIGINT;
+            sqltype = SQL_BIGINT;
+            break;
+
+        case 'L':
+            p.width = 8;
+            d.ValueType = SQL_C_UBIGINT;
+            sqltype = SQL_BIGINT;
+            break;
+
+        case 'f':
+            p.width = 4;
+            d.ValueType = SQL_C_FLOAT;
+            sqltype = SQL_REAL;
+            break;
+
+        case 'g':
+            p.width = 8;
+            d.ValueType = SQL_C_DOUBLE;
+            sqltype = SQL_DOUBLE;
+            break;
+
+        case 'u':
+        case 'U':
+            p.kind = APK_TEXT;
+            p.large = (format[0] == 'U');
+            d.ValueType = cur->cnxn->unicode_enc.ctype;
+            sqltype = (d.ValueType == SQL_C_WCHAR) ? SQL_WVARCHAR : SQL_VARCHAR;
+            break;
+
+        case 'z':
+        case 'Z':
+            p.kind = APK_BINARY;
+            p.large = (format[0] == 'Z');
+            d.ValueType = SQL_C_BINARY;
+            sqltype = SQL_VARBINARY;
+            break;
+        }
+    }
+    else if (strcmp(format, "tdD") == 0 || strcmp(format, "tdm") == 0)
+    {
+        p.kind = (format[2] == 'D') ? APK_DATE32 : APK_DATE64;
+        d.ValueType = SQL_C_TYPE_DATE;
+        sqltype = SQL_TYPE_DATE;
+    }
+    else if (format[0] == 't' && format[1] == 's' && format[2] != 0 && format[3] == ':')
+    {
+        // Timestamps with a time zone are UTC and are passed as is.
+        static const char units[] = "smun";
+        const char* pch = strchr(units, format[2]);
+        if (pch)
+        {
+            static const int64_t perSecond[] = { 1, 1000, 1000000, 1000000000 };
+            p.kind = APK_TIMESTAMP;
+            p.unit = perSecond[pch - units];
+            d.ValueType = SQL_C_TYPE_TIMESTAMP;
+            sqltype = SQL_TYPE_TIMESTAMP;
+        }
+    }
+
+    if (sqltype == 0)
+    {
+        RaiseErrorV(0, PyExc_TypeError, "Column %zd has the Arrow format '%s', which executemany_arrow does not support",
+                    index, format);
+        return false;
+    }
+
+    if (!DescribeColumnParam(cur, index, sqltype, d))
+        return false;
+
+    if (p.kind == APK_TIMESTAMP && d.ColumnSize == 0)
+    {
+        // The driver couldn't describe the parameter, so use the precision from the connection
+        // like execute does.
+        int precision = cur->cnxn->datetime_precision;
+        d.ColumnSize = (SQLULEN)precision;
+        d.DecimalDigits = (SQLSMALLINT)max(precision - 20, 0);
+    }
+
+    switch (p.kind)
+    {
+    case APK_FIXED:
+        d.BufferLength = p.width;
+        break;
+    case APK_BOOL:
+        d.BufferLength = 1;
+        break;
+    case APK_DATE32:
+    case APK_DATE64:
+        d.BufferLength = sizeof(DATE_STRUCT);
+        break;
+    case APK_TIMESTAMP:
+        d.BufferLength = sizeof(TIMESTAMP_STRUCT);
+        break;
+    case APK_TEXT:
+    case APK_BINARY:
+        // Set for each batch from the longest value.
+        break;
+    }
+
+    return true;
+}
+
+
+static uint8_t* ReserveBuffer(ArrowParam& p, size_t cb)
+{
+    if (cb > p.cbBuffer)
+    {
+        uint8_t* pbNew = (uint8_t*)PyMem_Realloc(p.buffer, cb);
+        if (!pbNew)
+        {
+            PyErr_NoMemory();
+            return 0;
+        }
+        p.buffer = pbNew;
+        p.cbBuffer = cb;
+    }
+    return p.buffer;
+}
+
+
+static SQLLEN* ReserveIndicators(ArrowParam& p, int64_t cRows)
+{
+    if (cRows > p.cInd)
+    {
+        SQLLEN* pNew = (SQLLEN*)PyMem_Realloc(p.ind, sizeof(SQLLEN) * (size_t)cRows);
+        if (!pNew)
+        {
+            PyErr_NoMemory();
+            return 0;
+        }
+        p.ind = pNew;
+        p.cInd = cRows;
+    }
+    return p.ind;
+}
+
+
+inline bool GetBit(const uint8_t* bits, int64_t i)
+{
+    return (bits[i >> 3] >> (i & 7)) & 1;
+}
+
+
+inline int64_t GetOffset(const void* offsets, bool large, int64_t i)
+{
+    return large ? ((const int64_t*)offsets)[i] : (int64_t)((const int32_t*)offsets)[i];
+}
+
+
+static Py_ssize_t UTF8ToUTF16(const uint8_t* pb, Py_ssize_t cb, uint8_t* pDst, bool bigEndian)
+{
+    // Transcodes UTF-8 to UTF-16 and returns the number of code units written, which is never
+    // more than cb.  Returns -1 if the data is not valid UTF-8.
+
+    Py_ssize_t cUnits = 0;
+    Py_ssize_t i = 0;
+
+    while (i < cb)
+    {
+        uint32_t ch = pb[i];
+        int cbSeq;
+        uint32_t chMin;
+
+        if (ch < 0x80)
+        {
+            cbSeq = 1;
+            chMin = 0;
+        }
+        else if ((ch & 0xE0) == 0xC0)
+        {
+            cbSeq = 2;
+            chMin = 0x80;
+            ch &= 0x1F;
+        }
+        else if ((ch & 0xF0) == 0xE0)
+        {
+            cbSeq = 3;
+            chMin = 0x800;
+            ch &= 0x0F;
+        }
+        else if ((ch & 0xF8) == 0xF0)
+        {
+            cbSeq = 4;
+            chMin = 0x10000;
+            ch &= 0x07;
+        }
+        else
+        {
+            return -1;
+        }
+
+        if (i + cbSeq > cb)
+            return -1;
+
+        for (int j = 1; j < cbSeq; j++)
+        {
+            uint8_t b = pb[i + j];
+            if ((b & 0xC0) != 0x80)
+                return -1;
+            ch = (ch << 6) | (b & 0x3F);
+        }
+
+        if (ch < chMin || ch > 0x10FFFF || (ch >= 0xD800 && ch <= 0xDFFF))
+            return -1;
+
+        i += cbSeq;
+
+        uint16_t units[2];
+        int cNew = 1;
+        if (ch < 0x10000)
+        {
+            units[0] = (uint16_t)ch;
+        }
+        else
+        {
+            ch -= 0x10000;
+            units[0] = (uint16_t)(0xD800 + (ch >> 10));
+            units[1] = (uint16_t)(0xDC00 + (ch & 0x3FF));
+            cNew = 2;
+        }
+
+        for (int j = 0; j < cNew; j++)
+        {
+            if (bigEndian)
+            {
+                *pDst++ = (uint8_t)(units[j] >> 8);
+                *pDst++ = (uint8_t)units[j];
+            }
+            else
+            {
+                *pDst++ = (uint8_t)units[j];
+                *pDst++ = (uint8_t)(units[j] >> 8);
+            }
+        }
+        cUnits += cNew;
+    }
+
+    return cUnits;
+}
+
+
+static Py_ssize_t GetMaxBytesPerByte(Cursor* cur, const ArrowParam& p)
+{
+    // Returns the most bytes a text or binary value can need for each byte of its Arrow data.
+    // UTF-16 never needs more code units than UTF-8 has bytes, and no other encoding needs
+    // more bytes per character than UTF-32.
+
+    if (p.kind == APK_BINARY)
+        return 1;
+
+    switch (cur->cnxn->unicode_enc.optenc)
+    {
+    case OPTENC_UTF8:
+        return 1;
+    case OPTENC_UTF16LE:
+    case OPTENC_UTF16BE:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+
+static bool ConvertVariable(Cursor* cur, Py_ssize_t index, ArrowParam& p, const ArrowArray* child, int64_t off,
+                            int64_t cRows)
+{
+    // Copies text or binary values into fixed-width elements of p.buffer and sets the lengths
+    // in p.ind.
+
+    const uint8_t* validity = (const uint8_t*)child->buffers[0];
+    const void* offsets = child->buffers[1];
+    const uint8_t* data = (const uint8_t*)child->buffers[2];
+
+    const TextEnc& enc = cur->cnxn->unicode_enc;
+
+    int cbUnit = 1;
+    int optenc = OPTENC_UTF8;
+    if (p.kind == APK_TEXT)
+    {
+        optenc = enc.optenc;
+        if (optenc == OPTENC_UTF16LE || optenc == OPTENC_UTF16BE)
+            cbUnit = 2;
+    }
+
+    Object encoded;
+    bool direct = (p.kind == APK_BINARY || optenc == OPTENC_UTF8 || cbUnit == 2);
+
+    // Find the element width.  UTF-16 never needs more code units than UTF-8 has bytes.  Other
+    // encodings use Python's codecs, so the values are encoded up front into a list.
+
+    Py_ssize_t cbWidth = 0;
+
+    if (direct)
+    {
+        for (int64_t i = 0; i < cRows; i++)
+        {
+            if (!validity || GetBit(validity, off + i))
+                cbWidth = max(cbWidth, (Py_ssize_t)(GetOffset(offsets, p.large, off + i + 1) - GetOffset(offsets, p.large, off + i)));
+        }
+        cbWidth *= cbUnit;
+    }
+    else
+    {
+        encoded = PyList_New((Py_ssize_t)cRows);
+        if (!encoded)
+            return false;
+
+        for (int64_t i = 0; i < cRows; i++)
+        {
+            PyObject* bytes = Py_None;
+            if (!validity || GetBit(validity, off + i))
+            {
+                int64_t start = GetOffset(offsets, p.large, off + i);
+                Object str(PyUnicode_DecodeUTF8((const char*)&data[start],
+                                                (Py_ssize_t)(GetOffset(offsets, p.large, off + i + 1) - start), "strict"));
+                if (!str)
+                    return false;
+                bytes = enc.Encode(str);
+                if (!bytes)
+                    return false;
+                if (enc.optenc == OPTENC_NONE && !PyBytes_CheckExact(bytes))
+                {
+                    PyErr_Format(PyExc_TypeError, "Unicode write encoding '%s' returned unexpected data type: %s",
+                                 enc.name, bytes->ob_type->tp_name);
+                    Py_DECREF(bytes);
+                    return false;
+                }
+                cbWidth = max(cbWidth, PyBytes_GET_SIZE(bytes));
+            }
+            else
+            {
+                Py_INCREF(Py_None);
+            }
+            PyList_SET_ITEM(encoded.Get(), (Py_ssize_t)i, bytes);
+        }
+    }
+
+    // A zero-width buffer would be rejected by some drivers when every value is empty or null.
+    cbWidth = max(cbWidth, (Py_ssize_t)cbUnit);
+
+    uint8_t* pb = ReserveBuffer(p, (size_t)cbWidth * (size_t)cRows);
+    SQLLEN* ind = ReserveIndicators(p, cRows);
+    if (!pb || !ind)
+        return false;
+
+    Py_ssize_t cchMax = 0;
+
+    for (int64_t i = 0; i < cRows; i++)
+    {
+        uint8_t* pDst = &pb[cbWidth * i];
+
+        if (validity && !GetBit(validity, off + i))
+        {
+            ind[i] = SQL_NULL_DATA;
+            continue;
+        }
+
+        if (!direct)
+        {
+            PyObject* bytes = PyList_GET_ITEM(encoded.Get(), (Py_ssize_t)i);
+            Py_ssize_t cb = PyBytes_GET_SIZE(bytes);
+            memcpy(pDst, PyBytes_AS_STRING(bytes), (size_t)cb);
+            ind[i] = (SQLLEN)cb;
+            cchMax = max(cchMax, cb);
+            continue;
+        }
+
+        int64_t start = GetOffset(offsets, p.large, off + i);
+        Py_ssize_t cb = (Py_ssize_t)(GetOffset(offsets, p.large, off + i + 1) - start);
+
+        if (cbUnit == 2)
+        {
+            Py_ssize_t cUnits = UTF8ToUTF16(&data[start], cb, pDst, optenc == OPTENC_UTF16BE);
+            if (cUnits < 0)
+            {
+                // Let Python's decoder describe the error.
+                Object str(PyUnicode_DecodeUTF8((const char*)&data[start], cb, "strict"));
+                if (str)
+                    RaiseErrorV(0, PyExc_ValueError, "Column %zd contains invalid UTF-8", index);
+                return false;
+            }
+            ind[i] = (SQLLEN)(cUnits * 2);
+            cchMax = max(cchMax, cUnits);
+        }
+        else
+        {
+            memcpy(pDst, &data[start], (size_t)cb);
+            ind[i] = (SQLLEN)cb;
+            cchMax = max(cchMax, cb);
+        }
+    }
+
+    if (p.param.ColumnSize == 0)
+        p.param.ColumnSize = (SQLULEN)max(cchMax, (Py_ssize_t)1);
+
+    p.param.ParameterValuePtr = pb;
+    p.param.BufferLength = (SQLLEN)cbWidth;
+    p.param.StrLen_or_IndPtr = ind;
+    return true;
+}
+
+
+static int64_t GetSliceRows(Cursor* cur, ArrowParam* params, Py_ssize_t cParams, const ArrowArray& batch, int64_t start)
+{
+    // Returns the number of rows of the record batch, beginning with row `start`, to convert
+    // and execute together.
+    //
+    // Text and binary values are copied into elements as wide as the longest value, so a
+    // single long value would need that much memory for every row.  Like fast executemany,
+    // rows are added while the converted buffers fit in fast_executemany_batch_bytes, using
+    // the most bytes each value could be encoded as.  There is always at least one row.
+
+    int64_t cAvailable = batch.length - start;
+    Py_ssize_t cbLimit = cur->fastexecmany_batch_bytes;
+    if (cbLimit <= 0)
+        return cAvailable;
+
+    // The bytes per row of the other columns.  Directly bound columns are not copied.
+    Py_ssize_t cbFixed = 0;
+
+    for (Py_ssize_t i = 0; i < cParams; i++)
+    {
+        ArrowParam& p = params[i];
+        p.cbMax = 0;
+        if (p.kind == APK_TEXT || p.kind == APK_BINARY)
+            continue;
+        cbFixed += (Py_ssize_t)sizeof(SQLLEN);
+        if (p.kind != APK_FIXED)
+            cbFixed += (Py_ssize_t)p.described.BufferLength;
+    }
+
+    int64_t cRows = 0;
+
+    while (cRows < cAvailable)
+    {
+        // The width of a row if this one is added.
+        Py_ssize_t cbRow = cbFixed;
+
+        for (Py_ssize_t i = 0; i < cParams; i++)
+        {
+            ArrowParam& p = params[i];
+            if (p.kind != APK_TEXT && p.kind != APK_BINARY)
+                continue;
+
+            const ArrowArray* child = batch.children[i];
+            int64_t iRow = batch.offset + child->offset + start + cRows;
+            Py_ssize_t cb = (Py_ssize_t)(GetOffset(child->buffers[1], p.large, iRow + 1) - GetOffset(child->buffers[1], p.large, iRow));
+            cbRow += max(p.cbMax, cb * GetMaxBytesPerByte(cur, p)) + (Py_ssize_t)sizeof(SQLLEN);
+        }
+
+        if (cRows > 0 && cbRow * (Py_ssize_t)(cRows + 1) > cbLimit)
+            break;
+
+        for (Py_ssize_t i = 0; i < cParams; i++)
+        {
+            ArrowParam& p = params[i];
+            if (p.kind != APK_TEXT && p.kind != APK_BINARY)
+                continue;
+
+            const ArrowArray* child = batch.children[i];
+            int64_t iRow = batch.offset + child->offset + start + cRows;
+            Py_ssize_t cb = (Py_ssize_t)(GetOffset(child->buffers[1], p.large, iRow + 1) - GetOffset(child->buffers[1], p.large, iRow));
+            p.cbMax = max(p.cbMax, cb * GetMaxBytesPerByte(cur, p));
+        }
+
+        cRows++;
+    }
+
+    return cRows;
+}
+
+
+static bool ConvertColumn(Cursor* cur, Py_ssize_t index, ArrowParam& p, const ArrowArray* child, int64_t off,
+                          int64_t cRows)
+{
+    // Sets p.param to bind the values of rows [off, off+cRows) of the column.
+
+    p.param = p.described;
+
+    if (p.kind == APK_TEXT || p.kind == APK_BINARY)
+        return ConvertVariable(cur, index, p, child, off, cRows);
+
+    const uint8_t* validity = (child->null_count != 0) ? (const uint8_t*)child->buffers[0] : 0;
+    const uint8_t* values = (const uint8_t*)child->buffers[1];
+
+    if (validity)
+    {
+        SQLLEN* ind = ReserveIndicators(p, cRows);
+        if (!ind)
+            return false;
+        for (int64_t i = 0; i < cRows; i++)
+            ind[i] = GetBit(validity, off + i) ? 0 : SQL_NULL_DATA;
+        p.param.StrLen_or_IndPtr = ind;
+    }
+
+    if (p.kind == APK_FIXED)
+    {
+        // Bind directly to the Arrow buffer.
+        p.param.ParameterValuePtr = (SQLPOINTER)&values[off * p.width];
+        return true;
+    }
+
+    uint8_t* pb = ReserveBuffer(p, (size_t)p.described.BufferLength * (size_t)cRows);
+    if (!pb)
+        return false;
+    p.param.ParameterValuePtr = pb;
+
+    switch (p.kind)
+    {
+    case APK_BOOL:
+        for (int64_t i = 0; i < cRows; i++)
+            pb[i] = GetBit(values, off + i);
+        break;
+
+    case APK_DATE32:
+    case APK_DATE64:
+    {
+        DATE_STRUCT* pDates = (DATE_STRUCT*)pb;
+        for (int64_t i = 0; i < cRows; i++)
+        {
+            int64_t days;
+            if (p.kind == APK_DATE32)
+            {
+                days = ((const int32_t*)values)[off + i];
+            }
+            else
+            {
+                int64_t ms = ((const int64_t*)values)[off + i];
+                days = ms / 86400000 - (ms % 86400000 < 0);
+            }
+
+            int64_t year;
+            unsigned month, day;
+            CivilFromDays(days, year, month, day);
+            pDates[i].year  = (SQLSMALLINT)year;
+            pDates[i].month = (SQLUSMALLINT)month;
+            pDates[i].day   = (SQLUSMALLINT)day;
+        }
+        break;
+    }
+
+    case APK_TIMESTAMP:
+    {
+        // SQL Server chokes if the fraction has more digits than the column supports, so the
+        // fraction is truncated to the parameter's precision like the other parameter code.
+        static const SQLUINTEGER pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+        SQLUINTEGER keep = pow10[9 - min(9, max((int)p.param.DecimalDigits, 0))];
+
+        TIMESTAMP_STRUCT* pts = (TIMESTAMP_STRUCT*)pb;
+        for (int64_t i = 0; i < cRows; i++)
+        {
+            int64_t value = ((const int64_t*)values)[off + i];
+
+            int64_t seconds = value / p.unit;
+            int64_t sub = value % p.unit;
+            if (sub < 0)
+            {
+                sub += p.unit;
+                seconds--;
+            }
+
+            int64_t days = seconds / 86400;
+            int64_t secondOfDay = seconds % 86400;
+            if (secondOfDay < 0)
+            {
+                secondOfDay += 86400;
+                days--;
+            }
+
+            int64_t year;
+            unsigned month, day;
+            CivilFromDays(days, year, month, day);
+
+            SQLUINTEGER fraction = (SQLUINTEGER)(sub * (1000000000 / p.unit));
+
+            pts[i].year     = (SQLSMALLINT)year;
+            pts[i].month    = (SQLUSMALLINT)month;
+            pts[i].day      = (SQLUSMALLINT)day;
+            pts[i].hour     = (SQLUSMALLINT)(secondOfDay / 3600);
+            pts[i].minute   = (SQLUSMALLINT)(secondOfDay / 60 % 60);
+            pts[i].second   = (SQLUSMALLINT)(secondOfDay % 60);
+            pts[i].fraction = fraction - fraction % keep;
+        }
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return true;
+}
+
+
+static void RaiseStreamError(ArrowArrayStream* stream, const char* szFunction)
+{
+    const char* szError = stream->get_last_error(stream);
+    RaiseErrorV(0, PyExc_RuntimeError, "The Arrow stream's %s failed: %s", szFunction, szError ? szError : "unknown error");
+}
+
+
+bool ExecuteArrow(Cursor* cur, PyObject* pSql, PyObject* reader)
+{
+    Object capsule(PyObject_CallMethod(reader, "__arrow_c_stream__", 0));
+    if (!capsule)
+        return false;
+
+    ArrowArrayStream* pCapsuleStream = (ArrowArrayStream*)PyCapsule_GetPointer(capsule, "arrow_array_stream");
+    if (!pCapsuleStream)
+        return false;
+
+    if (!pCapsuleStream->release)
+    {
+        PyErr_SetString(PyExc_ValueError, "The Arrow stream has already been consumed.");
+        return false;
+    }
+
+    // Move the stream out of the capsule so we are responsible for releasing it.
+    ArrowArrayStream stream = *pCapsuleStream;
+    pCapsuleStream->release = 0;
+
+    ArrowSchema schema;
+    memset(&schema, 0, sizeof(schema));
+
+    ArrowParam* params = 0;
+    ColumnParam* bind = 0;
+    Py_ssize_t cParams = 0;
+    SQLLEN rowcount = 0;
+    bool success = false;
+    Py_ssize_t i;
+
+    if (stream.get_schema(&stream, &schema) != 0)
+    {
+        RaiseStreamError(&stream, "get_schema");
+        goto done;
+    }
+
+    if (strcmp(schema.format, "+s") != 0)
+    {
+        RaiseErrorV(0, PyExc_TypeError, "The Arrow stream must contain record batches (a struct), not '%s'", schema.format);
+        goto done;
+    }
+
+    if (!Prepare(cur, pSql))
+        goto done;
+
+    if (schema.n_children != cur->paramcount)
+    {
+        RaiseErrorV(0, ProgrammingError, "Expected %d parameters, supplied %zd", (int)cur->paramcount, (Py_ssize_t)schema.n_children);
+        goto done;
+    }
+
+    cParams = cur->paramcount;
+    if (cParams == 0)
+    {
+        PyErr_SetString(ProgrammingError, "executemany_arrow requires a statement with parameters.");
+        goto done;
+    }
+
+    params = (ArrowParam*)PyMem_Malloc(sizeof(ArrowParam) * cParams);
+    bind = (ColumnParam*)PyMem_Malloc(sizeof(ColumnParam) * cParams);
+    if (!params || !bind)
+    {
+        PyErr_NoMemory();
+        goto done;
+    }
+    memset(params, 0, sizeof(ArrowParam) * cParams);
+
+    for (i = 0; i < cParams; i++)
+    {
+        if (!InitParam(cur, i, schema.children[i], params[i]))
+            goto done;
+    }
+
+    for (;;)
+    {
+        ArrowArray batch;
+        memset(&batch, 0, sizeof(batch));
+
+        if (stream.get_next(&stream, &batch) != 0)
+        {
+            RaiseStreamError(&stream, "get_next");
+            goto done;
+        }
+
+        if (!batch.release)
+            break;              // end of stream
+
+        bool ok = true;
+        int64_t start = 0;
+
+        while (ok && start < batch.length)
+        {
+            int64_t cRows = GetSliceRows(cur, params, cParams, batch, start);
+
+            for (i = 0; ok && i < cParams; i++)
+            {
+                ok = ConvertColumn(cur, i, params[i], batch.children[i], batch.offset + batch.children[i]->offset + start, cRows);
+                bind[i] = params[i].param;
+            }
+
+            if (ok)
+                ok = ExecuteColumnParams(cur, bind, (SQLULEN)cRows, rowcount);
+
+            start += cRows;
+        }
+
+        batch.release(&batch);
+
+        if (!ok)
+            goto done;
+    }
+
+    // The total of every slice, or -1 if the driver didn't know the count for any of them.
+    cur->rowcount = (int)rowcount;
+    success = true;
+
+  done:
+    if (params)
+    {
+        for (i = 0; i < cParams; i++)
+        {
+            PyMem_Free(params[i].buffer);
+            PyMem_Free(params[i].ind);
+        }
+    }
+    PyMem_Free(params);
+    PyMem_Free(bind);
+
+    if (schema.release)
+        schema.release(&schema);
+    stream.release(&stream);
+
+    return success;
+}
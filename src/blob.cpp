@@ -0,0 +1,359 @@
+// Implements the file-like object returned by Cursor.open_blob, which streams a long value from
+// the current row with chunked SQLGetData calls instead of reading the whole value into memory.
+//
+// The value is read as SQL_C_BINARY, so text columns are returned as bytes in the encoding the
+// database stores them in (UTF-16LE for SQL Server nvarchar columns).
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "blob.h"
+
+struct BlobReader
+{
+    PyObject_HEAD
+
+    Cursor* cur;
+    // Zero once the reader is closed.
+
+    Py_ssize_t iCol;
+
+    unsigned long row_serial;
+    // The cursor's row_serial when the reader was created.  If the cursor has moved since then,
+    // the row is gone.
+
+    PyObject* values;
+    // A tuple of the values of the columns before iCol.
+
+    bool eof;
+};
+
+// The size of the chunks read by read() when reading the rest of the value.
+static const Py_ssize_t READ_CHUNK = 64 * 1024;
+
+
+PyObject* BlobReader_New(Cursor* cur, Py_ssize_t iCol, PyObject* values)
+{
+    BlobReader* reader = PyObject_NEW(BlobReader, &BlobReaderType);
+    if (!reader)
+    {
+        Py_DECREF(values);
+        return 0;
+    }
+
+    Py_INCREF(cur);
+    reader->cur        = cur;
+    reader->iCol       = iCol;
+    reader->row_serial = cur->row_serial;
+    reader->values     = values;
+    reader->eof        = false;
+
+    return (PyObject*)reader;
+}
+
+
+static void BlobReader_dealloc(BlobReader* self)
+{
+    Py_XDECREF(self->cur);
+    Py_XDECREF(self->values);
+    PyObject_Del(self);
+}
+
+
+static Cursor* BlobReader_Validate(BlobReader* self)
+{
+    // Returns the cursor if the reader can still read its value.  Otherwise an exception is set
+    // and zero is returned.
+
+    Cursor* cur = self->cur;
+
+    if (!cur)
+    {
+        PyErr_SetString(PyExc_ValueError, "I/O operation on closed BlobReader.");
+        return 0;
+    }
+
+    if (cur->hstmt == SQL_NULL_HANDLE || cur->cnxn->hdbc == SQL_NULL_HANDLE || cur->row_serial != self->row_serial)
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor has moved past the row the BlobReader was opened for.");
+        return 0;
+    }
+
+    return cur;
+}
+
+
+static bool ReadChunk(BlobReader* self, Cursor* cur, char* pb, Py_ssize_t cb, Py_ssize_t& cbRead)
+{
+    // Reads up to cb bytes of the value into pb with the GIL released and sets cbRead to the
+    // number of bytes read, which is only less than cb at the end of the value.
+    //
+    // Returns false if an error occurs, in which case an exception is set.
+
+    cbRead = 0;
+
+    if (self->eof || cb == 0)
+        return true;
+
+    SQLLEN cbData = 0;
+    SQLRETURN ret;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(self->iCol + 1), SQL_C_BINARY, pb, (SQLLEN)cb, &cbData);
+    Py_END_ALLOW_THREADS
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (ret == SQL_NO_DATA || cbData == SQL_NULL_DATA)
+    {
+        // A null value reads like an empty one.
+        self->eof = true;
+        return true;
+    }
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    if (ret == SQL_SUCCESS_WITH_INFO && (cbData == SQL_NO_TOTAL || (Py_ssize_t)cbData >= cb))
+    {
+        // The buffer was filled and there is more.  Binary data has no null terminator.
+        cbRead = cb;
+    }
+    else
+    {
+        cbRead = (Py_ssize_t)cbData;
+        self->eof = true;
+    }
+
+    return true;
+}
+
+
+static char readinto_doc[] =
+    "readinto(buffer) --> int\n"
+    "\n"
+    "Reads bytes into a writable buffer, such as a bytearray or memoryview, and\n"
+    "returns the number of bytes read.  Returns 0 at the end of the value.";
+
+static PyObject* BlobReader_readinto(PyObject* self, PyObject* args)
+{
+    BlobReader* reader = (BlobReader*)self;
+
+    Py_buffer buffer;
+    if (!PyArg_ParseTuple(args, "w*", &buffer))
+        return 0;
+
+    Cursor* cur = BlobReader_Validate(reader);
+    Py_ssize_t cbRead = 0;
+    bool success = cur && ReadChunk(reader, cur, (char*)buffer.buf, buffer.len, cbRead);
+
+    PyBuffer_Release(&buffer);
+
+    if (!success)
+        return 0;
+
+    return PyLong_FromSsize_t(cbRead);
+}
+
+
+static char read_doc[] =
+    "read(size=-1) --> bytes\n"
+    "\n"
+    "Reads up to size bytes, or the rest of the value if size is negative or\n"
+    "omitted.  Returns an empty bytes object at the end of the value.";
+
+static PyObject* BlobReader_read(PyObject* self, PyObject* args)
+{
+    BlobReader* reader = (BlobReader*)self;
+
+    Py_ssize_t size = -1;
+    if (!PyArg_ParseTuple(args, "|n", &size))
+        return 0;
+
+    Cursor* cur = BlobReader_Validate(reader);
+    if (!cur)
+        return 0;
+
+    Py_ssize_t cbAlloc = (size >= 0) ? size : READ_CHUNK;
+    PyObject* result = PyBytes_FromStringAndSize(0, cbAlloc);
+    if (!result)
+        return 0;
+
+    Py_ssize_t cbUsed = 0;
+
+    for (;;)
+    {
+        Py_ssize_t cbRead;
+        if (!ReadChunk(reader, cur, PyBytes_AS_STRING(result) + cbUsed, cbAlloc - cbUsed, cbRead))
+        {
+            Py_DECREF(result);
+            return 0;
+        }
+        cbUsed += cbRead;
+
+        if (size >= 0 || reader->eof)
+            break;
+
+        if (cbUsed == cbAlloc)
+        {
+            cbAlloc *= 2;
+            if (_PyBytes_Resize(&result, cbAlloc) != 0)
+                return 0;
+        }
+    }
+
+    if (cbUsed != cbAlloc && _PyBytes_Resize(&result, cbUsed) != 0)
+        return 0;
+
+    return result;
+}
+
+
+static char readable_doc[] =
+    "readable() --> True\n"
+    "\n"
+    "Returns True since BlobReaders can be read.";
+
+static PyObject* BlobReader_readable(PyObject* self, PyObject* args)
+{
+    UNUSED(self, args);
+    Py_RETURN_TRUE;
+}
+
+
+static char close_doc[] =
+    "close() --> None\n"
+    "\n"
+    "Closes the reader.  Any unread part of the value is skipped when the cursor\n"
+    "moves to the next row.";
+
+static PyObject* BlobReader_close(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    BlobReader* reader = (BlobReader*)self;
+    Py_CLEAR(reader->cur);
+    Py_RETURN_NONE;
+}
+
+
+static PyObject* BlobReader_enter(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+    Py_INCREF(self);
+    return self;
+}
+
+
+static PyObject* BlobReader_exit(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+    return BlobReader_close(self, 0);
+}
+
+
+static PyObject* BlobReader_getclosed(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    return PyBool_FromLong(((BlobReader*)self)->cur == 0);
+}
+
+
+static PyObject* BlobReader_getvalues(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    BlobReader* reader = (BlobReader*)self;
+    Py_INCREF(reader->values);
+    return reader->values;
+}
+
+
+static PyMethodDef BlobReader_methods[] =
+{
+    { "read",      BlobReader_read,     METH_VARARGS, read_doc     },
+    { "readinto",  BlobReader_readinto, METH_VARARGS, readinto_doc },
+    { "readable",  BlobReader_readable, METH_NOARGS,  readable_doc },
+    { "close",     BlobReader_close,    METH_NOARGS,  close_doc    },
+    { "__enter__", BlobReader_enter,    METH_NOARGS,  0            },
+    { "__exit__",  BlobReader_exit,     METH_VARARGS, 0            },
+    { 0, 0, 0, 0 }
+};
+
+
+static PyGetSetDef BlobReader_getseters[] =
+{
+    { "closed", BlobReader_getclosed, 0, "True if the reader has been closed.", 0 },
+    { "values", BlobReader_getvalues, 0, "A tuple of the values of the row's columns before the blob column.", 0 },
+    { 0 }
+};
+
+
+static char blobreader_doc[] =
+    "A read-only, file-like object returned by Cursor.open_blob that streams a\n"
+    "column of the current row in chunks:\n"
+    "\n"
+    "  with cursor.open_blob('data') as blob, open(path, 'wb') as f:\n"
+    "      shutil.copyfileobj(blob, f)\n"
+    "\n"
+    "The reader can only be used until the cursor moves to another row.";
+
+PyTypeObject BlobReaderType =
+{
+    PyVarObject_HEAD_INIT(0, 0)
+    "pyodbc.BlobReader",                                    // tp_name
+    sizeof(BlobReader),                                     // tp_basicsize
+    0,                                                      // tp_itemsize
+    (destructor)BlobReader_dealloc,                         // destructor tp_dealloc
+    0,                                                      // tp_print
+    0,                                                      // tp_getattr
+    0,                                                      // tp_setattr
+    0,                                                      // tp_compare
+    0,                                                      // tp_repr
+    0,                                                      // tp_as_number
+    0,                                                      // tp_as_sequence
+    0,                                                      // tp_as_mapping
+    0,                                                      // tp_hash
+    0,                                                      // tp_call
+    0,                                                      // tp_str
+    0,                                                      // tp_getattro
+    0,                                                      // tp_setattro
+    0,                                                      // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                                     // tp_flags
+    blobreader_doc,                                         // tp_doc
+    0,                                                      // tp_traverse
+    0,                                                      // tp_clear
+    0,                                                      // tp_richcompare
+    0,                                                      // tp_weaklistoffset
+    0,                                                      // tp_iter
+    0,                                                      // tp_iternext
+    BlobReader_methods,                                     // tp_methods
+    0,                                                      // tp_members
+    BlobReader_getseters,                                   // tp_getset
+    0,                                                      // tp_base
+    0,                                                      // tp_dict
+    0,                                                      // tp_descr_get
+    0,                                                      // tp_descr_set
+    0,                                                      // tp_dictoffset
+    0,                                                      // tp_init
+    0,                                                      // tp_alloc
+    0,                                                      // tp_new
+    0,                                                      // tp_free
+    0,                                                      // tp_is_gc
+    0,                                                      // tp_bases
+    0,                                                      // tp_mro
+    0,                                                      // tp_cache
+    0,                                                      // tp_subclasses
+    0,                                                      // tp_weaklist
+};
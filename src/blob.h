@@ -0,0 +1,12 @@
+#ifndef BLOB_H
+#define BLOB_H
+
+struct Cursor;
+
+extern PyTypeObject BlobReaderType;
+
+PyObject* BlobReader_New(Cursor* cur, Py_ssize_t iCol, PyObject* values);
+// Returns a BlobReader that reads column iCol of the cursor's current row using SQLGetData.
+// `values` is a tuple of the row's earlier columns and is stolen.
+
+#endif // BLOB_H
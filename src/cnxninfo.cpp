@@ -3,12 +3,27 @@
 // connection string.  When we create a new connection, we copy the values into the connection structure.
 //
 // We hash the connection string since it may contain sensitive information we wouldn't want exposed in a core dump.
+//
+// If pyodbc.info_cache is set to a path, the values are also saved in that file so new processes don't need to ask the
+// driver again.  Each line holds a hash of the driver name, driver version, and connection string, the time it was
+// written, and the values.  Entries older than pyodbc.info_cache_ttl seconds are ignored and dropped when the file is
+// rewritten.  The cache is only an optimization, so any error reading or writing it is ignored.
 
 #include "pyodbc.h"
 #include "wrapper.h"
 #include "textenc.h"
+#include "pyodbcmodule.h"
 #include "cnxninfo.h"
 #include "connection.h"
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 
 // Maps from a Python string of the SHA1 hash to a CnxnInfo object.
 //
@@ -53,19 +68,26 @@ static PyObject* GetHash(PyObject* p)
     return PyObject_CallMethod(hash, "hexdigest", 0);
 }
 
-inline void GetColumnSize(Connection* cnxn, SQLSMALLINT sqltype, int* psize)
+inline bool GetColumnSize(Connection* cnxn, SQLSMALLINT sqltype, int* psize)
 {
+    // Returns false if the driver could not be asked.  A driver without the type is an answer,
+    // so that returns true, leaving the default.
+
     // For some reason I can't seem to reuse the HSTMT multiple times in a row here.  Until I
     // figure it out I'll simply allocate a new one each time.
     HSTMT hstmt;
     if (!SQL_SUCCEEDED(SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &hstmt)))
-        return;
+        return false;
 
     SQLINTEGER columnsize;
 
-    if (SQL_SUCCEEDED(SQLGetTypeInfo(hstmt, sqltype)) &&
-        SQL_SUCCEEDED(SQLFetch(hstmt)) &&
-        SQL_SUCCEEDED(SQLGetData(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0)))
+    SQLRETURN ret = SQLGetTypeInfo(hstmt, sqltype);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLFetch(hstmt);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLGetData(hstmt, 3, SQL_INTEGER, &columnsize, sizeof(columnsize), 0);
+
+    if (SQL_SUCCEEDED(ret))
     {
         // I believe some drivers are returning negative numbers for "unlimited" text fields,
         // such as FileMaker.  Ignore anything that seems too small.
@@ -75,9 +97,11 @@ inline void GetColumnSize(Connection* cnxn, SQLSMALLINT sqltype, int* psize)
 
     SQLFreeStmt(hstmt, SQL_CLOSE);
     SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+
+    return SQL_SUCCEEDED(ret) || ret == SQL_NO_DATA;
 }
 
-static PyObject* CnxnInfo_New(Connection* cnxn)
+static CnxnInfo* CnxnInfo_Alloc()
 {
 #ifdef _MSC_VER
 #pragma warning(disable : 4365)
@@ -85,7 +109,6 @@ static PyObject* CnxnInfo_New(Connection* cnxn)
     CnxnInfo* p = PyObject_NEW(CnxnInfo, &CnxnInfoType);
     if (!p)
         return 0;
-    Object info((PyObject*)p);
 
     // set defaults
     p->odbc_major             = 0;
@@ -98,17 +121,32 @@ static PyObject* CnxnInfo_New(Connection* cnxn)
     p->wvarchar_maxlength = 1 * 1024 * 1024 * 1024;
     p->binary_maxlength   = 1 * 1024 * 1024 * 1024;
 
+    return p;
+}
+
+static PyObject* CnxnInfo_New(Connection* cnxn, bool* pComplete = 0)
+{
+    // If pComplete is not zero, it is set to false if any of the values could not be read from
+    // the driver and were left at their defaults.
+
+    CnxnInfo* p = CnxnInfo_Alloc();
+    if (!p)
+        return 0;
+    Object info((PyObject*)p);
+
     // WARNING: The GIL lock is released for the *entire* function here.  Do not
     // touch any objects, call Python APIs, etc.  We are simply making ODBC
     // calls and setting atomic values (ints & chars).  Also, make sure the lock
     // gets reaquired -- do not add an early exit.
 
     SQLRETURN ret;
+    bool complete = true;
     Py_BEGIN_ALLOW_THREADS
 
     char szVer[20];
     SQLSMALLINT cch = 0;
     ret = SQLGetInfo(cnxn->hdbc, SQL_DRIVER_ODBC_VER, szVer, _countof(szVer), &cch);
+    complete = SQL_SUCCEEDED(ret);
     if (SQL_SUCCEEDED(ret))
     {
         char* dot = strchr(szVer, '.');
@@ -123,21 +161,265 @@ static PyObject* CnxnInfo_New(Connection* cnxn)
     char szYN[2];
     if (SQL_SUCCEEDED(SQLGetInfo(cnxn->hdbc, SQL_DESCRIBE_PARAMETER, szYN, _countof(szYN), &cch)))
         p->supports_describeparam = szYN[0] == 'Y';
+    else
+        complete = false;
 
     if (SQL_SUCCEEDED(SQLGetInfo(cnxn->hdbc, SQL_NEED_LONG_DATA_LEN, szYN, _countof(szYN), &cch)))
         p->need_long_data_len = (szYN[0] == 'Y');
+    else
+        complete = false;
 
-    GetColumnSize(cnxn, SQL_VARCHAR, &p->varchar_maxlength);
-    GetColumnSize(cnxn, SQL_WVARCHAR, &p->wvarchar_maxlength);
-    GetColumnSize(cnxn, SQL_VARBINARY, &p->binary_maxlength);
-    GetColumnSize(cnxn, SQL_TYPE_TIMESTAMP, &p->datetime_precision);
+    complete = GetColumnSize(cnxn, SQL_VARCHAR, &p->varchar_maxlength) && complete;
+    complete = GetColumnSize(cnxn, SQL_WVARCHAR, &p->wvarchar_maxlength) && complete;
+    complete = GetColumnSize(cnxn, SQL_VARBINARY, &p->binary_maxlength) && complete;
+    complete = GetColumnSize(cnxn, SQL_TYPE_TIMESTAMP, &p->datetime_precision) && complete;
 
     Py_END_ALLOW_THREADS
 
+    if (pComplete)
+        *pComplete = complete;
+
     return info.Detach();
 }
 
 
+//
+// The file cache
+//
+
+struct CacheEntry
+{
+    char key[41];
+    long long written;
+    int values[8];
+};
+
+static const char* const ENTRY_FORMAT = "%40s %lld %d %d %d %d %d %d %d %d";
+
+static bool ParseEntry(const char* line, CacheEntry& entry)
+{
+    return sscanf(line, ENTRY_FORMAT, entry.key, &entry.written, &entry.values[0], &entry.values[1], &entry.values[2],
+                  &entry.values[3], &entry.values[4], &entry.values[5], &entry.values[6], &entry.values[7]) == 10 &&
+        strlen(entry.key) == 40;
+}
+
+static bool IsFresh(const CacheEntry& entry, long long now, double ttl)
+{
+    return entry.written <= now && (double)(now - entry.written) < ttl;
+}
+
+static void InfoToValues(const CnxnInfo* p, int* values)
+{
+    values[0] = p->odbc_major;
+    values[1] = p->odbc_minor;
+    values[2] = p->supports_describeparam;
+    values[3] = p->need_long_data_len;
+    values[4] = p->datetime_precision;
+    values[5] = p->varchar_maxlength;
+    values[6] = p->wvarchar_maxlength;
+    values[7] = p->binary_maxlength;
+}
+
+static void ValuesToInfo(const int* values, CnxnInfo* p)
+{
+    p->odbc_major             = (char)values[0];
+    p->odbc_minor             = (char)values[1];
+    p->supports_describeparam = values[2] != 0;
+    p->need_long_data_len     = values[3] != 0;
+    p->datetime_precision     = values[4];
+    p->varchar_maxlength      = values[5];
+    p->wvarchar_maxlength     = values[6];
+    p->binary_maxlength       = values[7];
+}
+
+static bool ReadCacheFile(const char* path, const char* key, double ttl, int* values)
+{
+    // Looks for a fresh entry for key.  This does not use any Python objects so it can be called without the GIL.
+
+    FILE* fp = fopen(path, "r");
+    if (!fp)
+        return false;
+
+    long long now = (long long)time(0);
+    bool found = false;
+
+    char line[256];
+    CacheEntry entry;
+    while (!found && fgets(line, sizeof(line), fp))
+    {
+        if (ParseEntry(line, entry) && strcmp(entry.key, key) == 0 && IsFresh(entry, now, ttl))
+        {
+            memcpy(values, entry.values, sizeof(entry.values));
+            found = true;
+        }
+    }
+
+    fclose(fp);
+    return found;
+}
+
+static void WriteCacheFile(const char* path, const char* key, double ttl, const int* values, unsigned long serial)
+{
+    // Rewrites the file with the fresh entries for other keys plus the new one.  The file is written to a temporary name
+    // and renamed over the old one so other processes never read a partial file.  If two processes write at the same
+    // time one entry may be lost, which only means it is probed again.  This does not use any Python objects so it can
+    // be called without the GIL.
+    //
+    // `serial` makes the temporary name unique among threads in this process.
+
+    char tmp[1024];
+    if (snprintf(tmp, sizeof(tmp), "%s.%d.%lu.tmp", path, (int)getpid(), serial) >= (int)sizeof(tmp))
+        return;
+
+    // The keys are hashes of connection strings, which may contain passwords, so only the owner can read the file.
+#ifdef _WIN32
+    FILE* out = fopen(tmp, "w");
+#else
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    FILE* out = (fd != -1) ? fdopen(fd, "w") : 0;
+    if (fd != -1 && !out)
+        close(fd);
+#endif
+    if (!out)
+        return;
+
+    long long now = (long long)time(0);
+
+    FILE* in = fopen(path, "r");
+    if (in)
+    {
+        char line[256];
+        CacheEntry entry;
+        while (fgets(line, sizeof(line), in))
+        {
+            if (ParseEntry(line, entry) && strcmp(entry.key, key) != 0 && IsFresh(entry, now, ttl))
+                fputs(line, out);
+        }
+        fclose(in);
+    }
+
+    fprintf(out, "%s %lld %d %d %d %d %d %d %d %d\n", key, now, values[0], values[1], values[2], values[3], values[4],
+            values[5], values[6], values[7]);
+
+    bool ok = fclose(out) == 0;
+#ifdef _WIN32
+    // rename fails on Windows if the file exists.
+    ok = ok && MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(tmp, path) == 0;
+#endif
+    if (!ok)
+        remove(tmp);
+}
+
+static PyObject* GetCachePath()
+{
+    // Returns pyodbc.info_cache as bytes or zero if it is not set.  This never sets an exception.
+
+    Object path(PyObject_GetAttrString(pModule, "info_cache"));
+    PyObject* bytes = 0;
+    if (!path.IsValid() || path.Get() == Py_None || !PyUnicode_FSConverter(path, &bytes))
+    {
+        PyErr_Clear();
+        return 0;
+    }
+    return bytes;
+}
+
+static double GetCacheTTL()
+{
+    Object ttl(PyObject_GetAttrString(pModule, "info_cache_ttl"));
+    double seconds = ttl.IsValid() ? PyFloat_AsDouble(ttl) : -1;
+    if (PyErr_Occurred())
+    {
+        PyErr_Clear();
+        seconds = 0;
+    }
+    return seconds;
+}
+
+static PyObject* GetCacheKey(Connection* cnxn, PyObject* pConnectionString)
+{
+    // Returns the hash used as the key in the cache file.  Including the driver's name and version means a new driver
+    // is asked again.  Returns zero without an exception if it cannot be created.
+
+    char szName[200];
+    char szVer[50];
+    SQLSMALLINT cch;
+    SQLRETURN retName, retVer;
+
+    Py_BEGIN_ALLOW_THREADS
+    retName = SQLGetInfo(cnxn->hdbc, SQL_DRIVER_NAME, szName, _countof(szName), &cch);
+    retVer  = SQLGetInfo(cnxn->hdbc, SQL_DRIVER_VER, szVer, _countof(szVer), &cch);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(retName) || !SQL_SUCCEEDED(retVer))
+        return 0;
+
+    Object text(PyUnicode_FromFormat("%s\n%s\n%U", szName, szVer, pConnectionString));
+    PyObject* key = text.IsValid() ? GetHash(text) : 0;
+    if (!key || !PyUnicode_Check(key) || PyUnicode_GET_LENGTH(key) != 40)
+    {
+        PyErr_Clear();
+        Py_XDECREF(key);
+        return 0;
+    }
+    return key;
+}
+
+static PyObject* CnxnInfo_FromCache(Connection* cnxn, PyObject* pConnectionString)
+{
+    // Returns the CnxnInfo from the cache file if pyodbc.info_cache is set, otherwise from the driver.  In the latter
+    // case it is saved to the file.
+
+    Object path(GetCachePath());
+    if (!path.IsValid())
+        return CnxnInfo_New(cnxn);
+
+    Object key(GetCacheKey(cnxn, pConnectionString));
+    if (!key.IsValid())
+        return CnxnInfo_New(cnxn);
+
+    const char* szPath = PyBytes_AS_STRING(path.Get());
+    const char* szKey  = PyUnicode_AsUTF8(key);
+    double ttl = GetCacheTTL();
+    if (!szKey)
+    {
+        PyErr_Clear();
+        return CnxnInfo_New(cnxn);
+    }
+
+    int values[8];
+    bool found;
+    Py_BEGIN_ALLOW_THREADS
+    found = ttl > 0 && ReadCacheFile(szPath, szKey, ttl, values);
+    Py_END_ALLOW_THREADS
+
+    if (found)
+    {
+        CnxnInfo* p = CnxnInfo_Alloc();
+        if (p)
+            ValuesToInfo(values, p);
+        return (PyObject*)p;
+    }
+
+    // Defaults used because the driver couldn't be asked are not saved, or they would be used
+    // for the whole TTL.
+    bool complete = false;
+    PyObject* info = CnxnInfo_New(cnxn, &complete);
+    if (info && complete && ttl > 0)
+    {
+        static unsigned long serial = 0;
+        unsigned long thisSerial = ++serial;
+        InfoToValues((CnxnInfo*)info, values);
+        Py_BEGIN_ALLOW_THREADS
+        WriteCacheFile(szPath, szKey, ttl, values, thisSerial);
+        Py_END_ALLOW_THREADS
+    }
+    return info;
+}
+
+
 PyObject* GetConnectionInfo(PyObject* pConnectionString, Connection* cnxn)
 {
     // Looks-up or creates a CnxnInfo object for the given connection string.  The connection string can be a Unicode
@@ -156,7 +438,7 @@ PyObject* GetConnectionInfo(PyObject* pConnectionString, Connection* cnxn)
         }
     }
 
-    PyObject* info = CnxnInfo_New(cnxn);
+    PyObject* info = CnxnInfo_FromCache(cnxn, pConnectionString);
     if (info != 0 && hash.IsValid())
         PyDict_SetItem(map_hash_to_info, hash, info);
 
@@ -0,0 +1,400 @@
+// Column-wise parameter binding.
+//
+// The fast executemany code binds row-wise: each row's values are converted into one
+// parameter buffer.  When the caller already has the values in arrays, one per parameter, the
+// arrays can be bound column-wise (SQL_PARAM_BIND_BY_COLUMN) and the driver reads the caller's
+// memory directly.
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "params.h"
+#include "colbind.h"
+
+
+bool DescribeColumnParam(Cursor* cur, Py_ssize_t index, SQLSMALLINT defaultType, ColumnParam& param)
+{
+    SQLSMALLINT nullable;
+    if (!SQL_SUCCEEDED(SQLDescribeParam(cur->hstmt, (SQLUSMALLINT)(index + 1), &param.ParameterType,
+                                        &param.ColumnSize, &param.DecimalDigits, &nullable)))
+    {
+        param.ParameterType = defaultType;
+        param.ColumnSize    = 0;
+        param.DecimalDigits = 0;
+    }
+    return true;
+}
+
+
+bool ExecuteColumnParams(Cursor* cur, ColumnParam* params, SQLULEN cRows, SQLLEN& rowcount)
+{
+    bool success = false;
+    SQLRETURN rc;
+    Py_ssize_t i;
+
+    for (i = 0; i < cur->paramcount; i++)
+    {
+        ColumnParam& p = params[i];
+        if (!SQL_SUCCEEDED(SQLBindParameter(cur->hstmt, (SQLUSMALLINT)(i + 1), SQL_PARAM_INPUT, p.ValueType,
+                                            p.ParameterType, p.ColumnSize, p.DecimalDigits,
+                                            p.ParameterValuePtr, p.BufferLength, p.StrLen_or_IndPtr)))
+        {
+            RaiseErrorFromHandle(cur->cnxn, "SQLBindParameter", cur->cnxn->hdbc, cur->hstmt);
+            goto done;
+        }
+    }
+
+    if (!SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER)SQL_PARAM_BIND_BY_COLUMN, SQL_IS_UINTEGER)) ||
+        !SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)cRows, SQL_IS_UINTEGER)))
+    {
+        RaiseErrorFromHandle(cur->cnxn, "SQLSetStmtAttr", cur->cnxn->hdbc, cur->hstmt);
+        goto done;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    rc = SQLExecute(cur->hstmt);
+    Py_END_ALLOW_THREADS
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.  MS ODBC
+        // will crash if we use the HSTMT now, so don't reset anything.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (!SQL_SUCCEEDED(rc) && rc != SQL_NO_DATA)
+    {
+        RaiseErrorFromHandle(cur->cnxn, "SQLExecute", cur->cnxn->hdbc, cur->hstmt);
+        goto done;
+    }
+
+    if (rc == SQL_SUCCESS_WITH_INFO)
+        GetDiagRecs(cur);
+
+    if (rowcount != -1)
+    {
+        SQLLEN cAffected = -1;
+        if (!SQL_SUCCEEDED(SQLRowCount(cur->hstmt, &cAffected)) || cAffected < 0)
+            rowcount = -1;
+        else
+            rowcount += cAffected;
+    }
+
+    success = true;
+
+  done:
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, SQL_IS_UINTEGER);
+    SQLFreeStmt(cur->hstmt, SQL_RESET_PARAMS);
+    return success;
+}
+
+
+static bool IsNativeByteOrder(char ch)
+{
+    const uint16_t one = 1;
+    bool little = *(const char*)&one == 1;
+    return (ch == '<') ? little : !little;
+}
+
+
+static bool CTypeFromFormat(const Py_buffer& view, SQLSMALLINT& ctype, SQLSMALLINT& sqltype)
+{
+    // Determines the C type used to bind the elements of a buffer and the SQL type to use if the
+    // driver can't describe the parameter.  Only fixed-width numeric types are supported since
+    // they can be bound without conversion.
+
+    const char* format = view.format ? view.format : "B";
+
+    if (*format == '@' || *format == '=')
+        format++;
+    else if (*format == '<' || *format == '>' || *format == '!')
+    {
+        if (!IsNativeByteOrder(*format == '!' ? '>' : *format))
+            return false;
+        format++;
+    }
+
+    if (format[0] == 0 || format[1] != 0)
+        return false;
+
+    switch (format[0])
+    {
+    case '?':
+        ctype = SQL_C_BIT;
+        sqltype = SQL_BIT;
+        return view.itemsize == 1;
+
+    case 'b':
+        ctype = SQL_C_STINYINT;
+        sqltype = SQL_SMALLINT;
+        return view.itemsize == 1;
+
+    case 'B':
+        ctype = SQL_C_UTINYINT;
+        sqltype = SQL_TINYINT;
+        return view.itemsize == 1;
+
+    case 'h':
+        ctype = SQL_C_SSHORT;
+        sqltype = SQL_SMALLINT;
+        return view.itemsize == 2;
+
+    case 'H':
+        ctype = SQL_C_USHORT;
+        sqltype = SQL_INTEGER;
+        return view.itemsize == 2;
+
+    case 'i':
+    case 'l':
+    case 'q':
+    case 'n':
+        if (view.itemsize == 4)
+        {
+            ctype = SQL_C_SLONG;
+            sqltype = SQL_INTEGER;
+            return true;
+        }
+        ctype = SQL_C_SBIGINT;
+        sqltype = SQL_BIGINT;
+        return view.itemsize == 8;
+
+    case 'I':
+    case 'L':
+    case 'Q':
+    case 'N':
+        if (view.itemsize == 4)
+        {
+            ctype = SQL_C_ULONG;
+            sqltype = SQL_BIGINT;
+            return true;
+        }
+        ctype = SQL_C_UBIGINT;
+        sqltype = SQL_BIGINT;
+        return view.itemsize == 8;
+
+    case 'f':
+        ctype = SQL_C_FLOAT;
+        sqltype = SQL_REAL;
+        return view.itemsize == 4;
+
+    case 'd':
+        ctype = SQL_C_DOUBLE;
+        sqltype = SQL_DOUBLE;
+        return view.itemsize == 8;
+    }
+
+    return false;
+}
+
+
+struct ColumnBuffers
+{
+    Py_buffer data;
+    Py_buffer mask;
+    // The Py_buffer obj fields are non-zero when the buffers need to be released.
+};
+
+
+static bool GetColumnBuffers(Py_ssize_t index, PyObject* column, PyObject* mask, ColumnBuffers& buffers)
+{
+    // mask
+    //   The mask from the caller's masks sequence, or None.  If None and the column is a NumPy
+    //   masked array, its data and mask are used.
+
+    Object data(column);
+    Py_INCREF(column);
+
+    Object maskobj;
+    if (mask != Py_None)
+    {
+        maskobj = mask;
+        Py_INCREF(mask);
+    }
+    else if (PyObject_HasAttrString(column, "mask") && PyObject_HasAttrString(column, "data"))
+    {
+        data.Attach(PyObject_GetAttrString(column, "data"));
+        maskobj.Attach(PyObject_GetAttrString(column, "mask"));
+        if (!data || !maskobj)
+            return false;
+    }
+
+    if (PyObject_GetBuffer(data, &buffers.data, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+        return false;
+
+    if (buffers.data.ndim != 1)
+    {
+        RaiseErrorV(0, PyExc_ValueError, "Column %zd must be a one-dimensional array", index);
+        return false;
+    }
+
+    if (maskobj)
+    {
+        if (PyObject_GetBuffer(maskobj, &buffers.mask, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+            return false;
+
+        // A zero-dimensional mask, like numpy.ma.nomask, applies to every row.
+        if (buffers.mask.itemsize != 1 ||
+            (buffers.mask.ndim != 0 && (buffers.mask.ndim != 1 || buffers.mask.len != buffers.data.shape[0])))
+        {
+            RaiseErrorV(0, PyExc_ValueError, "The mask for column %zd must be a one-byte array the same length as the column", index);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static SQLLEN* CreateIndicators(const Py_buffer& mask, SQLULEN cRows)
+{
+    // Returns an array of indicators from the mask, or zero with no exception set if there are
+    // no nulls.
+
+    const char* pb = (const char*)mask.buf;
+    bool uniform = (mask.ndim == 0);
+
+    SQLULEN iRow;
+    for (iRow = 0; iRow < cRows; iRow++)
+    {
+        if (pb[uniform ? 0 : iRow])
+            break;
+    }
+    if (iRow == cRows)
+        return 0;
+
+    SQLLEN* ind = (SQLLEN*)PyMem_Malloc(sizeof(SQLLEN) * cRows);
+    if (!ind)
+    {
+        PyErr_NoMemory();
+        return 0;
+    }
+
+    for (iRow = 0; iRow < cRows; iRow++)
+        ind[iRow] = pb[uniform ? 0 : iRow] ? SQL_NULL_DATA : 0;
+
+    return ind;
+}
+
+
+bool ExecuteColumns(Cursor* cur, PyObject* pSql, PyObject* columns, PyObject* masks)
+{
+    Object colseq(PySequence_Fast(columns, "The columns must be a sequence of arrays."));
+    if (!colseq)
+        return false;
+
+    Py_ssize_t cCols = PySequence_Fast_GET_SIZE(colseq.Get());
+    PyObject** colitems = PySequence_Fast_ITEMS(colseq.Get());
+
+    Object maskseq;
+    if (masks != Py_None)
+    {
+        maskseq = PySequence_Fast(masks, "The masks must be a sequence.");
+        if (!maskseq)
+            return false;
+        if (PySequence_Fast_GET_SIZE(maskseq.Get()) != cCols)
+        {
+            PyErr_SetString(PyExc_ValueError, "The masks sequence must have one item for each column.");
+            return false;
+        }
+    }
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    if (cCols != cur->paramcount)
+    {
+        RaiseErrorV(0, ProgrammingError, "Expected %d parameters, supplied %zd", (int)cur->paramcount, cCols);
+        return false;
+    }
+
+    if (cCols == 0)
+    {
+        PyErr_SetString(ProgrammingError, "executemany_columns requires a statement with parameters.");
+        return false;
+    }
+
+    ColumnBuffers* buffers = (ColumnBuffers*)PyMem_Malloc(sizeof(ColumnBuffers) * cCols);
+    ColumnParam* params = (ColumnParam*)PyMem_Malloc(sizeof(ColumnParam) * cCols);
+    if (!buffers || !params)
+    {
+        PyMem_Free(buffers);
+        PyMem_Free(params);
+        PyErr_NoMemory();
+        return false;
+    }
+    memset(buffers, 0, sizeof(ColumnBuffers) * cCols);
+    memset(params, 0, sizeof(ColumnParam) * cCols);
+
+    bool success = false;
+    SQLULEN cRows = 0;
+    SQLLEN rowcount = 0;
+    Py_ssize_t i;
+
+    for (i = 0; i < cCols; i++)
+    {
+        PyObject* mask = maskseq.IsValid() ? PySequence_Fast_GET_ITEM(maskseq.Get(), i) : Py_None;
+        if (!GetColumnBuffers(i, colitems[i], mask, buffers[i]))
+            goto done;
+
+        const Py_buffer& view = buffers[i].data;
+
+        if (i == 0)
+            cRows = (SQLULEN)view.shape[0];
+        else if ((SQLULEN)view.shape[0] != cRows)
+        {
+            RaiseErrorV(0, PyExc_ValueError, "Column %zd has %zd rows but column 0 has %zd", i, view.shape[0], (Py_ssize_t)cRows);
+            goto done;
+        }
+
+        ColumnParam& p = params[i];
+        SQLSMALLINT sqltype;
+        if (!CTypeFromFormat(view, p.ValueType, sqltype))
+        {
+            RaiseErrorV(0, PyExc_TypeError, "Column %zd has an unsupported element format '%s'.  Only integer, floating point, and boolean arrays can be bound.",
+                        i, view.format ? view.format : "B");
+            goto done;
+        }
+
+        if (!DescribeColumnParam(cur, i, sqltype, p))
+            goto done;
+
+        p.ParameterValuePtr = view.buf;
+        p.BufferLength = view.itemsize;
+
+        if (buffers[i].mask.obj)
+        {
+            p.StrLen_or_IndPtr = CreateIndicators(buffers[i].mask, cRows);
+            if (PyErr_Occurred())
+                goto done;
+        }
+    }
+
+    if (cRows == 0)
+    {
+        PyErr_SetString(ProgrammingError, "The columns passed to executemany_columns must not be empty.");
+        goto done;
+    }
+
+    success = ExecuteColumnParams(cur, params, cRows, rowcount);
+    if (success)
+        cur->rowcount = (int)rowcount;
+
+  done:
+    for (i = 0; i < cCols; i++)
+    {
+        if (buffers[i].data.obj)
+            PyBuffer_Release(&buffers[i].data);
+        if (buffers[i].mask.obj)
+            PyBuffer_Release(&buffers[i].mask);
+        PyMem_Free(params[i].StrLen_or_IndPtr);
+    }
+    PyMem_Free(buffers);
+    PyMem_Free(params);
+
+    return success;
+}
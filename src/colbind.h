@@ -0,0 +1,46 @@
+#ifndef COLBIND_H
+#define COLBIND_H
+
+struct Cursor;
+
+struct ColumnParam
+{
+    // Describes one parameter bound column-wise: the values for every row of the parameter set
+    // are in a single array.  The fields are the SQLBindParameter arguments of the same name.
+
+    SQLSMALLINT ValueType;
+    SQLSMALLINT ParameterType;
+    SQLULEN ColumnSize;
+    SQLSMALLINT DecimalDigits;
+
+    SQLPOINTER ParameterValuePtr;
+    // The array of values.
+
+    SQLLEN BufferLength;
+    // The width of each element in the array.
+
+    SQLLEN* StrLen_or_IndPtr;
+    // An array of lengths or SQL_NULL_DATA, one per row.  This can be zero for fixed width
+    // types that have no nulls.
+};
+
+bool DescribeColumnParam(Cursor* cur, Py_ssize_t index, SQLSMALLINT defaultType, ColumnParam& param);
+// Sets the parameter's SQL type, column size, and decimal digits using SQLDescribeParam.  If the
+// driver can't describe the parameter, defaultType is used.
+
+bool ExecuteColumnParams(Cursor* cur, ColumnParam* params, SQLULEN cRows, SQLLEN& rowcount);
+// Binds the parameters column-wise and executes the cursor's prepared statement once for all
+// cRows rows.  The parameters are unbound before returning.
+//
+// The number of rows affected is added to rowcount, or rowcount is set to -1 if the driver
+// doesn't know.
+
+bool ExecuteColumns(Cursor* cur, PyObject* pSql, PyObject* columns, PyObject* masks);
+// Implements Cursor.executemany_columns: executes pSql once for each row of `columns`, a
+// sequence of one-dimensional objects supporting the buffer protocol.  The arrays are bound
+// directly without copying.
+//
+// masks is None or a sequence with one item per column, each None or a buffer of bytes that
+// are non-zero for nulls.
+
+#endif // COLBIND_H
@@ -16,6 +16,8 @@
 #include "pyodbcmodule.h"
 #include "errors.h"
 #include "cnxninfo.h"
+#include "stmtcache.h"
+#include "pool.h"
 
 
 static char connection_doc[] =
@@ -59,6 +61,58 @@ static char* StrDup(const char* text) {
 }
 
 
+static bool SetDefaultEncodings(Connection* cnxn)
+{
+    // Sets the encodings of a new connection.  The previous names, if any, must already have been
+    // freed.
+
+    // This is an inefficient default, but should work all the time.  When we are offered
+    // single-byte text we don't actually know what the encoding is.  For example, with SQL
+    // Server the encoding is based on the database's collation.  We ask the driver / DB to
+    // convert to SQL_C_WCHAR and use the ODBC default of UTF-16LE.
+    cnxn->sqlchar_enc.optenc = OPTENC_UTF16NE;
+    cnxn->sqlchar_enc.name   = StrDup(ENCSTR_UTF16NE);
+    cnxn->sqlchar_enc.ctype  = SQL_C_WCHAR;
+
+    cnxn->sqlwchar_enc.optenc = OPTENC_UTF16NE;
+    cnxn->sqlwchar_enc.name   = StrDup(ENCSTR_UTF16NE);
+    cnxn->sqlwchar_enc.ctype  = SQL_C_WCHAR;
+
+    cnxn->metadata_enc.optenc = OPTENC_UTF16NE;
+    cnxn->metadata_enc.name   = StrDup(ENCSTR_UTF16NE);
+    cnxn->metadata_enc.ctype  = SQL_C_WCHAR;
+
+    // Note: I attempted to use UTF-8 here too since it can hold any type, but SQL Server fails
+    // with a data truncation error if we send something encoded in 2 bytes to a column with 1
+    // character.  I don't know if this is a bug in SQL Server's driver or if I'm missing
+    // something, so we'll stay with the default ODBC conversions.
+    cnxn->unicode_enc.optenc = OPTENC_UTF16NE;
+    cnxn->unicode_enc.name   = StrDup(ENCSTR_UTF16NE);
+    cnxn->unicode_enc.ctype  = SQL_C_WCHAR;
+
+    if (!cnxn->sqlchar_enc.name || !cnxn->sqlwchar_enc.name || !cnxn->metadata_enc.name || !cnxn->unicode_enc.name)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+
+    return true;
+}
+
+
+static void FreeEncodings(Connection* cnxn)
+{
+    PyMem_Free((void*)cnxn->sqlchar_enc.name);
+    cnxn->sqlchar_enc.name = 0;
+    PyMem_Free((void*)cnxn->sqlwchar_enc.name);
+    cnxn->sqlwchar_enc.name = 0;
+    PyMem_Free((void*)cnxn->metadata_enc.name);
+    cnxn->metadata_enc.name = 0;
+    PyMem_Free((void*)cnxn->unicode_enc.name);
+    cnxn->unicode_enc.name = 0;
+}
+
+
 static bool Connect(PyObject* pConnectString, HDBC hdbc, long timeout, PyObject* encoding)
 {
     assert(PyUnicode_Check(pConnectString));
@@ -170,7 +224,7 @@ static bool ApplyPreconnAttrs(HDBC hdbc, SQLINTEGER ikey, PyObject *value, char
 }
 
 PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, long timeout, bool fReadOnly,
-                         PyObject* attrs_before, PyObject* encoding)
+                         PyObject* attrs_before, PyObject* encoding, PyObject** pinfo)
 {
     //
     // Allocate HDBC and connect
@@ -248,38 +302,20 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, long timeou
     cnxn->nAutoCommit  = fAutoCommit ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
     cnxn->searchescape = 0;
     cnxn->maxwrite     = 0;
+    cnxn->decimal_mode = DECIMAL_MODE_DECIMAL;
     cnxn->timeout      = 0;
+    cnxn->stmtcache_head  = 0;
+    cnxn->stmtcache_tail  = 0;
+    cnxn->stmtcache_count = 0;
+    cnxn->stmtcache_size  = 0;
+    cnxn->cursors         = 0;
+    cnxn->pool            = 0;
     cnxn->map_sqltype_to_converter = 0;
 
     cnxn->attrs_before = attrs_before_o.Detach();
 
-    // This is an inefficient default, but should work all the time.  When we are offered
-    // single-byte text we don't actually know what the encoding is.  For example, with SQL
-    // Server the encoding is based on the database's collation.  We ask the driver / DB to
-    // convert to SQL_C_WCHAR and use the ODBC default of UTF-16LE.
-    cnxn->sqlchar_enc.optenc = OPTENC_UTF16NE;
-    cnxn->sqlchar_enc.name   = StrDup(ENCSTR_UTF16NE);
-    cnxn->sqlchar_enc.ctype  = SQL_C_WCHAR;
-
-    cnxn->sqlwchar_enc.optenc = OPTENC_UTF16NE;
-    cnxn->sqlwchar_enc.name   = StrDup(ENCSTR_UTF16NE);
-    cnxn->sqlwchar_enc.ctype  = SQL_C_WCHAR;
-
-    cnxn->metadata_enc.optenc = OPTENC_UTF16NE;
-    cnxn->metadata_enc.name   = StrDup(ENCSTR_UTF16NE);
-    cnxn->metadata_enc.ctype  = SQL_C_WCHAR;
-
-    // Note: I attempted to use UTF-8 here too since it can hold any type, but SQL Server fails
-    // with a data truncation error if we send something encoded in 2 bytes to a column with 1
-    // character.  I don't know if this is a bug in SQL Server's driver or if I'm missing
-    // something, so we'll stay with the default ODBC conversions.
-    cnxn->unicode_enc.optenc = OPTENC_UTF16NE;
-    cnxn->unicode_enc.name   = StrDup(ENCSTR_UTF16NE);
-    cnxn->unicode_enc.ctype  = SQL_C_WCHAR;
-
-    if (!cnxn->sqlchar_enc.name || !cnxn->sqlwchar_enc.name || !cnxn->metadata_enc.name || !cnxn->unicode_enc.name)
+    if (!SetDefaultEncodings(cnxn))
     {
-        PyErr_NoMemory();
         Py_DECREF(cnxn);
         return 0;
     }
@@ -324,7 +360,21 @@ PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, long timeou
     // Gather connection-level information we'll need later.
     //
 
-    Object info(GetConnectionInfo(pConnectString, cnxn));
+    Object info;
+    if (pinfo && *pinfo)
+    {
+        Py_INCREF(*pinfo);
+        info.Attach(*pinfo);
+    }
+    else
+    {
+        info.Attach(GetConnectionInfo(pConnectString, cnxn));
+        if (pinfo && info.IsValid())
+        {
+            Py_INCREF(info.Get());
+            *pinfo = info.Get();
+        }
+    }
 
     if (!info.IsValid())
     {
@@ -397,6 +447,8 @@ static int Connection_clear(PyObject* self)
     {
         TRACE("cnxn.clear cnxn=%p hdbc=%d\n", cnxn, cnxn->hdbc);
 
+        ClearStatementCache(cnxn);
+
         HDBC hdbc = cnxn->hdbc;
         cnxn->hdbc = SQL_NULL_HANDLE;
         Py_BEGIN_ALLOW_THREADS
@@ -411,14 +463,7 @@ static int Connection_clear(PyObject* self)
     Py_XDECREF(cnxn->searchescape);
     cnxn->searchescape = 0;
 
-    PyMem_Free((void*)cnxn->sqlchar_enc.name);
-    cnxn->sqlchar_enc.name = 0;
-    PyMem_Free((void*)cnxn->sqlwchar_enc.name);
-    cnxn->sqlwchar_enc.name = 0;
-    PyMem_Free((void*)cnxn->metadata_enc.name);
-    cnxn->metadata_enc.name = 0;
-    PyMem_Free((void*)cnxn->unicode_enc.name);
-    cnxn->unicode_enc.name = 0;
+    FreeEncodings(cnxn);
 
     Py_XDECREF(cnxn->attrs_before);
     cnxn->attrs_before = 0;
@@ -431,10 +476,85 @@ static int Connection_clear(PyObject* self)
 
 static void Connection_dealloc(PyObject* self)
 {
+    // A pooled connection that was never closed goes back to its pool.  If the pool keeps it,
+    // this object is left closed.
+    if (((Connection*)self)->pool)
+        Pool_Return((Connection*)self);
+
     Connection_clear(self);
     PyObject_Del(self);
 }
 
+
+Connection* Connection_Recycle(Connection* cnxn, bool fAutoCommit)
+{
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+        return 0;
+
+    // The cursors' statements must be freed before the HDBC is given to another caller.
+    if (!CloseCursors(cnxn))
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    HDBC hdbc = cnxn->hdbc;
+    uintptr_t nAutoCommit = fAutoCommit ? SQL_AUTOCOMMIT_ON : SQL_AUTOCOMMIT_OFF;
+
+    SQLRETURN ret = SQL_SUCCESS;
+    Py_BEGIN_ALLOW_THREADS
+    if (cnxn->nAutoCommit == SQL_AUTOCOMMIT_OFF)
+        ret = SQLEndTran(SQL_HANDLE_DBC, hdbc, SQL_ROLLBACK);
+    if (SQL_SUCCEEDED(ret) && cnxn->nAutoCommit != nAutoCommit)
+        ret = SQLSetConnectAttr(hdbc, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER)nAutoCommit, SQL_IS_UINTEGER);
+    if (SQL_SUCCEEDED(ret) && cnxn->timeout != 0)
+        ret = SQLSetConnectAttr(hdbc, SQL_ATTR_CONNECTION_TIMEOUT, 0, SQL_IS_UINTEGER);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret) || cnxn->hdbc != hdbc)
+        return 0;
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4365)
+#endif
+    Connection* fresh = PyObject_NEW(Connection, &ConnectionType);
+#ifdef _MSC_VER
+#pragma warning(default : 4365)
+#endif
+    if (!fresh)
+    {
+        PyErr_Clear();
+        return 0;
+    }
+
+    // Move everything after the object header.  The attrs_before and CnxnInfo values stay with
+    // the HDBC.  Zeroed, the old object is a closed connection with nothing left to free.
+    const size_t offset = sizeof(PyObject);
+    memcpy((char*)fresh + offset, (char*)cnxn + offset, sizeof(Connection) - offset);
+    memset((char*)cnxn + offset, 0, sizeof(Connection) - offset);
+    cnxn->hdbc = SQL_NULL_HANDLE;
+
+    fresh->nAutoCommit  = nAutoCommit;
+    fresh->timeout      = 0;
+    fresh->maxwrite     = 0;
+    fresh->decimal_mode = DECIMAL_MODE_DECIMAL;
+    fresh->pool         = 0;
+    Py_CLEAR(fresh->map_sqltype_to_converter);
+
+    fresh->stmtcache_size = 0;
+    ClearStatementCache(fresh);
+
+    FreeEncodings(fresh);
+    if (!SetDefaultEncodings(fresh))
+    {
+        PyErr_Clear();
+        Py_DECREF(fresh);
+        return 0;
+    }
+
+    return fresh;
+}
+
 static char close_doc[] =
     "Close the connection now (rather than whenever __del__ is called).\n"
     "\n"
@@ -443,7 +563,9 @@ static char close_doc[] =
     "applies to all cursor objects trying to use the connection.\n"
     "\n"
     "Note that closing a connection without committing the changes first will cause\n"
-    "an implicit rollback to be performed.";
+    "an implicit rollback to be performed.\n"
+    "\n"
+    "A connection from a Pool is returned to the pool instead.";
 
 static PyObject* Connection_close(PyObject* self, PyObject* args)
 {
@@ -453,6 +575,9 @@ static PyObject* Connection_close(PyObject* self, PyObject* args)
     if (!cnxn)
         return 0;
 
+    if (cnxn->pool)
+        Pool_Return(cnxn);
+
     Connection_clear(self);
 
     Py_RETURN_NONE;
@@ -942,6 +1067,53 @@ static int Connection_setmaxwrite(PyObject* self, PyObject* value, void* closure
     return 0;
 }
 
+static const char* const decimal_mode_names[] = { "decimal", "float", "str", "int" };
+// Indexed by DecimalMode.
+
+static PyObject* Connection_getdecimal_mode(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyUnicode_FromString(decimal_mode_names[cnxn->decimal_mode]);
+}
+
+static int Connection_setdecimal_mode(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the decimal_mode attribute.");
+        return -1;
+    }
+
+    if (!PyUnicode_Check(value))
+    {
+        PyErr_SetString(PyExc_TypeError, "decimal_mode must be a string.");
+        return -1;
+    }
+
+    for (int i = 0; i < (int)_countof(decimal_mode_names); i++)
+    {
+        if (PyUnicode_CompareWithASCIIString(value, decimal_mode_names[i]) == 0)
+        {
+            cnxn->decimal_mode = i;
+            return 0;
+        }
+    }
+
+    PyErr_SetString(PyExc_ValueError, "decimal_mode must be 'decimal', 'float', 'str', or 'int'.");
+    return -1;
+}
+
 
 static PyObject* Connection_gettimeout(PyObject* self, void* closure)
 {
@@ -991,6 +1163,50 @@ static int Connection_settimeout(PyObject* self, PyObject* value, void* closure)
     return 0;
 }
 
+static PyObject* Connection_getstatement_cache_size(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return 0;
+
+    return PyLong_FromLong(cnxn->stmtcache_size);
+}
+
+static int Connection_setstatement_cache_size(PyObject* self, PyObject* value, void* closure)
+{
+    UNUSED(closure);
+
+    Connection* cnxn = Connection_Validate(self);
+    if (!cnxn)
+        return -1;
+
+    if (value == 0)
+    {
+        PyErr_SetString(PyExc_TypeError, "Cannot delete the statement_cache_size attribute.");
+        return -1;
+    }
+    long size = PyLong_AsLong(value);
+    if (size == -1 && PyErr_Occurred())
+        return -1;
+    if (size < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "Cannot set a negative statement_cache_size.");
+        return -1;
+    }
+    if (size > INT_MAX)
+    {
+        PyErr_SetString(PyExc_OverflowError, "statement_cache_size is too large.");
+        return -1;
+    }
+
+    cnxn->stmtcache_size = (int)size;
+    TrimStatementCache(cnxn);
+
+    return 0;
+}
+
 static bool _remove_converter(PyObject* self, SQLSMALLINT sqltype)
 {
     Connection* cnxn = (Connection*)self;
@@ -1335,7 +1551,8 @@ static PyObject* Connection_enter(PyObject* self, PyObject* args)
     return self;
 }
 
-static char exit_doc[] = "__exit__(*excinfo) -> None.  Commits the connection if necessary.";
+static char exit_doc[] = "__exit__(*excinfo) -> None.  Commits the connection if necessary and returns a pooled\n"
+                         "connection to its pool.";
 static PyObject* Connection_exit(PyObject* self, PyObject* args)
 {
     Connection* cnxn = (Connection*)self;
@@ -1358,6 +1575,12 @@ static PyObject* Connection_exit(PyObject* self, PyObject* args)
         }
     }
 
+    if (cnxn->pool)
+    {
+        Pool_Return(cnxn);
+        Connection_clear(self);
+    }
+
     Py_RETURN_NONE;
 }
 
@@ -1394,6 +1617,13 @@ static PyGetSetDef Connection_getseters[] = {
     { "timeout", Connection_gettimeout, Connection_settimeout,
       "The timeout in seconds, zero means no timeout.", 0 },
     { "maxwrite", Connection_getmaxwrite, Connection_setmaxwrite, "The maximum bytes to write before using SQLPutData.", 0 },
+    { "statement_cache_size", Connection_getstatement_cache_size, Connection_setstatement_cache_size,
+      "The number of prepared statements the connection keeps for reuse by its cursors after\n"
+      "they move on to other SQL or are closed.  Zero, the default, disables the cache.", 0 },
+    { "decimal_mode", Connection_getdecimal_mode, Connection_setdecimal_mode,
+      "The type decimal and numeric columns are returned as: 'decimal' (the default), 'float',\n"
+      "'str', or 'int'.  With 'int' the value is scaled by 10**scale, where scale is the\n"
+      "column's scale in Cursor.description.  Takes effect when the next query is executed.", 0 },
     { 0 }
 };
 
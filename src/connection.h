@@ -17,6 +17,16 @@ struct Cursor;
 extern PyTypeObject ConnectionType;
 
 struct TextEnc;
+struct CachedStatement;
+
+// The types decimal and numeric columns are returned as.  See Connection.decimal_mode.
+enum DecimalMode
+{
+    DECIMAL_MODE_DECIMAL,       // decimal.Decimal
+    DECIMAL_MODE_FLOAT,         // float, read as SQL_C_DOUBLE
+    DECIMAL_MODE_STR,           // the text from the driver, unparsed
+    DECIMAL_MODE_INT            // an int scaled by 10**scale, where scale is in Cursor.description
+};
 
 struct Connection
 {
@@ -67,6 +77,25 @@ struct Connection
     // small calls to SQLPutData).  If this is zero the values from
     // SQLGetTypeInfo are used.  Otherwise this value is used.
 
+    int decimal_mode;
+    // One of the DecimalMode values.  Cursors copy this when a result set is created.
+
+    CachedStatement* stmtcache_head;
+    CachedStatement* stmtcache_tail;
+    int stmtcache_count;
+    int stmtcache_size;
+    // Prepared statements not in use by any cursor, most recently used first, and the maximum
+    // number to keep (Connection.statement_cache_size).  Zero disables the cache.  See
+    // stmtcache.h.
+
+    Cursor* cursors;
+    // The cursors that have not been closed, linked through Cursor.next_cursor.  A pooled
+    // connection's cursors are closed when it is returned so their statements don't use it.
+
+    PyObject* pool;
+    // The Pool this connection was lent by, or zero.  Closing the connection returns it to the
+    // pool.  See pool.h.
+
     // These are copied from cnxn info for performance and convenience.
 
     int varchar_maxlength;
@@ -102,9 +131,21 @@ struct Connection
 /*
  * Used by the module's connect function to create new connection objects.  If unable to connect to the database, an
  * exception is set and zero is returned.
+ *
+ * If pinfo is not zero and *pinfo is a CnxnInfo, it is used instead of looking one up for the connection string.
+ * Otherwise *pinfo is set to a new reference to the CnxnInfo used.
  */
 PyObject* Connection_New(PyObject* pConnectString, bool fAutoCommit, long timeout, bool fReadOnly,
-                         PyObject* attrs_before, PyObject* encoding);
+                         PyObject* attrs_before, PyObject* encoding, PyObject** pinfo = 0);
+
+/*
+ * Used by Pool when a connection is returned.  Closes the connection's cursors, rolls back any
+ * transaction, restores autocommit and the settings of a new connection, and moves the HDBC
+ * into a new Connection object, leaving cnxn closed so the caller's references can no longer
+ * use it.  Returns zero, leaving cnxn open, if the connection cannot be reused.  This never
+ * sets an exception.
+ */
+Connection* Connection_Recycle(Connection* cnxn, bool fAutoCommit);
 
 /*
  * Used by the Cursor to implement commit and rollback.
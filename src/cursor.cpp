@@ -23,6 +23,11 @@
 #include "errors.h"
 #include "getdata.h"
 #include "dbspecific.h"
+#include "arrow.h"
+#include "numpyfetch.h"
+#include "blob.h"
+#include "colbind.h"
+#include "stmtcache.h"
 #include <datetime.h>
 
 enum
@@ -319,6 +324,18 @@ enum free_results_flags
     PREPARED_MASK  = 0x0C
 };
 
+static bool ReleasePrepared(Cursor* cur)
+{
+    // Called before the cursor's statement is used for something other than the SQL it was prepared with.  If the
+    // connection caches statements, the prepared statement is kept for reuse and the cursor gets a new one.
+
+    if (CacheStatement(cur) && !AllocateStatement(cur))
+        return false;
+
+    FreeParameterInfo(cur);
+    return true;
+}
+
 static bool free_results(Cursor* self, int flags)
 {
     // Internal function called any time we need to free the memory associated with query results.  It is safe to call
@@ -332,14 +349,49 @@ static bool free_results(Cursor* self, int flags)
 
     if ((flags & PREPARED_MASK) == FREE_PREPARED)
     {
-        Py_XDECREF(self->pPreparedSQL);
-        self->pPreparedSQL = 0;
+        if (!ReleasePrepared(self))
+            return false;
     }
 
+    if (self->rowset_buffer)
+    {
+        // Unbind before freeing the buffers and put the statement back to single-row fetches since the next result
+        // set may not be bound.
+        if (StatementIsValid(self))
+        {
+            Py_BEGIN_ALLOW_THREADS
+            SQLFreeStmt(self->hstmt, SQL_UNBIND);
+            SQLSetStmtAttr(self->hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+            SQLSetStmtAttr(self->hstmt, SQL_ATTR_ROW_STATUS_PTR, 0, 0);
+            SQLSetStmtAttr(self->hstmt, SQL_ATTR_ROWS_FETCHED_PTR, 0, 0);
+            Py_END_ALLOW_THREADS
+        }
+
+        PyMem_Free(self->rowset_buffer);
+        self->rowset_buffer = 0;
+    }
+
+    self->rowset_rows    = 0;
+    self->rowset_fetched = 0;
+    self->rowset_pos     = 0;
+    self->row_serial++;
+    self->result_serial++;
+    self->rowset_status  = 0;
+
+    Py_XDECREF(self->uuid_type);
+    self->uuid_type = 0;
+
     if (self->colinfos)
     {
+        for (int i = 0; i < self->colcount; i++)
+        {
+            PyMem_Free(self->colinfos[i].scratch);
+            Py_XDECREF(self->colinfos[i].converter);
+        }
+
         PyMem_Free(self->colinfos);
         self->colinfos = 0;
+        self->colcount = 0;
     }
 
     if (StatementIsValid(self))
@@ -397,9 +449,13 @@ static void closeimpl(Cursor* cur)
     //
     // This method releases the GIL lock while closing, so verify the HDBC still exists if you use it.
 
-    free_results(cur, FREE_STATEMENT | FREE_PREPARED);
+    free_results(cur, FREE_STATEMENT | KEEP_PREPARED);
 
     FreeParameterData(cur);
+
+    // Give the prepared statement to the connection so another cursor can use it.  If it is kept, the cursor no longer
+    // has a statement to free below.
+    CacheStatement(cur);
     FreeParameterInfo(cur);
 
     if (StatementIsValid(cur))
@@ -417,17 +473,45 @@ static void closeimpl(Cursor* cur)
             RaiseErrorFromHandle(cur->cnxn, "SQLFreeHandle", cur->cnxn->hdbc, SQL_NULL_HANDLE);
     }
 
+    if (cur->cnxn)
+    {
+        if (cur->prev_cursor)
+            cur->prev_cursor->next_cursor = cur->next_cursor;
+        else
+            cur->cnxn->cursors = cur->next_cursor;
+        if (cur->next_cursor)
+            cur->next_cursor->prev_cursor = cur->prev_cursor;
+        cur->next_cursor = 0;
+        cur->prev_cursor = 0;
+    }
+
     Py_XDECREF(cur->pPreparedSQL);
     Py_XDECREF(cur->description);
     Py_XDECREF(cur->map_name_to_index);
     Py_XDECREF(cur->cnxn);
     Py_XDECREF(cur->messages);
+    Py_XDECREF(cur->param_messages);
+    PyMem_Free(cur->param_status);
 
     cur->pPreparedSQL = 0;
     cur->description = 0;
     cur->map_name_to_index = 0;
     cur->cnxn = 0;
     cur->messages = 0;
+    cur->param_messages = 0;
+    cur->param_status = 0;
+    cur->param_status_count = 0;
+}
+
+bool CloseCursors(Connection* cnxn)
+{
+    // closeimpl removes each cursor from the list, so this always takes the first.  The connection must be kept alive
+    // by the caller since each cursor releases its reference.
+
+    while (cnxn->cursors)
+        closeimpl(cnxn->cursors);
+
+    return !PyErr_Occurred();
 }
 
 static char close_doc[] =
@@ -493,8 +577,17 @@ bool InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
                          &Nullable);
     Py_END_ALLOW_THREADS
 
-    pinfo->sql_type    = DataType;
-    pinfo->column_size = ColumnSize;
+    pinfo->sql_type       = DataType;
+    pinfo->column_size    = ColumnSize;
+    pinfo->decimal_digits = DecimalDigits;
+    pinfo->bind_ctype     = 0;
+    pinfo->bind_size      = 0;
+    pinfo->bind_data      = 0;
+    pinfo->bind_ind       = 0;
+    pinfo->scratch        = 0;
+    pinfo->cbScratch      = 0;
+    pinfo->getdata        = 0;
+    pinfo->converter      = 0;
 
     if (cursor->cnxn->hdbc == SQL_NULL_HANDLE)
     {
@@ -547,15 +640,144 @@ bool InitColumnInfo(Cursor* cursor, SQLUSMALLINT iCol, ColumnInfo* pinfo)
 }
 
 
-static bool PrepareResults(Cursor* cur, int cCols)
+inline size_t AlignBindSize(size_t cb)
+{
+    // Rounds a bound buffer size up so the next buffer in rowset_buffer is aligned for any of the C types we bind.
+    return (cb + 7) & ~(size_t)7;
+}
+
+
+static bool BindColumns(Cursor* cur, int cCols)
+{
+    // Called by PrepareResults when rowsetsize > 1 to bind the result columns to column-wise buffers so rows can be
+    // fetched in blocks with SQLFetchScroll instead of a SQLGetData call per value.
+    //
+    // ODBC only allows SQLGetData on columns after the last bound column and only with single-row rowsets, so we bind
+    // the leading columns up to the first one that can't be bound (LOBs, etc.).  If that is all of them, rows are
+    // fetched rowsetsize at a time.  Otherwise the bound columns still save the SQLGetData calls but rows are fetched
+    // one at a time.
+    //
+    // If this fails, an exception is set and the partial state is cleaned up by free_results.
+
+    assert(cur->rowset_buffer == 0);
+
+    int cBound = 0;
+    for (; cBound < cCols; cBound++)
+    {
+        ColumnInfo* pinfo = &cur->colinfos[cBound];
+        if (!GetBindType(cur, cBound, pinfo->bind_ctype, pinfo->bind_size))
+            return false;
+        if (pinfo->bind_ctype == 0)
+            break;
+    }
+
+    if (cBound == 0)
+        return true;
+
+    SQLULEN cRows = (cBound == cCols) ? (SQLULEN)cur->rowsetsize : 1;
+
+    size_t cb = AlignBindSize(sizeof(SQLUSMALLINT) * cRows);
+    for (int i = 0; i < cBound; i++)
+        cb += AlignBindSize((size_t)cur->colinfos[i].bind_size * cRows) + sizeof(SQLLEN) * cRows;
+
+    cur->rowset_buffer = (byte*)PyMem_Malloc(cb);
+    if (!cur->rowset_buffer)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+
+    byte* pb = cur->rowset_buffer;
+    cur->rowset_status = (SQLUSMALLINT*)pb;
+    pb += AlignBindSize(sizeof(SQLUSMALLINT) * cRows);
+
+    for (int i = 0; i < cBound; i++)
+    {
+        ColumnInfo* pinfo = &cur->colinfos[i];
+        pinfo->bind_ind = (SQLLEN*)pb;
+        pb += sizeof(SQLLEN) * cRows;
+        pinfo->bind_data = pb;
+        pb += AlignBindSize((size_t)pinfo->bind_size * cRows);
+    }
+
+    SQLRETURN ret;
+    const char* szFunc = "SQLSetStmtAttr";
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)(uintptr_t)cRows, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_ROW_STATUS_PTR, cur->rowset_status, 0);
+    if (SQL_SUCCEEDED(ret))
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_ROWS_FETCHED_PTR, &cur->rowset_fetched, 0);
+    if (SQL_SUCCEEDED(ret))
+    {
+        // The driver is allowed to substitute a smaller rowset size (01S02), so read back what it is actually using.
+        ret = SQLGetStmtAttr(cur->hstmt, SQL_ATTR_ROW_ARRAY_SIZE, &cRows, sizeof(cRows), 0);
+        if (!SQL_SUCCEEDED(ret))
+            szFunc = "SQLGetStmtAttr";
+    }
+    for (int i = 0; i < cBound && SQL_SUCCEEDED(ret); i++)
+    {
+        ColumnInfo* pinfo = &cur->colinfos[i];
+        ret = SQLBindCol(cur->hstmt, (SQLUSMALLINT)(i + 1), pinfo->bind_ctype, pinfo->bind_data, pinfo->bind_size,
+                         pinfo->bind_ind);
+        if (!SQL_SUCCEEDED(ret))
+            szFunc = "SQLBindCol";
+    }
+    Py_END_ALLOW_THREADS
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle(cur->cnxn, szFunc, cur->cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    cur->rowset_rows    = cRows;
+    cur->rowset_fetched = 0;
+    cur->rowset_pos     = 0;
+
+    return true;
+}
+
+
+static bool SnapshotSettings(Cursor* cur)
+{
+    // Captures the module settings that affect how values are returned.  See the comments in Cursor.
+
+    cur->native_uuid = UseNativeUUID();
+    cur->lowercase   = lowercase();
+
+    // uuid_type is looked up by PrepareResults if there are GUID columns.
+    Py_XDECREF(cur->uuid_type);
+    cur->uuid_type = 0;
+
+    cur->decimal_mode = cur->cnxn->decimal_mode;
+
+    return true;
+}
+
+
+static bool PrepareResults(Cursor* cur, int cCols, const ColumnInfo* saved = 0)
 {
     // Called after a SELECT has been executed to perform pre-fetch work.
     //
-    // Allocates the ColumnInfo structures describing the returned data.
+    // Allocates the ColumnInfo structures describing the returned data.  If `saved` is not zero, the columns are
+    // copied from it instead of being described.
 
     int i;
     assert(cur->colinfos == 0);
 
+    if (!SnapshotSettings(cur))
+        return false;
+
     cur->colinfos = (ColumnInfo*)PyMem_Malloc(sizeof(ColumnInfo) * cCols);
     if (cur->colinfos == 0)
     {
@@ -565,7 +787,16 @@ static bool PrepareResults(Cursor* cur, int cCols)
 
     for (i = 0; i < cCols; i++)
     {
-        if (!InitColumnInfo(cur, (SQLUSMALLINT)(i + 1), &cur->colinfos[i]))
+        if (saved)
+        {
+            ColumnInfo* pinfo = &cur->colinfos[i];
+            memset(pinfo, 0, sizeof(ColumnInfo));
+            pinfo->sql_type       = saved[i].sql_type;
+            pinfo->column_size    = saved[i].column_size;
+            pinfo->decimal_digits = saved[i].decimal_digits;
+            pinfo->is_unsigned    = saved[i].is_unsigned;
+        }
+        else if (!InitColumnInfo(cur, (SQLUSMALLINT)(i + 1), &cur->colinfos[i]))
         {
             PyMem_Free(cur->colinfos);
             cur->colinfos = 0;
@@ -573,17 +804,212 @@ static bool PrepareResults(Cursor* cur, int cCols)
         }
     }
 
+    cur->colcount = cCols;
+
+    if (cur->native_uuid)
+    {
+        for (i = 0; i < cCols; i++)
+        {
+            if (cur->colinfos[i].sql_type == SQL_GUID)
+            {
+                cur->uuid_type = GetClassForThread("uuid", "UUID");
+                if (!cur->uuid_type)
+                    return false;
+                break;
+            }
+        }
+    }
+
+    for (i = 0; i < cCols; i++)
+    {
+        if (!ResolveGetData(cur, i))
+            return false;
+    }
+
+    if (cur->rowsetsize > 1 && !BindColumns(cur, cCols))
+        return false;
+
     return true;
 }
 
 
-int GetDiagRecs(Cursor* cur)
+void FreeResultInfo(ResultInfo* info)
 {
-    // Retrieves all diagnostic records from the cursor and assigns them to the "messages" attribute.
+    if (info)
+    {
+        PyMem_Free(info->colinfos);
+        Py_XDECREF(info->description);
+        Py_XDECREF(info->map_name_to_index);
+        PyMem_Free(info);
+    }
+}
+
+
+static uint64_t ParamSignature(Cursor* cur)
+{
+    // Returns a hash (FNV-1a) of the types of the parameters bound for the current execute.  The lengths of text and
+    // binary parameters change with every value, so they are left out unless columns are bound for rowsets, the only
+    // case where a column's size must not grow.
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    if (cur->paramInfos == 0)
+        return hash;
+
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        const ParamInfo& info = cur->paramInfos[i];
 
-    PyObject* msg_list;  // the "messages" as a Python list of diagnostic records
+        SQLULEN size = info.ColumnSize;
+        switch (info.ParameterType)
+        {
+        case SQL_CHAR:
+        case SQL_VARCHAR:
+        case SQL_LONGVARCHAR:
+        case SQL_WCHAR:
+        case SQL_WVARCHAR:
+        case SQL_WLONGVARCHAR:
+        case SQL_BINARY:
+        case SQL_VARBINARY:
+        case SQL_LONGVARBINARY:
+        case SQL_SS_TABLE:
+            if (cur->rowsetsize <= 1)
+                size = 0;
+            break;
+        }
+
+        const uint64_t values[] = { (uint64_t)(uint16_t)info.ParameterType, (uint64_t)size,
+                                    (uint64_t)(uint16_t)info.DecimalDigits };
+        for (size_t j = 0; j < _countof(values); j++)
+        {
+            hash ^= values[j];
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    return hash;
+}
+
+
+static void SaveResultInfo(Cursor* cur, uint64_t paramsig)
+{
+    // Saves the columns of the result set just created by executing the cursor's prepared statement, replacing any
+    // saved before.  This is only an optimization, so running out of memory is not an error.
+
+    ResultInfo* info = (ResultInfo*)PyMem_Malloc(sizeof(ResultInfo));
+    ColumnInfo* colinfos = (ColumnInfo*)PyMem_Malloc(sizeof(ColumnInfo) * cur->colcount);
+    if (!info || !colinfos)
+    {
+        PyMem_Free(info);
+        PyMem_Free(colinfos);
+        return;
+    }
+
+    for (int i = 0; i < cur->colcount; i++)
+    {
+        memset(&colinfos[i], 0, sizeof(ColumnInfo));
+        colinfos[i].sql_type       = cur->colinfos[i].sql_type;
+        colinfos[i].column_size    = cur->colinfos[i].column_size;
+        colinfos[i].decimal_digits = cur->colinfos[i].decimal_digits;
+        colinfos[i].is_unsigned    = cur->colinfos[i].is_unsigned;
+    }
+
+    info->colcount          = cur->colcount;
+    info->colinfos          = colinfos;
+    info->paramsig          = paramsig;
+    info->description       = 0;
+    info->map_name_to_index = 0;
+    info->lowercase         = cur->lowercase;
+    info->native_uuid       = cur->native_uuid;
+    info->decimal_mode      = cur->decimal_mode;
+    info->metadata_optenc   = cur->cnxn->metadata_enc.optenc;
+
+    if (cur->cnxn->map_sqltype_to_converter == 0 && info->metadata_optenc != OPTENC_NONE)
+    {
+        info->description = cur->description;
+        Py_INCREF(info->description);
+        info->map_name_to_index = cur->map_name_to_index;
+        Py_INCREF(info->map_name_to_index);
+    }
+
+    FreeResultInfo(cur->resultinfo);
+    cur->resultinfo = info;
+}
+
+
+static bool SameColumnTypes(Cursor* cur, const ResultInfo* info)
+{
+    // Returns true if the columns of the current result set have the types saved in `info`.  A driver can recompile a
+    // statement whose tables were altered without an error, so the number of columns alone doesn't show the saved
+    // columns are still right.  If the types can't be read, false is returned so the columns are described again,
+    // which reports any error.
+
+    SQLRETURN ret = SQL_SUCCESS;
+    int i;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < info->colcount; i++)
+    {
+        SQLLEN type = 0;
+        ret = SQLColAttribute(cur->hstmt, (SQLUSMALLINT)(i + 1), SQL_DESC_CONCISE_TYPE, 0, 0, 0, &type);
+        if (!SQL_SUCCEEDED(ret) || (SQLSMALLINT)type != info->colinfos[i].sql_type)
+            break;
+    }
+    Py_END_ALLOW_THREADS
+
+    return i == info->colcount;
+}
+
+
+static bool PrepareExecuteResults(Cursor* cur, int cCols, uint64_t paramsig)
+{
+    // Called when an execute creates a result set.  The columns of a prepared statement's result set are saved the
+    // first time and reused when it is executed again with the same parameter types, skipping SQLDescribeCol for
+    // every column and rebuilding the description.  If the number of columns from SQLNumResultCols or their types have
+    // changed, the statement has changed, so the columns are described again.
+
+    ResultInfo* info = (cur->pPreparedSQL != 0) ? cur->resultinfo : 0;
+
+    if (info && (info->colcount != cCols || info->paramsig != paramsig || !SameColumnTypes(cur, info)))
+    {
+        FreeResultInfo(info);
+        cur->resultinfo = info = 0;
+    }
+
+    if (!PrepareResults(cur, cCols, info ? info->colinfos : 0))
+        return false;
+
+    if (info && info->description &&
+        cur->cnxn->map_sqltype_to_converter == 0 &&
+        info->lowercase == cur->lowercase &&
+        info->native_uuid == cur->native_uuid &&
+        info->decimal_mode == cur->decimal_mode &&
+        info->metadata_optenc == cur->cnxn->metadata_enc.optenc)
+    {
+        Py_DECREF(cur->description);
+        cur->description = info->description;
+        Py_INCREF(cur->description);
+        cur->map_name_to_index = info->map_name_to_index;
+        Py_INCREF(cur->map_name_to_index);
+        return true;
+    }
+
+    if (!create_name_map(cur, cCols, cur->lowercase))
+        return false;
+
+    if (cur->pPreparedSQL != 0)
+        SaveResultInfo(cur, paramsig);
+
+    return true;
+}
+
+
+PyObject* GetDiagRec(Cursor* cur, SQLSMALLINT iRecNumber)
+{
+    // Returns the cursor's diagnostic record iRecNumber (1-based) as a (class, message) tuple,
+    // the format used by the "messages" attribute, or zero if there is no such record.  Zero
+    // is also returned if an error occurs, in which case an exception is set.
 
-    SQLSMALLINT iRecNumber = 1;  // the index of the diagnostic records (1-based)
     uint16_t    cSQLState[6];  // five-character SQLSTATE code (plus terminating NULL)
     SQLINTEGER  iNativeError;
     SQLSMALLINT iMessageLen = 1023;
@@ -598,80 +1024,91 @@ int GetDiagRecs(Cursor* cur)
       return 0;
     }
 
-    msg_list = PyList_New(0);
-    if (!msg_list)
-        return 0;
+    cSQLState[0]    = 0;
+    iNativeError    = 0;
+    cMessageText[0] = 0;
+    iTextLength     = 0;
 
-    for (;;)
-    {
-        cSQLState[0]    = 0;
-        iNativeError    = 0;
-        cMessageText[0] = 0;
-        iTextLength     = 0;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetDiagRecW(
+        SQL_HANDLE_STMT, cur->hstmt, iRecNumber, (SQLWCHAR*)cSQLState, &iNativeError,
+        (SQLWCHAR*)cMessageText, iMessageLen, &iTextLength
+    );
+    Py_END_ALLOW_THREADS
 
+    // If needed, allocate a bigger error message buffer and retry.
+    if (SQL_SUCCEEDED(ret) && iTextLength > iMessageLen - 1) {
+        iMessageLen = iTextLength + 1;
+        uint16_t* pNew = (uint16_t*) PyMem_Realloc(cMessageText, (iMessageLen + 1) * sizeof(uint16_t));
+        if (!pNew) {
+            PyMem_Free(cMessageText);
+            PyErr_NoMemory();
+            return 0;
+        }
+        cMessageText = pNew;
         Py_BEGIN_ALLOW_THREADS
         ret = SQLGetDiagRecW(
             SQL_HANDLE_STMT, cur->hstmt, iRecNumber, (SQLWCHAR*)cSQLState, &iNativeError,
             (SQLWCHAR*)cMessageText, iMessageLen, &iTextLength
         );
         Py_END_ALLOW_THREADS
-        if (!SQL_SUCCEEDED(ret))
-            break;
+    }
 
-        // If needed, allocate a bigger error message buffer and retry.
-        if (iTextLength > iMessageLen - 1) {
-            iMessageLen = iTextLength + 1;
-            if (!PyMem_Realloc((BYTE**) &cMessageText, (iMessageLen + 1) * sizeof(uint16_t))) {
-                PyMem_Free(cMessageText);
-                PyErr_NoMemory();
-                return 0;
-            }
-            Py_BEGIN_ALLOW_THREADS
-            ret = SQLGetDiagRecW(
-                SQL_HANDLE_STMT, cur->hstmt, iRecNumber, (SQLWCHAR*)cSQLState, &iNativeError,
-                (SQLWCHAR*)cMessageText, iMessageLen, &iTextLength
-            );
-            Py_END_ALLOW_THREADS
-            if (!SQL_SUCCEEDED(ret))
-                break;
-        }
+    if (!SQL_SUCCEEDED(ret))
+    {
+        PyMem_Free(cMessageText);
+        return 0;
+    }
 
-        cSQLState[5] = 0;  // Not always NULL terminated (MS Access)
-        CopySqlState(cSQLState, sqlstate_ascii);
-        PyObject* msg_class = PyUnicode_FromFormat("[%s] (%ld)", sqlstate_ascii, (long)iNativeError);
+    cSQLState[5] = 0;  // Not always NULL terminated (MS Access)
+    CopySqlState(cSQLState, sqlstate_ascii);
+    PyObject* msg_class = PyUnicode_FromFormat("[%s] (%ld)", sqlstate_ascii, (long)iNativeError);
 
-        // Default to UTF-16, which may not work if the driver/manager is using some other encoding
-        const char *unicode_enc = cur->cnxn ? cur->cnxn->metadata_enc.name : ENCSTR_UTF16NE;
-        PyObject* msg_value = PyUnicode_Decode(
-            (char*)cMessageText, iTextLength * sizeof(uint16_t), unicode_enc, "strict"
-        );
-        if (!msg_value)
-        {
-            // If the char cannot be decoded, return something rather than nothing.
-            Py_XDECREF(msg_value);
-            msg_value = PyBytes_FromStringAndSize((char*)cMessageText, iTextLength * sizeof(uint16_t));
-        }
+    // Default to UTF-16, which may not work if the driver/manager is using some other encoding
+    const char *unicode_enc = cur->cnxn ? cur->cnxn->metadata_enc.name : ENCSTR_UTF16NE;
+    PyObject* msg_value = PyUnicode_Decode(
+        (char*)cMessageText, iTextLength * sizeof(uint16_t), unicode_enc, "strict"
+    );
+    if (!msg_value)
+    {
+        // If the char cannot be decoded, return something rather than nothing.
+        PyErr_Clear();
+        msg_value = PyBytes_FromStringAndSize((char*)cMessageText, iTextLength * sizeof(uint16_t));
+    }
+    PyMem_Free(cMessageText);
 
-        PyObject* msg_tuple = PyTuple_New(2);  // the message as a Python tuple of class and value
+    PyObject* msg_tuple = PyTuple_New(2);  // the message as a Python tuple of class and value
 
-        if (msg_class && msg_value && msg_tuple)
-        {
-            PyTuple_SetItem(msg_tuple, 0, msg_class);  // msg_tuple now owns the msg_class reference
-            PyTuple_SetItem(msg_tuple, 1, msg_value);  // msg_tuple now owns the msg_value reference
+    if (!msg_class || !msg_value || !msg_tuple)
+    {
+        Py_XDECREF(msg_class);
+        Py_XDECREF(msg_value);
+        Py_XDECREF(msg_tuple);
+        return 0;
+    }
 
-            PyList_Append(msg_list, msg_tuple);
-            Py_XDECREF(msg_tuple);  // whether PyList_Append succeeds or not
-        }
-        else
-        {
-            Py_XDECREF(msg_class);
-            Py_XDECREF(msg_value);
-            Py_XDECREF(msg_tuple);
-        }
+    PyTuple_SET_ITEM(msg_tuple, 0, msg_class);  // msg_tuple now owns the msg_class reference
+    PyTuple_SET_ITEM(msg_tuple, 1, msg_value);  // msg_tuple now owns the msg_value reference
+    return msg_tuple;
+}
+
+
+int GetDiagRecs(Cursor* cur)
+{
+    // Retrieves all diagnostic records from the cursor and assigns them to the "messages" attribute.
 
-        iRecNumber++;
+    PyObject* msg_list = PyList_New(0);  // the "messages" as a Python list of diagnostic records
+    if (!msg_list)
+        return 0;
+
+    for (SQLSMALLINT iRecNumber = 1; ; iRecNumber++)
+    {
+        PyObject* msg_tuple = GetDiagRec(cur, iRecNumber);
+        if (!msg_tuple)
+            break;
+        PyList_Append(msg_list, msg_tuple);
+        Py_DECREF(msg_tuple);  // whether PyList_Append succeeds or not
     }
-    PyMem_Free(cMessageText);
 
     Py_XDECREF(cur->messages);
     cur->messages = msg_list;  // cur->messages now owns the msg_list reference
@@ -733,8 +1170,8 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
         // REVIEW: Why don't we always prepare?  It is highly unlikely that a user would need to execute the same SQL
         // repeatedly if it did not have parameters, so we are not losing performance, but it would simplify the code.
 
-        Py_XDECREF(cur->pPreparedSQL);
-        cur->pPreparedSQL = 0;
+        if (!ReleasePrepared(cur))
+            return 0;
 
         szLastFunction = "SQLExecDirect";
 
@@ -771,7 +1208,10 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
         // We could try dropping through the while and if below, but if there is an error, we need to raise it before
         // FreeParameterData calls more ODBC functions.
         RaiseErrorFromHandle(cur->cnxn, "SQLExecDirectW", cur->cnxn->hdbc, cur->hstmt);
+        bool schema_changed = cur->pPreparedSQL != 0 && IsSchemaChangeError(cur->hstmt);
         FreeParameterData(cur);
+        if (schema_changed)
+            InvalidatePrepared(cur);
         return 0;
     }
 
@@ -837,6 +1277,18 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
                 }
                 while (offset < cb);
             }
+            else if (pInfo->stream)
+            {
+                if (!PutStreamData(cur, pInfo->pObject, pInfo->pChunk, pInfo->ValueType, pInfo->maxlength))
+                {
+                    // Cancel the execute so the statement isn't left waiting for data.
+                    Py_BEGIN_ALLOW_THREADS
+                    SQLCancel(cur->hstmt);
+                    Py_END_ALLOW_THREADS
+                    FreeParameterData(cur);
+                    return 0;
+                }
+            }
             else if (pInfo->ParameterType == SQL_SS_TABLE)
             {
                 // TVP
@@ -901,6 +1353,10 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
         }
     }
 
+    // The columns of a prepared statement's results can depend on the parameter types, so note them before the
+    // parameters are freed.
+    uint64_t paramsig = ParamSignature(cur);
+
     FreeParameterData(cur);
 
     if (ret == SQL_NO_DATA)
@@ -952,10 +1408,7 @@ static PyObject* execute(Cursor* cur, PyObject* pSql, PyObject* params, bool ski
     {
         // A result set was created.
 
-        if (!PrepareResults(cur, cCols))
-            return 0;
-
-        if (!create_name_map(cur, cCols, lowercase()))
+        if (!PrepareExecuteResults(cur, cCols, paramsig))
             return 0;
     }
 
@@ -1066,6 +1519,8 @@ static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
             free_results(cursor, FREE_STATEMENT | KEEP_PREPARED);
             if (!ExecuteMulti(cursor, pSql, param_seq))
                 return 0;
+            // ExecuteMulti sets rowcount to the total for all batches.
+            Py_RETURN_NONE;
         }
         else
         {
@@ -1084,6 +1539,14 @@ static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
             }
         }
     }
+    else if (cursor->fastexecmany && (PyGen_Check(param_seq) || PyIter_Check(param_seq)))
+    {
+        // The rows are read from the iterator a batch at a time, so it is never materialized.
+        free_results(cursor, FREE_STATEMENT | KEEP_PREPARED);
+        if (!ExecuteMulti(cursor, pSql, param_seq))
+            return 0;
+        Py_RETURN_NONE;
+    }
     else if (PyGen_Check(param_seq) || PyIter_Check(param_seq))
     {
         Object iter;
@@ -1106,27 +1569,93 @@ static PyObject* Cursor_executemany(PyObject* self, PyObject* args)
             bool success = result != 0;
             Py_XDECREF(result);
 
-            if (!success)
-            {
-                cursor->rowcount = -1;
-                return 0;
-            }
-        }
+            if (!success)
+            {
+                cursor->rowcount = -1;
+                return 0;
+            }
+        }
+
+        if (PyErr_Occurred())
+            return 0;
+    }
+    else
+    {
+        PyErr_SetString(ProgrammingError, "The second parameter to executemany must be a sequence, iterator, or generator.");
+        return 0;
+    }
+
+    cursor->rowcount = -1;
+
+    Py_RETURN_NONE;
+}
+
+static char executemany_columns_doc[] =
+    "executemany_columns(sql, columns, masks=None) --> None\n"
+    "\n"
+    "Executes the statement once for each row of the parameter columns.  columns is\n"
+    "a sequence with one one-dimensional array per parameter, such as NumPy arrays,\n"
+    "array.array objects, or memoryviews of integers, floats, or booleans.  The\n"
+    "arrays are bound column-wise and read by the driver without being copied.\n"
+    "\n"
+    "masks is None or a sequence with one item per column that is None or an array\n"
+    "of bytes that are non-zero for null values.  If a column is a NumPy masked\n"
+    "array and its mask is None, the array's mask is used.";
+
+char* Cursor_executemany_columns_kwnames[] = { "sql", "columns", "masks", 0 };
+
+static PyObject* Cursor_executemany_columns(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    cursor->rowcount = -1;
+
+    PyObject *pSql, *columns, *masks = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "UO|O", Cursor_executemany_columns_kwnames, &pSql, &columns, &masks))
+        return 0;
+
+    free_results(cursor, FREE_STATEMENT | KEEP_PREPARED);
+    if (!ExecuteColumns(cursor, pSql, columns, masks))
+        return 0;
+
+    Py_RETURN_NONE;
+}
+
+static char executemany_arrow_doc[] =
+    "executemany_arrow(sql, reader) --> None\n"
+    "\n"
+    "Executes the statement once for each row of an Arrow object that supports the\n"
+    "Arrow PyCapsule interface (__arrow_c_stream__), such as a pyarrow Table or\n"
+    "RecordBatchReader.  Each column is a parameter.  Each record batch is bound\n"
+    "column-wise and executed with a single call to the driver.\n"
+    "\n"
+    "Integer, floating point, boolean, utf8, binary, date, and timestamp columns are\n"
+    "supported.  Timestamps with a time zone are passed as UTC.";
+
+char* Cursor_executemany_arrow_kwnames[] = { "sql", "reader", 0 };
 
-        if (PyErr_Occurred())
-            return 0;
-    }
-    else
-    {
-        PyErr_SetString(ProgrammingError, "The second parameter to executemany must be a sequence, iterator, or generator.");
+static PyObject* Cursor_executemany_arrow(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
         return 0;
-    }
 
     cursor->rowcount = -1;
 
+    PyObject *pSql, *reader;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "UO", Cursor_executemany_arrow_kwnames, &pSql, &reader))
+        return 0;
+
+    free_results(cursor, FREE_STATEMENT | KEEP_PREPARED);
+    if (!ExecuteArrow(cursor, pSql, reader))
+        return 0;
+
     Py_RETURN_NONE;
 }
 
+
 static PyObject* Cursor_setinputsizes(PyObject* self, PyObject* sizes)
 {
     if (!Cursor_Check(self))
@@ -1157,18 +1686,82 @@ static PyObject* Cursor_setinputsizes(PyObject* self, PyObject* sizes)
     Py_RETURN_NONE;
 }
 
-static PyObject* Cursor_fetch(Cursor* cur)
+static bool FetchRowset(Cursor* cur)
 {
-    // Internal function to fetch a single row and construct a Row object from it.  Used by all of the fetching
-    // functions.
+    // Fetches the next rowset into the bound column buffers when fetching rowsets and resets rowset_pos.
     //
-    // Returns a Row object if successful.  If there are no more rows, zero is returned.  If an error occurs, an
-    // exception is set and zero is returned.  (To differentiate between the last two, use PyErr_Occurred.)
+    // Returns true if any rows were fetched.  Returns false if there are no more rows or an error occurs, in which case
+    // an exception is set.  (To differentiate between the two, use PyErr_Occurred.)
 
-    SQLRETURN ret = 0;
-    Py_ssize_t field_count, i;
-    PyObject** apValues;
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLFetchScroll(cur->hstmt, SQL_FETCH_NEXT, 0);
+    Py_END_ALLOW_THREADS
+
+    cur->rowset_pos = 0;
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        cur->rowset_fetched = 0;
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (ret == SQL_NO_DATA)
+    {
+        cur->rowset_fetched = 0;
+        return false;
+    }
+
+    if (SQL_SUCCEEDED(ret))
+    {
+        // A row that could not be fetched is only reported as a warning for the rowset and the row's buffers are
+        // undefined, so treat it as an error for the fetch.
+        for (SQLULEN i = 0; i < cur->rowset_fetched; i++)
+        {
+            if (cur->rowset_status[i] == SQL_ROW_ERROR)
+            {
+                ret = SQL_ERROR;
+                break;
+            }
+        }
+    }
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        cur->rowset_fetched = 0;
+        RaiseErrorFromHandle(cur->cnxn, "SQLFetchScroll", cur->cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    return cur->rowset_fetched != 0;
+}
+
+
+bool Cursor_NextRow(Cursor* cur, SQLULEN& iRow)
+{
+    // Moves to the next row of the result set.  When fetching rowsets, iRow is set to the row's index in the bound
+    // buffers.  Otherwise it is set to 0.
+    //
+    // Returns true if there is a row.  If there are no more rows or an error occurs, false is returned.  (To
+    // differentiate between the two, use PyErr_Occurred.)
+
+    iRow = 0;
+    cur->row_serial++;
+
+    if (cur->rowset_rows > 1)
+    {
+        // Fetching rowsets.  Use the next row in the bound buffers, fetching another rowset when they are used up.
+
+        if (cur->rowset_pos >= cur->rowset_fetched && !FetchRowset(cur))
+            return false;
+
+        iRow = cur->rowset_pos++;
+        return true;
+    }
 
+    SQLRETURN ret;
     Py_BEGIN_ALLOW_THREADS
     ret = SQLFetch(cur->hstmt);
     Py_END_ALLOW_THREADS
@@ -1176,14 +1769,37 @@ static PyObject* Cursor_fetch(Cursor* cur)
     if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
     {
         // The connection was closed by another thread in the ALLOW_THREADS block above.
-        return RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
     }
 
     if (ret == SQL_NO_DATA)
-        return 0;
+        return false;
 
     if (!SQL_SUCCEEDED(ret))
-        return RaiseErrorFromHandle(cur->cnxn, "SQLFetch", cur->cnxn->hdbc, cur->hstmt);
+    {
+        RaiseErrorFromHandle(cur->cnxn, "SQLFetch", cur->cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    return true;
+}
+
+
+static PyObject* Cursor_fetch(Cursor* cur)
+{
+    // Internal function to fetch a single row and construct a Row object from it.  Used by all of the fetching
+    // functions.
+    //
+    // Returns a Row object if successful.  If there are no more rows, zero is returned.  If an error occurs, an
+    // exception is set and zero is returned.  (To differentiate between the last two, use PyErr_Occurred.)
+
+    Py_ssize_t field_count, i;
+    PyObject** apValues;
+    SQLULEN iRow;
+
+    if (!Cursor_NextRow(cur, iRow))
+        return 0;
 
     field_count = PyTuple_GET_SIZE(cur->description);
 
@@ -1194,7 +1810,7 @@ static PyObject* Cursor_fetch(Cursor* cur)
 
     for (i = 0; i < field_count; i++)
     {
-        PyObject* value = GetData(cur, i);
+        PyObject* value = cur->colinfos[i].bind_ctype ? GetBoundData(cur, i, iRow) : GetData(cur, i);
 
         if (!value)
         {
@@ -1937,7 +2553,7 @@ static PyObject* Cursor_nextset(PyObject* self, PyObject* args)
         if (!PrepareResults(cur, cCols))
             return 0;
 
-        if (!create_name_map(cur, cCols, lowercase()))
+        if (!create_name_map(cur, cCols, cur->lowercase))
             return 0;
     }
 
@@ -2098,6 +2714,28 @@ static PyObject* Cursor_skip(PyObject* self, PyObject* args)
     if (count == 0)
         Py_RETURN_NONE;
 
+    cursor->row_serial++;
+
+    if (cursor->rowset_rows > 1)
+    {
+        // Fetching rowsets, so skip what is left of the current rowset before fetching more.
+        while (count > 0)
+        {
+            if (cursor->rowset_pos >= cursor->rowset_fetched && !FetchRowset(cursor))
+            {
+                if (PyErr_Occurred())
+                    return 0;
+                break;
+            }
+
+            SQLULEN n = min((SQLULEN)count, cursor->rowset_fetched - cursor->rowset_pos);
+            cursor->rowset_pos += n;
+            count -= (int)n;
+        }
+
+        Py_RETURN_NONE;
+    }
+
     // Note: I'm not sure about the performance implications of looping here -- I certainly would rather use
     // SQLFetchScroll(SQL_FETCH_RELATIVE, count), but it requires scrollable cursors which are often slower.  I would
     // not expect skip to be used in performance intensive code since different SQL would probably be the "right"
@@ -2115,6 +2753,151 @@ static PyObject* Cursor_skip(PyObject* self, PyObject* args)
     Py_RETURN_NONE;
 }
 
+static char fetchnumpy_doc[] =
+    "fetchnumpy(size=None) --> dict of column name to numpy.ma.MaskedArray\n"
+    "\n"
+    "Fetches up to size rows, or all remaining rows if size is None, into NumPy\n"
+    "arrays, one per column.  Nulls are masked.\n"
+    "\n"
+    "Integer columns are returned as int64, floating point as float64, bit as bool,\n"
+    "dates as datetime64[D], and timestamps as datetime64[us].  These are read\n"
+    "directly into the arrays without creating Python objects.  All other columns\n"
+    "(and columns with an output converter) are returned as object arrays.";
+
+char* Cursor_fetchnumpy_kwnames[] = { "size", 0 };
+
+static PyObject* Cursor_fetchnumpy(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_RESULTS | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    PyObject* pSize = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", Cursor_fetchnumpy_kwnames, &pSize))
+        return 0;
+
+    Py_ssize_t size = -1;
+    if (pSize != Py_None)
+    {
+        size = PyNumber_AsSsize_t(pSize, PyExc_OverflowError);
+        if (size == -1 && PyErr_Occurred())
+            return 0;
+        if (size < 1)
+        {
+            PyErr_SetString(PyExc_ValueError, "size must be greater than zero.");
+            return 0;
+        }
+    }
+
+    return FetchNumpy(cursor, size);
+}
+
+static char fetch_arrow_doc[] =
+    "fetch_arrow(batch_rows=65536) --> ArrowStream\n"
+    "\n"
+    "Returns an object that exports the remaining rows of the result set using the\n"
+    "Arrow PyCapsule interface (__arrow_c_stream__), reading up to batch_rows rows\n"
+    "into each record batch.  Values are read directly into Arrow buffers without\n"
+    "creating Row objects, so output converters are not applied.\n"
+    "\n"
+    "  table = pyarrow.table(cursor.fetch_arrow())";
+
+char* Cursor_fetch_arrow_kwnames[] = { "batch_rows", 0 };
+
+static PyObject* Cursor_fetch_arrow(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_RESULTS | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    Py_ssize_t batch_rows = ARROW_DEFAULT_BATCH_ROWS;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n", Cursor_fetch_arrow_kwnames, &batch_rows))
+        return 0;
+
+    if (batch_rows < 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "batch_rows must be greater than zero.");
+        return 0;
+    }
+
+    return ArrowStream_New(cursor, batch_rows);
+}
+
+static char open_blob_doc[] =
+    "open_blob(column) --> BlobReader\n"
+    "\n"
+    "Moves to the next row and returns a file-like object that reads the given\n"
+    "column, by index or name, in chunks instead of reading the whole value into\n"
+    "memory.  The values of the columns before it are in the reader's values\n"
+    "attribute; the columns after it are skipped.  Returns None if there are no\n"
+    "more rows.\n"
+    "\n"
+    "The value is returned as bytes, so text columns are in the database's\n"
+    "encoding.  The reader can only be used until the cursor moves again.";
+
+char* Cursor_open_blob_kwnames[] = { "column", 0 };
+
+static PyObject* Cursor_open_blob(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_RESULTS | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    PyObject* column;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", Cursor_open_blob_kwnames, &column))
+        return 0;
+
+    Py_ssize_t iCol;
+    if (PyUnicode_Check(column))
+    {
+        PyObject* index = PyDict_GetItem(cursor->map_name_to_index, column);
+        if (!index)
+            return RaiseErrorV(0, ProgrammingError, "The result set does not have a column named '%U'.", column);
+        iCol = PyLong_AsSsize_t(index);
+    }
+    else
+    {
+        iCol = PyNumber_AsSsize_t(column, PyExc_IndexError);
+        if (iCol == -1 && PyErr_Occurred())
+            return 0;
+        if (iCol < 0 || iCol >= cursor->colcount)
+        {
+            PyErr_SetString(PyExc_IndexError, "column index out of range");
+            return 0;
+        }
+    }
+
+    if (cursor->colinfos[iCol].bind_ctype)
+    {
+        // Bound columns have already been read into the rowset buffers by SQLFetchScroll.
+        return RaiseErrorV(0, ProgrammingError,
+                           "Column %zd is bound for fetching rowsets.  Set rowsetsize to 1 to use open_blob.", iCol);
+    }
+
+    SQLULEN iRow;
+    if (!Cursor_NextRow(cursor, iRow))
+    {
+        if (PyErr_Occurred())
+            return 0;
+        Py_RETURN_NONE;
+    }
+
+    // ODBC drivers generally require columns to be read in order, so read the earlier ones now.
+    Object values(PyTuple_New(iCol));
+    if (!values)
+        return 0;
+
+    for (Py_ssize_t i = 0; i < iCol; i++)
+    {
+        PyObject* value = cursor->colinfos[i].bind_ctype ? GetBoundData(cursor, i, iRow) : GetData(cursor, i);
+        if (!value)
+            return 0;
+        PyTuple_SET_ITEM(values.Get(), i, value);
+    }
+
+    return BlobReader_New(cursor, iCol, values.Detach());
+}
+
 static const char* commit_doc =
     "Commits any pending transaction to the database on the current connection,\n"
     "including those from other cursors.\n";
@@ -2197,6 +2980,14 @@ static char arraysize_doc[] =
     "This read/write attribute specifies the number of rows to fetch at a time with\n" \
     "fetchmany(). It defaults to 1 meaning to fetch a single row at a time.";
 
+static char rowsetsize_doc[] =
+    "This read/write attribute specifies the number of rows to fetch from the driver\n" \
+    "at a time using bound column buffers.  It defaults to 1, which reads each value\n" \
+    "with SQLGetData.  Larger values speed up fetchone(), fetchmany(), fetchall(), and\n" \
+    "iteration of large result sets.  Result sets with columns that cannot be bound,\n" \
+    "such as LOBs, are fetched a row at a time.  Changes take effect on the next\n" \
+    "execute.";
+
 static char connection_doc[] =
     "This read-only attribute return a reference to the Connection object on which\n" \
     "the cursor was created.\n" \
@@ -2208,18 +2999,53 @@ static char fastexecmany_doc[] =
     "This read/write attribute specifies whether to use a faster executemany() which\n" \
     "uses parameter arrays. Not all drivers may work with this implementation.";
 
+static char fastexecmany_batch_rows_doc[] =
+    "This read/write attribute limits the number of rows fast executemany converts\n" \
+    "and sends to the driver at a time.  Zero, the default, means no limit.  While one\n" \
+    "batch is executing, the next is converted.";
+
+static char fastexecmany_batch_bytes_doc[] =
+    "This read/write attribute limits the size in bytes of the parameter array fast\n" \
+    "executemany allocates.  Rows are converted and sent to the driver in batches\n" \
+    "that fit.  Zero means no limit.  The default is 32MB.";
+
+static char fastexecmany_max_inline_doc[] =
+    "This read/write attribute is the size in bytes of the largest value fast\n" \
+    "executemany copies into the parameter array for varchar(max), nvarchar(max),\n" \
+    "and varbinary(max) parameters.  Longer values are sent separately using\n" \
+    "SQLPutData, which requires a round trip for each value.  Zero means always use\n" \
+    "SQLPutData.  The default is 8000.";
+
+static char fastexecmany_continue_doc[] =
+    "This read/write attribute specifies whether fast executemany keeps executing the\n" \
+    "remaining rows when some rows fail instead of raising an error.  Check\n" \
+    "param_status and param_messages for the rows that failed.  File-like objects\n" \
+    "and iterators can't be used as parameters when this is set.  The default is\n" \
+    "False.";
+
 static char messages_doc[] =
     "This read-only attribute is a list of all the diagnostic messages in the\n" \
     "current result set.";
 
+static char param_messages_doc[] =
+    "This read-only attribute is a list of the diagnostic messages from the last fast\n" \
+    "executemany as (row, class, message) tuples, where row is the index of the row of\n" \
+    "parameters the message is for or None if the driver did not say.";
+
 static PyMemberDef Cursor_members[] =
 {
     {"rowcount",    T_INT,       offsetof(Cursor, rowcount),        READONLY, rowcount_doc },
     {"description", T_OBJECT_EX, offsetof(Cursor, description),     READONLY, description_doc },
     {"arraysize",   T_INT,       offsetof(Cursor, arraysize),       0,        arraysize_doc },
+    {"rowsetsize",  T_INT,       offsetof(Cursor, rowsetsize),      0,        rowsetsize_doc },
     {"connection",  T_OBJECT_EX, offsetof(Cursor, cnxn),            READONLY, connection_doc },
     {"fast_executemany",T_BOOL,  offsetof(Cursor, fastexecmany),    0,        fastexecmany_doc },
+    {"fast_executemany_batch_rows", T_PYSSIZET, offsetof(Cursor, fastexecmany_batch_rows), 0, fastexecmany_batch_rows_doc },
+    {"fast_executemany_batch_bytes", T_PYSSIZET, offsetof(Cursor, fastexecmany_batch_bytes), 0, fastexecmany_batch_bytes_doc },
+    {"fast_executemany_max_inline", T_PYSSIZET, offsetof(Cursor, fastexecmany_max_inline), 0, fastexecmany_max_inline_doc },
+    {"fast_executemany_continue_on_error", T_BOOL, offsetof(Cursor, fastexecmany_continue), 0, fastexecmany_continue_doc },
     {"messages",    T_OBJECT_EX, offsetof(Cursor, messages),        READONLY, messages_doc },
+    {"param_messages", T_OBJECT_EX, offsetof(Cursor, param_messages), READONLY, param_messages_doc },
     { 0 }
 };
 
@@ -2274,12 +3100,51 @@ static int Cursor_setnoscan(PyObject* self, PyObject* value, void *closure)
         return -1;
     }
 
+    // Any statement already prepared was scanned (or not) using the old setting.
+    cursor->noscan = (noscan == SQL_NOSCAN_ON);
+    FreeParameterInfo(cursor);
+
     return 0;
 }
 
+static PyObject* Cursor_getparam_status(PyObject* self, void *closure)
+{
+    UNUSED(closure);
+
+    Cursor* cursor = Cursor_Validate(self, CURSOR_REQUIRE_OPEN | CURSOR_RAISE_ERROR);
+    if (!cursor)
+        return 0;
+
+    if (!cursor->param_status)
+        Py_RETURN_NONE;
+
+    PyObject* list = PyList_New(cursor->param_status_count);
+    if (!list)
+        return 0;
+
+    for (Py_ssize_t i = 0; i < cursor->param_status_count; i++)
+    {
+        PyObject* status = PyLong_FromLong(cursor->param_status[i]);
+        if (!status)
+        {
+            Py_DECREF(list);
+            return 0;
+        }
+        PyList_SET_ITEM(list, i, status);
+    }
+
+    return list;
+}
+
+static char param_status_doc[] =
+    "The status of each row of parameters in the last fast executemany, a list of\n" \
+    "SQL_PARAM_SUCCESS, SQL_PARAM_SUCCESS_WITH_INFO, SQL_PARAM_ERROR, SQL_PARAM_UNUSED,\n" \
+    "or SQL_PARAM_DIAG_UNAVAILABLE, or None.";
+
 static PyGetSetDef Cursor_getsetters[] =
 {
     {"noscan", Cursor_getnoscan, Cursor_setnoscan, "NOSCAN statement attr", 0},
+    {"param_status", Cursor_getparam_status, 0, param_status_doc, 0},
     { 0 }
 };
 
@@ -2388,6 +3253,8 @@ static PyMethodDef Cursor_methods[] =
     { "close",            (PyCFunction)Cursor_close,            METH_NOARGS,                close_doc            },
     { "execute",          (PyCFunction)Cursor_execute,          METH_VARARGS,               execute_doc          },
     { "executemany",      (PyCFunction)Cursor_executemany,      METH_VARARGS,               executemany_doc      },
+    { "executemany_columns", (PyCFunction)Cursor_executemany_columns, METH_VARARGS|METH_KEYWORDS, executemany_columns_doc },
+    { "executemany_arrow", (PyCFunction)Cursor_executemany_arrow, METH_VARARGS|METH_KEYWORDS, executemany_arrow_doc },
     { "setinputsizes",    (PyCFunction)Cursor_setinputsizes,    METH_O,                     setinputsizes_doc    },
     { "setoutputsize",    (PyCFunction)Cursor_ignored,          METH_VARARGS,               ignored_doc          },
     { "fetchval",         (PyCFunction)Cursor_fetchval,         METH_NOARGS,                fetchval_doc         },
@@ -2406,6 +3273,9 @@ static PyMethodDef Cursor_methods[] =
     { "procedures",       (PyCFunction)Cursor_procedures,       METH_VARARGS|METH_KEYWORDS, procedures_doc       },
     { "procedureColumns", (PyCFunction)Cursor_procedureColumns, METH_VARARGS|METH_KEYWORDS, procedureColumns_doc },
     { "skip",             (PyCFunction)Cursor_skip,             METH_VARARGS,               skip_doc             },
+    { "fetchnumpy",       (PyCFunction)Cursor_fetchnumpy,       METH_VARARGS|METH_KEYWORDS, fetchnumpy_doc       },
+    { "fetch_arrow",      (PyCFunction)Cursor_fetch_arrow,      METH_VARARGS|METH_KEYWORDS, fetch_arrow_doc      },
+    { "open_blob",        (PyCFunction)Cursor_open_blob,        METH_VARARGS|METH_KEYWORDS, open_blob_doc        },
     { "commit",           (PyCFunction)Cursor_commit,           METH_NOARGS,                commit_doc           },
     { "rollback",         (PyCFunction)Cursor_rollback,         METH_NOARGS,                rollback_doc         },
     {"cancel",           (PyCFunction)Cursor_cancel,           METH_NOARGS,                cancel_doc},
@@ -2493,55 +3363,101 @@ Cursor_New(Connection* cnxn)
     {
         cur->cnxn              = cnxn;
         cur->hstmt             = SQL_NULL_HANDLE;
+        cur->timeout           = cnxn->timeout;
+        cur->noscan            = false;
         cur->description       = Py_None;
         cur->pPreparedSQL      = 0;
         cur->paramcount        = 0;
-        cur->paramtypes        = 0;
+        cur->paramdescs        = 0;
+        cur->resultinfo        = 0;
         cur->paramInfos        = 0;
         cur->inputsizes        = 0;
         cur->colinfos          = 0;
+        cur->colcount          = 0;
         cur->arraysize         = 1;
+        cur->rowsetsize        = 1;
+        cur->rowset_rows       = 0;
+        cur->rowset_fetched    = 0;
+        cur->rowset_pos        = 0;
+        cur->rowset_status     = 0;
+        cur->rowset_buffer     = 0;
+        cur->row_serial        = 0;
+        cur->result_serial     = 0;
+        cur->native_uuid       = false;
+        cur->lowercase         = false;
+        cur->uuid_type         = 0;
+        cur->decimal_mode      = DECIMAL_MODE_DECIMAL;
         cur->rowcount          = -1;
         cur->map_name_to_index = 0;
         cur->fastexecmany      = 0;
+        cur->fastexecmany_batch_rows  = 0;
+        cur->fastexecmany_batch_bytes = FAST_EXECUTEMANY_BATCH_BYTES;
+        cur->fastexecmany_max_inline  = FAST_EXECUTEMANY_MAX_INLINE;
+        cur->fastexecmany_continue    = 0;
         cur->messages          = Py_None;
+        cur->param_status      = 0;
+        cur->param_status_count = 0;
+        cur->param_messages    = Py_None;
 
         Py_INCREF(cnxn);
+        cur->prev_cursor = 0;
+        cur->next_cursor = cnxn->cursors;
+        if (cnxn->cursors)
+            cnxn->cursors->prev_cursor = cur;
+        cnxn->cursors = cur;
         Py_INCREF(cur->description);
         Py_INCREF(cur->messages);
+        Py_INCREF(cur->param_messages);
 
-        SQLRETURN ret;
-        Py_BEGIN_ALLOW_THREADS
-        ret = SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &cur->hstmt);
-        Py_END_ALLOW_THREADS
-
-        if (!SQL_SUCCEEDED(ret))
+        if (!AllocateStatement(cur))
         {
-            RaiseErrorFromHandle(cnxn, "SQLAllocHandle", cnxn->hdbc, SQL_NULL_HANDLE);
             Py_DECREF(cur);
             return 0;
         }
 
-        if (cnxn->timeout)
-        {
-            Py_BEGIN_ALLOW_THREADS
-            ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)(uintptr_t)cnxn->timeout, 0);
-            Py_END_ALLOW_THREADS
-
-            if (!SQL_SUCCEEDED(ret))
-            {
-                RaiseErrorFromHandle(cnxn, "SQLSetStmtAttr(SQL_ATTR_QUERY_TIMEOUT)", cnxn->hdbc, cur->hstmt);
-                Py_DECREF(cur);
-                return 0;
-            }
-        }
-
         TRACE("cursor.new cnxn=%p hdbc=%d cursor=%p hstmt=%d\n", (Connection*)cur->cnxn, ((Connection*)cur->cnxn)->hdbc, cur, cur->hstmt);
     }
 
     return cur;
 }
 
+bool AllocateStatement(Cursor* cur)
+{
+    Connection* cnxn = cur->cnxn;
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    SQLRETURN ret;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLAllocHandle(SQL_HANDLE_STMT, cnxn->hdbc, &cur->hstmt);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle(cnxn, "SQLAllocHandle", cnxn->hdbc, SQL_NULL_HANDLE);
+        return false;
+    }
+
+    if (cur->timeout)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)(uintptr_t)cur->timeout, 0);
+        Py_END_ALLOW_THREADS
+
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle(cnxn, "SQLSetStmtAttr(SQL_ATTR_QUERY_TIMEOUT)", cnxn->hdbc, cur->hstmt);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void Cursor_init()
 {
     PyDateTime_IMPORT;
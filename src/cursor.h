@@ -14,6 +14,10 @@
 #define CURSOR_H
 
 struct Connection;
+struct Cursor;
+
+// A function that reads the value of a column in the current row and returns it as a Python object.
+typedef PyObject* (*GetDataFunc)(Cursor* cur, Py_ssize_t iCol);
 
 struct ColumnInfo
 {
@@ -27,10 +31,66 @@ struct ColumnInfo
     // fields.
     SQLULEN column_size;
 
+    // The decimal digits (scale) from SQLDescribeCol for decimal, numeric, and timestamp types.
+    SQLSMALLINT decimal_digits;
+
     // Tells us if an integer type is signed or unsigned.  This is determined after a query using SQLColAttribute.  All
     // of the integer types are the same size whether signed and unsigned, so we can allocate memory ahead of time
     // without knowing this.  We use this during the fetch when converting to a Python integer or long.
     bool is_unsigned;
+
+    // When fetching rowsets (Cursor.rowsetsize > 1), the C type the column is bound to with SQLBindCol, or 0 if the
+    // column is read with SQLGetData.  bind_data points to an array of Cursor.rowset_rows values of bind_size bytes
+    // each and bind_ind to the matching length/indicator array.  Both point into Cursor.rowset_buffer.
+    SQLSMALLINT bind_ctype;
+    SQLLEN bind_size;
+    byte* bind_data;
+    SQLLEN* bind_ind;
+
+    // A buffer, allocated via PyMem_Malloc on first use, that ReadVarColumn reads text, binary, and decimal values
+    // into.  It is reused for every row and grows to the largest value read from the column.  Freed by free_results.
+    byte* scratch;
+    Py_ssize_t cbScratch;
+
+    // The function GetData uses to read the column.  This is chosen once per result set by ResolveGetData so the type
+    // switch and converter lookup are not repeated for every value.  If the connection has an output converter for the
+    // column's type, `converter` is a new reference to it, otherwise it is zero.
+    GetDataFunc getdata;
+    PyObject* converter;
+};
+
+struct ResultInfo
+{
+    // The columns of the first result set of a prepared statement, saved when the statement is executed so executing
+    // it again can skip describing them.  This is kept with the statement like Cursor.paramdescs.  Only the ColumnInfo
+    // fields that come from the driver are set: sql_type, column_size, decimal_digits, and is_unsigned.
+    int colcount;
+    ColumnInfo* colinfos;
+
+    // A hash of the parameter types the statement was executed with, since those can change the columns, as in
+    // "select ?".  See ParamSignature.
+    uint64_t paramsig;
+
+    // The description tuple and name map built for the result set, which are reused if the settings they depend on
+    // are unchanged.  These are zero if the connection had output converters or a metadata encoding without an
+    // optimized decoder, which are not worth checking for changes.
+    PyObject* description;
+    PyObject* map_name_to_index;
+    bool lowercase;
+    bool native_uuid;
+    int decimal_mode;
+    int metadata_optenc;
+};
+
+void FreeResultInfo(ResultInfo* info);
+
+struct ParamDesc
+{
+    // A parameter's description from SQLDescribeParam.  If the driver can't describe the parameter, this is a
+    // medium-length varchar, which converts to most other types.
+    SQLSMALLINT ParameterType;
+    SQLULEN     ColumnSize;
+    SQLSMALLINT DecimalDigits;
 };
 
 struct ParamInfo
@@ -64,6 +124,19 @@ struct ParamInfo
     // written to each SQLPutData call.  (It is not clear if they are limited
     // like SQLBindParameter or not.)
 
+    bool stream;
+    // True if pObject is a file-like object or an iterator whose data is read
+    // and sent with SQLPutData during the execute.  See PutStreamData.
+
+    PyObject* pChunk;
+    // For iterator streams, the first chunk, which was read to decide between
+    // a text or binary parameter.  Zero if none.
+
+    SQLLEN cbInline;
+    // Used by fast executemany for (max) parameters.  Values up to this many
+    // bytes are copied into the parameter array and longer values are sent
+    // with SQLPutData.  Zero to always use SQLPutData.
+
     // For TVPs, the nested descriptors and current row.
     struct ParamInfo *nested;
     SQLLEN curTvpRow;
@@ -88,9 +161,21 @@ struct Cursor
     // The Connection object (which is a PyObject) that created this cursor.
     Connection* cnxn;
 
+    // The connection's other open cursors, linked from Connection.cursors.
+    Cursor* next_cursor;
+    Cursor* prev_cursor;
+
     // Set to SQL_NULL_HANDLE when the cursor is closed.
     HSTMT hstmt;
 
+    // The SQL_ATTR_QUERY_TIMEOUT the cursor's statements are allocated with: the connection's timeout when the cursor
+    // was created.
+    long timeout;
+
+    // True if SQL_ATTR_NOSCAN is on.  Statements prepared without escape scanning are not given to the connection's
+    // statement cache.
+    bool noscan;
+
     //
     // SQL Parameters
     //
@@ -103,10 +188,15 @@ struct Cursor
     // immediately after preparing the SQL.
     int paramcount;
 
-    // If non-zero, a pointer to an array of SQL type values allocated via malloc.  This is zero until we actually ask
-    // for the type of parameter, which is only when a parameter is None (NULL).  At that point, the entire array is
-    // allocated (length == paramcount) but all entries are set to SQL_UNKNOWN_TYPE.
-    SQLSMALLINT* paramtypes;
+    // If non-zero, an array of paramcount parameter descriptions allocated via PyMem_Malloc.  This is zero until a
+    // parameter is first described, which is when a parameter is None (NULL) or by fast executemany.  Parameters not
+    // described yet have a ParameterType of SQL_UNKNOWN_TYPE.  The descriptions stay with the prepared statement,
+    // including while it is in the connection's statement cache, so each parameter is described once per statement.
+    ParamDesc* paramdescs;
+
+    // If non-zero, the saved columns of pPreparedSQL's first result set, allocated via PyMem_Malloc.  Freed with the
+    // parameter descriptions.
+    ResultInfo* resultinfo;
 
     // If non-zero, a pointer to a buffer containing the actual parameters bound.  If pPreparedSQL is zero, this should
     // be freed using free and set to zero.
@@ -120,6 +210,19 @@ struct Cursor
     
     // Whether to use fast executemany with parameter arrays and other optimisations
     char fastexecmany;
+
+    // The maximum number of rows and bytes of parameters fast executemany converts and executes
+    // at a time.  Zero or less means no limit.
+    Py_ssize_t fastexecmany_batch_rows;
+    Py_ssize_t fastexecmany_batch_bytes;
+
+    // The largest (max) parameter value, in bytes, fast executemany binds inline instead of
+    // using SQLPutData.  Zero or less to always use SQLPutData.
+    Py_ssize_t fastexecmany_max_inline;
+
+    // If true, fast executemany keeps going when rows fail instead of raising an error.  The
+    // failed rows are reported in param_status and param_messages.
+    char fastexecmany_continue;
     
     // The list of information for setinputsizes().
     PyObject *inputsizes;
@@ -132,11 +235,54 @@ struct Cursor
     // results.
     ColumnInfo* colinfos;
 
+    // The number of entries in colinfos.
+    int colcount;
+
     // The description tuple described in the DB API 2.0 specification.  Set to None when there are no results.
     PyObject* description;
 
     int arraysize;
 
+    // The number of rows to fetch from the driver at a time using column-wise bound buffers.  The default of 1 reads
+    // each value with SQLGetData.  This is read when the result set is prepared, so changes take effect on the next
+    // execute.
+    int rowsetsize;
+
+    // The number of rows the columns in the current result set are bound for, or 0 if no columns are bound.  This is
+    // rowsetsize when every column could be bound.  If any column must be read with SQLGetData (e.g. LOBs), only the
+    // columns before it are bound and this is 1 since SQLGetData cannot be used with multi-row rowsets.
+    SQLULEN rowset_rows;
+
+    // The number of rows in the rowset most recently fetched (set by the driver through SQL_ATTR_ROWS_FETCHED_PTR)
+    // and the index of the next one to return.
+    SQLULEN rowset_fetched;
+    SQLULEN rowset_pos;
+
+    // The row status array (SQL_ATTR_ROW_STATUS_PTR) for the current rowset.  Points into rowset_buffer.
+    SQLUSMALLINT* rowset_status;
+
+    // A single allocation, via PyMem_Malloc, holding the bound column buffers and row status array.  Zero when no
+    // columns are bound.
+    byte* rowset_buffer;
+
+    // Incremented whenever the cursor moves to another row or result set so objects reading the current row with
+    // SQLGetData (see BlobReader) can tell when it is gone.
+    unsigned long row_serial;
+
+    // Incremented whenever the cursor's result set is freed, by an execute, nextset, or close.  A prepared statement's
+    // result sets can share a description (see ResultInfo), so this is what tells them apart.
+    unsigned long result_serial;
+
+    // Module settings captured by PrepareResults so they are not looked up for every value.  Changes to the module
+    // attributes take effect for the next result set.
+    //
+    // uuid_type is uuid.UUID for the current interpreter when native_uuid is true and there is a GUID column, otherwise
+    // zero.  decimal_mode is the connection's decimal_mode.
+    bool native_uuid;
+    bool lowercase;
+    PyObject* uuid_type;
+    int decimal_mode;
+
     // The Cursor.rowcount attribute from the DB API specification.
     int rowcount;
 
@@ -147,20 +293,41 @@ struct Cursor
     // This duplicates some ODBC functionality, but allows us to use Row objects after the statement is closed and
     // should use less memory than putting each column into the Row's __dict__.
     //
-    // Since this is shared by Row objects, it cannot be reused.  New dictionaries are created for every execute.  This
-    // will be zero whenever there are no results.
+    // This is shared by Row objects, which only read it, and is reused when a prepared statement is executed again
+    // (see ResultInfo).  This will be zero whenever there are no results.
     PyObject* map_name_to_index;
 
     // The messages attribute described in the DB API 2.0 specification.
     // Contains a list of all non-data messages provided by the driver, retrieved using SQLGetDiagRec.
     PyObject* messages;
+
+    // The status of each row of parameters in the last fast executemany, one SQL_PARAM_ value
+    // per row from SQL_ATTR_PARAM_STATUS_PTR.  Allocated via PyMem_Malloc.  Zero if there was
+    // none.
+    SQLUSMALLINT* param_status;
+    Py_ssize_t param_status_count;
+
+    // The diagnostic records of the last fast executemany as (row, class, message) tuples.  The
+    // row is the index of the row of parameters the record is for, or None if the driver did
+    // not say.
+    PyObject* param_messages;
 };
 
 int GetDiagRecs(Cursor* cur);
+PyObject* GetDiagRec(Cursor* cur, SQLSMALLINT iRecNumber);
 
 void Cursor_init();
 
 Cursor* Cursor_New(Connection* cnxn);
+
+// Allocates a new HSTMT for the cursor, which must not have one, with the cursor's timeout.
+bool AllocateStatement(Cursor* cur);
+
+// Closes all of the connection's open cursors, freeing their statements.  Returns false if a statement could not be
+// freed, in which case an exception is set, but the cursors are closed either way.
+bool CloseCursors(Connection* cnxn);
+
 PyObject* Cursor_execute(PyObject* self, PyObject* args);
+bool Cursor_NextRow(Cursor* cur, SQLULEN& iRow);
 
 #endif
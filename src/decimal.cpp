@@ -2,6 +2,9 @@
 #include "pyodbc.h"
 #include "wrapper.h"
 #include "textenc.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "errors.h"
 #include "decimal.h"
 
 static PyObject* decimal = 0;
@@ -30,6 +33,10 @@ static PyObject* pLocaleDecimalEscaped = 0;
 static PyObject* pRegExpRemove = 0;
 // A regular expression that matches characters we want to remove before parsing.
 
+static Py_UCS4 chLocaleDecimal = '.';
+// pLocaleDecimal as a character for FilterNumericText.  Zero if it is not a single
+// character, in which case the regular expressions are always used.
+
 
 bool InitializeDecimal() {
     // This is called when the module is initialized and creates globals.
@@ -66,6 +73,11 @@ PyObject* GetDecimalPoint() {
     return pLocaleDecimal;
 }
 
+Py_UCS4 GetDecimalChar() {
+    // Returns the decimal point as a character, or zero if it is not a single character.
+    return chLocaleDecimal;
+}
+
 bool SetDecimalPoint(PyObject* pNew)
 {
     if (PyObject_RichCompareBool(pNew, pDecimalPoint, Py_EQ) == 1)
@@ -106,6 +118,132 @@ bool SetDecimalPoint(PyObject* pNew)
     Py_XDECREF(pRegExpRemove);
     pRegExpRemove = r.Detach();
 
+    chLocaleDecimal = (PyUnicode_GET_LENGTH(pLocaleDecimal) == 1) ? PyUnicode_READ_CHAR(pLocaleDecimal, 0) : 0;
+
+    return true;
+}
+
+
+struct NumericText
+{
+    // The ASCII characters of a number after FilterNumericText removes everything but digits,
+    // '-', and '.'.  Numeric columns are at most a few dozen characters, so this rarely
+    // allocates.
+
+    char szStack[64];
+    char* sz;
+    Py_ssize_t cch;
+
+    NumericText() : sz(szStack), cch(0) { }
+    ~NumericText()
+    {
+        if (sz != szStack)
+            PyMem_Free(sz);
+    }
+
+    bool Reserve(Py_ssize_t cchNeeded)
+    {
+        if (cchNeeded <= (Py_ssize_t)sizeof(szStack))
+            return true;
+        sz = (char*)PyMem_Malloc((size_t)cchNeeded);
+        if (!sz)
+        {
+            sz = szStack;
+            PyErr_NoMemory();
+            return false;
+        }
+        return true;
+    }
+};
+
+
+static bool FilterNumericText(const TextEnc& enc, const byte* pb, Py_ssize_t cb, NumericText& text, bool& handled)
+{
+    // Filters a text buffer the same way as the regular expressions do - digits and '-' are
+    // kept, the locale's decimal point is replaced with '.', and everything else is dropped -
+    // for the encodings drivers actually use for numbers: UTF-16 and ASCII-compatible single
+    // byte encodings.
+    //
+    // Sets `handled` to false if the encoding isn't supported so the caller can use the
+    // regular expressions.  Returns false if memory could not be allocated.
+
+    handled = false;
+
+    if (chLocaleDecimal == 0)
+        return true;
+
+    int cbChar;
+    bool bigEndian = false;
+
+    switch (enc.optenc)
+    {
+    case OPTENC_UTF8:
+        // Multi-byte sequences never contain ASCII bytes, so they can be skipped a byte at a
+        // time unless the decimal point itself is multi-byte.
+        if (chLocaleDecimal >= 0x80)
+            return true;
+        cbChar = 1;
+        break;
+
+    case OPTENC_LATIN1:
+        if (chLocaleDecimal > 0xFF)
+            return true;
+        cbChar = 1;
+        break;
+
+    case OPTENC_UTF16LE:
+        cbChar = 2;
+        break;
+
+    case OPTENC_UTF16BE:
+        cbChar = 2;
+        bigEndian = true;
+        break;
+
+    case OPTENC_UTF16:
+        // Native byte order unless there is a BOM, like TextBufferToObject.
+        cbChar = 2;
+        bigEndian = (OPTENC_UTF16NE == OPTENC_UTF16BE);
+        if (cb >= 2 && ((pb[0] == 0xFF && pb[1] == 0xFE) || (pb[0] == 0xFE && pb[1] == 0xFF)))
+        {
+            bigEndian = (pb[0] == 0xFE);
+            pb += 2;
+            cb -= 2;
+        }
+        break;
+
+    default:
+        return true;
+    }
+
+    if (cb % cbChar)
+        return true;
+
+    handled = true;
+
+    Py_ssize_t cch = cb / cbChar;
+    if (!text.Reserve(cch))
+        return false;
+
+    char* sz = text.sz;
+    Py_ssize_t cchOut = 0;
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        Py_UCS4 ch;
+        if (cbChar == 1)
+            ch = pb[i];
+        else if (bigEndian)
+            ch = (Py_UCS4)((pb[i*2] << 8) | pb[i*2+1]);
+        else
+            ch = (Py_UCS4)((pb[i*2+1] << 8) | pb[i*2]);
+
+        if ((ch >= '0' && ch <= '9') || ch == '-')
+            sz[cchOut++] = (char)ch;
+        else if (ch == chLocaleDecimal)
+            sz[cchOut++] = '.';
+    }
+    text.cch = cchOut;
+
     return true;
 }
 
@@ -121,6 +259,19 @@ PyObject* DecimalFromText(const TextEnc& enc, const byte* pb, Py_ssize_t cb)
     // Remember that the thousands separate will often be '.', so have to do this carefully.
     // We'll create a regular expression with 0-9 and whatever the thousands separator is.
 
+    NumericText filtered;
+    bool handled;
+    if (!FilterNumericText(enc, pb, cb, filtered, handled))
+        return 0;
+
+    if (handled)
+    {
+        Object s(PyUnicode_FromStringAndSize(filtered.sz, filtered.cch));
+        if (!s)
+            return 0;
+        return PyObject_CallFunctionObjArgs(decimal, s.Get(), 0);
+    }
+
     Object text(TextBufferToObject(enc, pb, cb));
     if (!text)
         return 0;
@@ -131,7 +282,7 @@ PyObject* DecimalFromText(const TextEnc& enc, const byte* pb, Py_ssize_t cb)
 
     if (pLocaleDecimalEscaped)
     {
-        Object c2(PyObject_CallFunctionObjArgs(re_sub, pLocaleDecimalEscaped, pDecimalPoint, 0));
+        Object c2(PyObject_CallFunctionObjArgs(re_sub, pLocaleDecimalEscaped, pDecimalPoint, cleaned.Get(), 0));
         if (!c2)
             return 0;
         cleaned.Attach(c2.Detach());
@@ -139,3 +290,85 @@ PyObject* DecimalFromText(const TextEnc& enc, const byte* pb, Py_ssize_t cb)
 
     return PyObject_CallFunctionObjArgs(decimal, cleaned.Get(), 0);
 }
+
+
+PyObject* ScaledIntFromText(const TextEnc& enc, const byte* pb, Py_ssize_t cb, int scale)
+{
+    // Creates an int holding the value of a decimal text buffer multiplied by 10**scale.  For
+    // example, "-12.3" with a scale of 2 is -1230.  This is used for columns read with
+    // decimal_mode "int", where scale is the column's decimal digits.
+    //
+    // Raises DataError if the value has more than `scale` significant fractional digits, the
+    // same as the Arrow fetch.
+
+    if (scale < 0)
+        scale = 0;
+
+    NumericText filtered;
+    bool handled;
+    if (!FilterNumericText(enc, pb, cb, filtered, handled))
+        return 0;
+
+    if (!handled)
+    {
+        // Let the Decimal handle unusual encodings and formatting it with "f" gives us plain
+        // ASCII digits with a '.' decimal point.
+        Object value(DecimalFromText(enc, pb, cb));
+        if (!value)
+            return 0;
+        Object s(PyObject_CallMethod(value, "__format__", "s", "f"));
+        if (!s)
+            return 0;
+        Py_ssize_t cch;
+        const char* sz = PyUnicode_AsUTF8AndSize(s, &cch);
+        if (!sz || !filtered.Reserve(cch))
+            return 0;
+        memcpy(filtered.sz, sz, (size_t)cch);
+        filtered.cch = cch;
+    }
+
+    // Build "[-]digits" with exactly `scale` fractional digits.
+
+    NumericText result;
+    if (!result.Reserve(filtered.cch + scale + 2))
+        return 0;
+
+    char* pch = result.sz;
+    Py_ssize_t cchFraction = -1;    // -1 until the decimal point is seen
+
+    for (Py_ssize_t i = 0; i < filtered.cch; i++)
+    {
+        char ch = filtered.sz[i];
+        if (ch == '-')
+        {
+            if (pch == result.sz)
+                *pch++ = '-';
+        }
+        else if (ch == '.')
+        {
+            if (cchFraction == -1)
+                cchFraction = 0;
+        }
+        else if (cchFraction < scale)
+        {
+            *pch++ = ch;
+            if (cchFraction != -1)
+                cchFraction++;
+        }
+        else if (ch != '0')
+        {
+            RaiseErrorV(0, DataError, "The decimal value has more digits than the column's scale of %d.", scale);
+            return 0;
+        }
+    }
+
+    for (Py_ssize_t i = max(cchFraction, (Py_ssize_t)0); i < scale; i++)
+        *pch++ = '0';
+
+    if (pch == result.sz || (pch == result.sz + 1 && result.sz[0] == '-'))
+        *pch++ = '0';
+
+    *pch = 0;
+
+    return PyLong_FromString(result.sz, 0, 10);
+}
@@ -2,6 +2,8 @@
 
 bool InitializeDecimal();
 PyObject* GetDecimalPoint();
+Py_UCS4 GetDecimalChar();
 bool SetDecimalPoint(PyObject* pNew);
 
 PyObject* DecimalFromText(const TextEnc& enc, const byte* pb, Py_ssize_t cb);
+PyObject* ScaledIntFromText(const TextEnc& enc, const byte* pb, Py_ssize_t cb, int scale);
@@ -347,3 +347,37 @@ bool HasSqlState(HSTMT hstmt, const char* szSqlState)
         return false;
     return memcmp(szActual, szSqlState, 5) == 0;
 }
+
+
+bool IsSchemaChangeError(HSTMT hstmt)
+{
+    static const char* const schema_states[] =
+    {
+        "07002",                // COUNT field incorrect (the number of parameters changed)
+        "07009",                // Invalid descriptor index
+        "21S01",                // Insert value list does not match column list
+        "42S02",                // Base table or view not found
+        "42S22",                // Column not found
+    };
+
+    for (SQLSMALLINT iRecord = 1; ; iRecord++)
+    {
+        uint16_t sqlstateT[6] = { 0 };
+        char sqlstate[6] = "";
+        SQLINTEGER nNativeError;
+        SQLSMALLINT cchMsg;
+
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLGetDiagRecW(SQL_HANDLE_STMT, hstmt, iRecord, (SQLWCHAR*)sqlstateT, &nNativeError, 0, 0, &cchMsg);
+        Py_END_ALLOW_THREADS
+        if (!SQL_SUCCEEDED(ret))
+            return false;
+
+        CopySqlState(sqlstateT, sqlstate);
+
+        for (size_t i = 0; i < _countof(schema_states); i++)
+            if (memcmp(sqlstate, schema_states[i], 5) == 0)
+                return true;
+    }
+}
@@ -55,6 +55,13 @@ bool HasSqlState(PyObject* ex, const char* szSqlState);
 //
 bool HasSqlState(HSTMT hstmt, const char* szSqlState);
 
+
+// Returns true if the HSTMT has a diagnostic record with a SQLSTATE indicating that the prepared statement no longer
+// matches the tables it uses, such as a column that was dropped or resized.  The statement should be prepared and its
+// parameters described again.
+//
+bool IsSchemaChangeError(HSTMT hstmt);
+
 inline PyObject* RaiseErrorFromException(PyObject* pError)
 {
     // PyExceptionInstance_Class doesn't exist in 2.4
@@ -37,7 +37,7 @@ void GetData_init()
     PyDateTime_IMPORT;
 }
 
-static byte* ReallocOrFreeBuffer(byte* pb, Py_ssize_t cbNeed);
+static PyObject* TimestampToObject(SQLSMALLINT sql_type, TIMESTAMP_STRUCT& value);
 PyObject *GetData_SqlVariant(Cursor *cur, Py_ssize_t iCol);
 
 inline bool IsBinaryType(SQLSMALLINT sqltype)
@@ -68,17 +68,44 @@ inline bool IsWideType(SQLSMALLINT sqltype)
 }
 
 
+static bool AllocScratch(ColumnInfo* pinfo, Py_ssize_t cbElement)
+{
+    // Allocates the column's scratch buffer if it hasn't been allocated yet.
+
+    if (pinfo->scratch != 0)
+        return true;
+
+    // Size the buffer to hold the column's maximum length (plus room for the null terminator
+    // and any sign, decimal point, and separators a driver adds to decimals).  If the size is
+    // unknown or large, start with 4K and grow as needed.
+    Py_ssize_t cbInitial = 4096;
+    if (pinfo->column_size != 0 && pinfo->column_size <= 64 * 1024)
+        cbInitial = ((Py_ssize_t)pinfo->column_size + 8) * cbElement;
+
+    pinfo->scratch = (byte*)PyMem_Malloc((size_t)cbInitial);
+    if (!pinfo->scratch)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+    pinfo->cbScratch = cbInitial;
+    return true;
+}
+
+
 static bool ReadVarColumn(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, bool& isNull, byte*& pbResult, Py_ssize_t& cbResult)
 {
-    // Called to read a variable-length column and return its data in a newly-allocated heap
+    // Called to read a variable-length column and return its data in the column's scratch
     // buffer.
     //
     // Returns true if the read was successful and false if the read failed.  If the read
     // failed a Python exception will have been set.
     //
-    // If a non-null and non-empty value was read, pbResult will be set to a buffer containing
-    // the data and cbResult will be set to the byte length.  This length does *not* include a
-    // null terminator.  In this case the data *must* be freed using PyMem_Free.
+    // If a non-null and non-empty value was read, pbResult will be set to the column's scratch
+    // buffer and cbResult will be set to the byte length.  This length does *not* include a
+    // null terminator.  The buffer is owned by the column (see ColumnInfo.scratch) and is only
+    // valid until the next read of the same column, so the data must be converted or copied
+    // before then.  It must *not* be freed.
     //
     // If a null value was read, isNull is set to true and pbResult and cbResult will be set to
     // 0.
@@ -90,28 +117,25 @@ static bool ReadVarColumn(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, bool&
     pbResult = 0;
     cbResult = 0;
 
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
     const Py_ssize_t cbElement = (Py_ssize_t)(IsWideType(ctype) ? sizeof(uint16_t) : 1);
     const Py_ssize_t cbNullTerminator = IsBinaryType(ctype) ? 0 : cbElement;
 
-    // TODO: Make the initial allocation size configurable?
-    Py_ssize_t cbAllocated = 4096;
-    Py_ssize_t cbUsed = 0;
-    byte* pb = (byte*)PyMem_Malloc((size_t)cbAllocated);
-    if (!pb)
-    {
-        PyErr_NoMemory();
+    if (!AllocScratch(pinfo, cbElement))
         return false;
-    }
+
+    Py_ssize_t cbUsed = 0;
 
     SQLRETURN ret = SQL_SUCCESS_WITH_INFO;
 
     do
     {
         // Call SQLGetData in a loop as long as it keeps returning partial data (ret ==
-        // SQL_SUCCESS_WITH_INFO).  Each time through, update the buffer pb, cbAllocated, and
-        // cbUsed.
+        // SQL_SUCCESS_WITH_INFO).  Each time through, update the scratch buffer and cbUsed.
 
-        Py_ssize_t cbAvailable = cbAllocated - cbUsed;
+        byte* pb = pinfo->scratch;
+        Py_ssize_t cbAvailable = pinfo->cbScratch - cbUsed;
         SQLLEN cbData = 0;
 
         Py_BEGIN_ALLOW_THREADS
@@ -151,13 +175,13 @@ static bool ReadVarColumn(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, bool&
             if (cbData == SQL_NO_TOTAL)
             {
                 // This special value indicates there is more data but the driver can't tell us
-                // how much more, so we'll just add whatever we want and try again.  It also
-                // tells us, however, that the buffer is full, so the amount we read equals the
-                // amount we offered.  Remember that if the type requires a null terminator, it
-                // will be added *every* time, not just at the end, so we need to subtract it.
+                // how much more, so we'll double the buffer and try again.  It also tells us,
+                // however, that the buffer is full, so the amount we read equals the amount we
+                // offered.  Remember that if the type requires a null terminator, it will be
+                // added *every* time, not just at the end, so we need to subtract it.
 
                 cbRead = (cbAvailable - cbNullTerminator);
-                cbRemaining = 1024 * 1024;
+                cbRemaining = pinfo->cbScratch;
             }
             else if ((Py_ssize_t)cbData >= cbAvailable)
             {
@@ -185,13 +209,20 @@ static bool ReadVarColumn(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, bool&
             if (cbRemaining > 0)
             {
                 // This is a tiny bit complicated by the fact that the data is null terminated,
-                // meaning we haven't actually used up the entire buffer (cbAllocated), only
-                // cbUsed (which should be cbAllocated - cbNullTerminator).
+                // meaning we haven't actually used up the entire buffer (cbScratch), only
+                // cbUsed (which should be cbScratch - cbNullTerminator).
+                //
+                // If the realloc fails, the original buffer is still owned by the column and
+                // will be freed by free_results.
                 Py_ssize_t cbNeed = cbUsed + cbRemaining + cbNullTerminator;
-                pb = ReallocOrFreeBuffer(pb, cbNeed);
-                if (!pb)
+                byte* pbNew = (byte*)PyMem_Realloc(pinfo->scratch, (size_t)cbNeed);
+                if (!pbNew)
+                {
+                    PyErr_NoMemory();
                     return false;
-                cbAllocated = cbNeed;
+                }
+                pinfo->scratch = pbNew;
+                pinfo->cbScratch = cbNeed;
             }
         }
         else if (ret == SQL_SUCCESS)
@@ -211,33 +242,13 @@ static bool ReadVarColumn(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT ctype, bool&
 
     if (!isNull && cbUsed > 0)
     {
-        pbResult = pb;
+        pbResult = pinfo->scratch;
         cbResult = cbUsed;
     }
-    else
-    {
-        PyMem_Free(pb);
-    }
 
     return true;
 }
 
-static byte* ReallocOrFreeBuffer(byte* pb, Py_ssize_t cbNeed)
-{
-    // Attempts to reallocate `pb` to size `cbNeed`.  If the realloc fails, the original memory
-    // is freed, a memory exception is set, and 0 is returned.  Otherwise the new pointer is
-    // returned.
-
-    byte* pbNew = (byte*)PyMem_Realloc(pb, (size_t)cbNeed);
-    if (pbNew == 0)
-    {
-        PyMem_Free(pb);
-        PyErr_NoMemory();
-        return 0;
-    }
-    return pbNew;
-}
-
 
 static PyObject* GetText(Cursor* cur, Py_ssize_t iCol)
 {
@@ -267,57 +278,120 @@ static PyObject* GetText(Cursor* cur, Py_ssize_t iCol)
         Py_RETURN_NONE;
     }
 
-    PyObject* result = TextBufferToObject(enc, pbData, cbData);
-
-    PyMem_Free(pbData);
-
-    return result;
+    return TextBufferToObject(enc, pbData, cbData);
 }
 
 
 
-static PyObject* GetBinary(Cursor* cur, Py_ssize_t iCol)
+static PyObject* ReadBinaryColumn(Cursor* cur, Py_ssize_t iCol)
 {
-    // Reads SQL_BINARY.
+    // Reads a column as SQL_C_BINARY and returns a bytes object, or None if it is NULL.
+    //
+    // Values that fit in the column's scratch buffer are copied from it.  For longer values a
+    // bytes object is allocated once the first SQLGetData call reports the total length and
+    // the rest is read directly into it, so large values are not copied again.  If the driver
+    // doesn't know the length, the bytes object is doubled as needed and shrunk at the end.
 
-    bool isNull = false;
-    byte* pbData = 0;
-    Py_ssize_t cbData = 0;
-    if (!ReadVarColumn(cur, iCol, SQL_C_BINARY, isNull, pbData, cbData))
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    if (!AllocScratch(pinfo, 1))
         return 0;
 
-    if (isNull)
-    {
-        assert(pbData == 0 && cbData == 0);
+    SQLLEN cbData = 0;
+    SQLRETURN ret;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_BINARY, pinfo->scratch, (SQLLEN)pinfo->cbScratch, &cbData);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret) && ret != SQL_NO_DATA)
+        return RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+
+    if (ret == SQL_NO_DATA)
+        return PyBytes_FromStringAndSize("", 0);
+
+    // See ReadVarColumn for the FreeTDS negative length hack.
+    if (cbData == SQL_NULL_DATA || (ret == SQL_SUCCESS && (int)cbData < 0))
         Py_RETURN_NONE;
-    }
 
-    PyObject* obj;
-    obj = PyBytes_FromStringAndSize((char*)pbData, cbData);
-    PyMem_Free(pbData);
-    return obj;
-}
+    if (ret == SQL_SUCCESS)
+        return PyBytes_FromStringAndSize((char*)pinfo->scratch, (Py_ssize_t)cbData);
 
+    // The scratch buffer was filled and there is more.  cbData is the total length, including
+    // what was just read, unless the driver doesn't know it.  A driver could also return a
+    // warning for a value that fit, so don't assume the buffer is full if the length is known.
 
-static PyObject* GetDataUser(Cursor* cur, Py_ssize_t iCol, PyObject* func)
-{
-    bool isNull = false;
-    byte* pbData = 0;
-    Py_ssize_t cbData = 0;
-    if (!ReadVarColumn(cur, iCol, SQL_C_BINARY, isNull, pbData, cbData))
+    Py_ssize_t cbUsed = (cbData != SQL_NO_TOTAL) ? min((Py_ssize_t)cbData, pinfo->cbScratch) : pinfo->cbScratch;
+    Py_ssize_t cbTotal = (cbData != SQL_NO_TOTAL && (Py_ssize_t)cbData > pinfo->cbScratch) ? (Py_ssize_t)cbData : pinfo->cbScratch * 2;
+
+    PyObject* result = PyBytes_FromStringAndSize(0, cbTotal);
+    if (!result)
         return 0;
+    memcpy(PyBytes_AS_STRING(result), pinfo->scratch, (size_t)cbUsed);
 
-    if (isNull)
+    while (ret == SQL_SUCCESS_WITH_INFO)
     {
-        assert(pbData == 0 && cbData == 0);
-        Py_RETURN_NONE;
+        if (cbUsed == cbTotal)
+        {
+            cbTotal *= 2;
+            if (_PyBytes_Resize(&result, cbTotal) != 0)
+                return 0;
+        }
+
+        Py_ssize_t cbAvailable = cbTotal - cbUsed;
+        char* pb = PyBytes_AS_STRING(result) + cbUsed;
+
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_BINARY, pb, (SQLLEN)cbAvailable, &cbData);
+        Py_END_ALLOW_THREADS
+
+        if (!SQL_SUCCEEDED(ret) && ret != SQL_NO_DATA)
+        {
+            Py_DECREF(result);
+            return RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+        }
+
+        if (ret == SQL_SUCCESS_WITH_INFO)
+        {
+            cbUsed += (cbData != SQL_NO_TOTAL) ? min((Py_ssize_t)cbData, cbAvailable) : cbAvailable;
+            if (cbData != SQL_NO_TOTAL && (Py_ssize_t)cbData > cbAvailable)
+            {
+                // The driver now knows the length, so make room for exactly the rest.
+                cbTotal = cbUsed + ((Py_ssize_t)cbData - cbAvailable);
+                if (_PyBytes_Resize(&result, cbTotal) != 0)
+                    return 0;
+            }
+        }
+        else if (ret == SQL_SUCCESS)
+        {
+            cbUsed += (Py_ssize_t)cbData;
+        }
     }
 
-    PyObject* value = PyBytes_FromStringAndSize((char*)pbData, cbData);
-    PyMem_Free(pbData);
+    if (cbUsed != cbTotal && _PyBytes_Resize(&result, cbUsed) != 0)
+        return 0;
+
+    return result;
+}
+
+
+static PyObject* GetBinary(Cursor* cur, Py_ssize_t iCol)
+{
+    // Reads SQL_BINARY.
+
+    return ReadBinaryColumn(cur, iCol);
+}
+
+
+static PyObject* GetDataUser(Cursor* cur, Py_ssize_t iCol, PyObject* func)
+{
+    PyObject* value = ReadBinaryColumn(cur, iCol);
     if (!value)
         return 0;
 
+    if (value == Py_None)
+        return value;
+
     PyObject* result = PyObject_CallFunction(func, "(O)", value);
     Py_DECREF(value);
     if (!result)
@@ -364,11 +438,53 @@ static PyObject* GetDataDecimal(Cursor* cur, Py_ssize_t iCol)
         Py_RETURN_NONE;
     }
 
-    Object result(DecimalFromText(enc, pbData, cbData));
+    return DecimalFromText(enc, pbData, cbData);
+}
 
-    PyMem_Free(pbData);
 
-    return result.Detach();
+static PyObject* GetDataDecimalText(Cursor* cur, Py_ssize_t iCol)
+{
+    // Reads a decimal or numeric column for decimal_mode "str", returning the driver's text
+    // without parsing it.
+
+    const TextEnc& enc = cur->cnxn->sqlwchar_enc;
+
+    bool isNull = false;
+    byte* pbData = 0;
+    Py_ssize_t cbData = 0;
+    if (!ReadVarColumn(cur, iCol, enc.ctype, isNull, pbData, cbData))
+        return 0;
+
+    if (isNull)
+    {
+        assert(pbData == 0 && cbData == 0);
+        Py_RETURN_NONE;
+    }
+
+    return TextBufferToObject(enc, pbData, cbData);
+}
+
+
+static PyObject* GetDataDecimalInt(Cursor* cur, Py_ssize_t iCol)
+{
+    // Reads a decimal or numeric column for decimal_mode "int", returning the value multiplied
+    // by 10**scale where scale is the column's decimal digits.
+
+    const TextEnc& enc = cur->cnxn->sqlwchar_enc;
+
+    bool isNull = false;
+    byte* pbData = 0;
+    Py_ssize_t cbData = 0;
+    if (!ReadVarColumn(cur, iCol, enc.ctype, isNull, pbData, cbData))
+        return 0;
+
+    if (isNull)
+    {
+        assert(pbData == 0 && cbData == 0);
+        Py_RETURN_NONE;
+    }
+
+    return ScaledIntFromText(enc, pbData, cbData, cur->colinfos[iCol].decimal_digits);
 }
 
 static PyObject* GetDataBit(Cursor* cur, Py_ssize_t iCol)
@@ -396,16 +512,12 @@ static PyObject* GetDataBit(Cursor* cur, Py_ssize_t iCol)
 
 static PyObject* GetDataLong(Cursor* cur, Py_ssize_t iCol)
 {
-    ColumnInfo* pinfo = &cur->colinfos[iCol];
-
     SQLINTEGER value;
     SQLLEN cbFetched;
     SQLRETURN ret;
 
-    SQLSMALLINT nCType = pinfo->is_unsigned ? SQL_C_ULONG : SQL_C_LONG;
-
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), nCType, &value, sizeof(value), &cbFetched);
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_LONG, &value, sizeof(value), &cbFetched);
     Py_END_ALLOW_THREADS
     if (!SQL_SUCCEEDED(ret))
         return RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
@@ -413,24 +525,37 @@ static PyObject* GetDataLong(Cursor* cur, Py_ssize_t iCol)
     if (cbFetched == SQL_NULL_DATA)
         Py_RETURN_NONE;
 
-    if (pinfo->is_unsigned)
-        return PyLong_FromLong(*(SQLINTEGER*)&value);
-
     return PyLong_FromLong(value);
 }
 
 
-static PyObject* GetDataLongLong(Cursor* cur, Py_ssize_t iCol)
+static PyObject* GetDataULong(Cursor* cur, Py_ssize_t iCol)
 {
-    ColumnInfo* pinfo = &cur->colinfos[iCol];
+    SQLUINTEGER value;
+    SQLLEN cbFetched;
+    SQLRETURN ret;
 
-    SQLSMALLINT nCType = pinfo->is_unsigned ? SQL_C_UBIGINT : SQL_C_SBIGINT;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_ULONG, &value, sizeof(value), &cbFetched);
+    Py_END_ALLOW_THREADS
+    if (!SQL_SUCCEEDED(ret))
+        return RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+
+    if (cbFetched == SQL_NULL_DATA)
+        Py_RETURN_NONE;
+
+    return PyLong_FromUnsignedLong(value);
+}
+
+
+static PyObject* GetDataLongLong(Cursor* cur, Py_ssize_t iCol)
+{
     SQLBIGINT   value;
     SQLLEN      cbFetched;
     SQLRETURN   ret;
 
     Py_BEGIN_ALLOW_THREADS
-    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), nCType, &value, sizeof(value), &cbFetched);
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_SBIGINT, &value, sizeof(value), &cbFetched);
     Py_END_ALLOW_THREADS
 
     if (!SQL_SUCCEEDED(ret))
@@ -439,13 +564,30 @@ static PyObject* GetDataLongLong(Cursor* cur, Py_ssize_t iCol)
     if (cbFetched == SQL_NULL_DATA)
         Py_RETURN_NONE;
 
-    if (pinfo->is_unsigned)
-        return PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)(SQLUBIGINT)value);
-
     return PyLong_FromLongLong((PY_LONG_LONG)value);
 }
 
 
+static PyObject* GetDataULongLong(Cursor* cur, Py_ssize_t iCol)
+{
+    SQLUBIGINT  value;
+    SQLLEN      cbFetched;
+    SQLRETURN   ret;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_UBIGINT, &value, sizeof(value), &cbFetched);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret))
+        return RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+
+    if (cbFetched == SQL_NULL_DATA)
+        Py_RETURN_NONE;
+
+    return PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)value);
+}
+
+
 static PyObject* GetDataDouble(Cursor* cur, Py_ssize_t iCol)
 {
     double value;
@@ -485,6 +627,24 @@ static PyObject* GetSqlServerTime(Cursor* cur, Py_ssize_t iCol)
     return PyTime_FromTime(value.hour, value.minute, value.second, micros);
 }
 
+static PyObject* UUIDFromGuid(Cursor* cur, const PYSQLGUID& guid)
+{
+    // Creates a uuid.UUID using the class captured when the result set was prepared.  The GUID
+    // is passed as the bytes_le argument: UUID(None, None, bytes_le).
+
+    assert(cur->uuid_type);
+
+    Object bytes(PyBytes_FromStringAndSize((const char*)&guid, (Py_ssize_t)sizeof(guid)));
+    if (!bytes)
+        return 0;
+
+    Object args(PyTuple_Pack(3, Py_None, Py_None, bytes.Get()));
+    if (!args)
+        return 0;
+
+    return PyObject_Call(cur->uuid_type, args.Get(), 0);
+}
+
 static PyObject* GetUUID(Cursor* cur, Py_ssize_t iCol)
 {
     // REVIEW: Since GUID is a fixed size, do we need to pass the size or cbFetched?
@@ -502,17 +662,7 @@ static PyObject* GetUUID(Cursor* cur, Py_ssize_t iCol)
     if (cbFetched == SQL_NULL_DATA)
         Py_RETURN_NONE;
 
-    const char* szFmt = "(yyy#)";
-    Object args(Py_BuildValue(szFmt, NULL, NULL, &guid, (int)sizeof(guid)));
-    if (!args)
-        return 0;
-
-    PyObject* uuid_type = GetClassForThread("uuid", "UUID");
-    if (!uuid_type)
-        return 0;
-    PyObject* uuid = PyObject_CallObject(uuid_type, args.Get());
-    Py_DECREF(uuid_type);
-    return uuid;
+    return UUIDFromGuid(cur, guid);
 }
 
 static PyObject* GetDataTimestamp(Cursor* cur, Py_ssize_t iCol)
@@ -522,8 +672,6 @@ static PyObject* GetDataTimestamp(Cursor* cur, Py_ssize_t iCol)
     SQLLEN cbFetched = 0;
     SQLRETURN ret;
 
-    struct tm t;
-
     Py_BEGIN_ALLOW_THREADS
     ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), SQL_C_TYPE_TIMESTAMP, &value, sizeof(value), &cbFetched);
     Py_END_ALLOW_THREADS
@@ -533,7 +681,17 @@ static PyObject* GetDataTimestamp(Cursor* cur, Py_ssize_t iCol)
     if (cbFetched == SQL_NULL_DATA)
         Py_RETURN_NONE;
 
-    switch (cur->colinfos[iCol].sql_type)
+    return TimestampToObject(cur->colinfos[iCol].sql_type, value);
+}
+
+static PyObject* TimestampToObject(SQLSMALLINT sql_type, TIMESTAMP_STRUCT& value)
+{
+    // Converts a TIMESTAMP_STRUCT read for a column of type `sql_type` to a date, time, or
+    // datetime.
+
+    struct tm t;
+
+    switch (sql_type)
     {
         case SQL_TYPE_TIME:
         {
@@ -610,10 +768,9 @@ PyObject* PythonTypeFromSqlType(Cursor* cur, SQLSMALLINT type)
         break;
 
     case SQL_GUID:
-        if (UseNativeUUID())
+        if (cur->native_uuid)
         {
-            pytype = GetClassForThread("uuid", "UUID");
-            incref = false;
+            pytype = cur->uuid_type;
         }
         else
         {
@@ -631,8 +788,22 @@ PyObject* PythonTypeFromSqlType(Cursor* cur, SQLSMALLINT type)
 
     case SQL_DECIMAL:
     case SQL_NUMERIC:
-        pytype = GetClassForThread("decimal", "Decimal");
-        incref = false;
+        switch (cur->decimal_mode)
+        {
+        case DECIMAL_MODE_FLOAT:
+            pytype = (PyObject*)&PyFloat_Type;
+            break;
+        case DECIMAL_MODE_STR:
+            pytype = (PyObject*)&PyUnicode_Type;
+            break;
+        case DECIMAL_MODE_INT:
+            pytype = (PyObject*)&PyLong_Type;
+            break;
+        default:
+            pytype = GetClassForThread("decimal", "Decimal");
+            incref = false;
+            break;
+        }
         break;
 
     case SQL_REAL:
@@ -683,90 +854,482 @@ PyObject* PythonTypeFromSqlType(Cursor* cur, SQLSMALLINT type)
     return pytype;
 }
 
-PyObject* GetData(Cursor* cur, Py_ssize_t iCol)
+static PyObject* GetDataUnsupported(Cursor* cur, Py_ssize_t iCol)
 {
-    // Returns an object representing the value in the row/field.  If 0 is returned, an exception has already been set.
-    //
-    // The data is assumed to be the default C type for the column's SQL type.
-
     ColumnInfo* pinfo = &cur->colinfos[iCol];
+    return RaiseErrorV("HY106", ProgrammingError, "ODBC SQL type %d is not yet supported.  column-index=%zd  type=%d",
+                       (int)pinfo->sql_type, iCol, (int)pinfo->sql_type);
+}
 
-    // First see if there is a user-defined conversion.
 
-    if (cur->cnxn->map_sqltype_to_converter) {
-        PyObject* func = Connection_GetConverter(cur->cnxn, pinfo->sql_type);
-        if (func) {
-            return GetDataUser(cur, iCol, func);
-        }
-        if (PyErr_Occurred())
-            return 0;
-    }
+static PyObject* GetDataConverted(Cursor* cur, Py_ssize_t iCol)
+{
+    return GetDataUser(cur, iCol, cur->colinfos[iCol].converter);
+}
 
-    switch (pinfo->sql_type)
+
+static GetDataFunc GetDataFuncForType(Cursor* cur, SQLSMALLINT sql_type, bool is_unsigned)
+{
+    // Returns the function that reads a value of the given SQL type without an output
+    // converter.
+    //
+    // Keep this in sync with GetBindType and PythonTypeFromSqlType.
+
+    switch (sql_type)
     {
     case SQL_WCHAR:
     case SQL_WVARCHAR:
     case SQL_WLONGVARCHAR:
-        return GetText(cur, iCol);
+        return GetText;
 
     case SQL_CHAR:
     case SQL_VARCHAR:
     case SQL_LONGVARCHAR:
     case SQL_SS_XML:
     case SQL_DB2_XML:
-        return GetText(cur, iCol);
+        return GetText;
 
     case SQL_GUID:
-        if (UseNativeUUID())
-            return GetUUID(cur, iCol);
-        return GetText(cur, iCol);
-        break;
+        if (cur->native_uuid)
+            return GetUUID;
+        return GetText;
 
     case SQL_BINARY:
     case SQL_VARBINARY:
     case SQL_LONGVARBINARY:
-        return GetBinary(cur, iCol);
+        return GetBinary;
 
     case SQL_DECIMAL:
     case SQL_NUMERIC:
+        switch (cur->decimal_mode)
+        {
+        case DECIMAL_MODE_FLOAT:
+            return GetDataDouble;
+        case DECIMAL_MODE_STR:
+            return GetDataDecimalText;
+        case DECIMAL_MODE_INT:
+            return GetDataDecimalInt;
+        }
+        return GetDataDecimal;
+
     case SQL_DB2_DECFLOAT:
-        return GetDataDecimal(cur, iCol);
+        return GetDataDecimal;
 
     case SQL_BIT:
-        return GetDataBit(cur, iCol);
+        return GetDataBit;
 
     case SQL_TINYINT:
     case SQL_SMALLINT:
     case SQL_INTEGER:
-        return GetDataLong(cur, iCol);
+        return is_unsigned ? GetDataULong : GetDataLong;
 
     case SQL_BIGINT:
-        return GetDataLongLong(cur, iCol);
+        return is_unsigned ? GetDataULongLong : GetDataLongLong;
 
     case SQL_REAL:
     case SQL_FLOAT:
     case SQL_DOUBLE:
-        return GetDataDouble(cur, iCol);
-
+        return GetDataDouble;
 
     case SQL_DATE:
     case SQL_TYPE_DATE:
     case SQL_TYPE_TIME:
     case SQL_TIMESTAMP:
     case SQL_TYPE_TIMESTAMP:
-        return GetDataTimestamp(cur, iCol);
+        return GetDataTimestamp;
 
     case SQL_SS_TIME2:
-        return GetSqlServerTime(cur, iCol);
+        return GetSqlServerTime;
 
     case SQL_SS_VARIANT:
-        return GetData_SqlVariant(cur, iCol);
+        return GetData_SqlVariant;
     }
 
-    return RaiseErrorV("HY106", ProgrammingError, "ODBC SQL type %d is not yet supported.  column-index=%zd  type=%d",
-                       (int)pinfo->sql_type, iCol, (int)pinfo->sql_type);
+    return GetDataUnsupported;
+}
+
+
+bool ResolveGetData(Cursor* cur, Py_ssize_t iCol)
+{
+    // Chooses the function GetData will use to read the column and stores it in the column's
+    // ColumnInfo.  Called once per result set by PrepareResults, so the output converter in
+    // effect when the query was executed is used for the whole result set.
+    //
+    // Returns false if an error occurs, in which case an exception is set.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    if (cur->cnxn->map_sqltype_to_converter)
+    {
+        PyObject* func = Connection_GetConverter(cur->cnxn, pinfo->sql_type);
+        if (func)
+        {
+            Py_INCREF(func);
+            pinfo->converter = func;
+            pinfo->getdata = GetDataConverted;
+            return true;
+        }
+        if (PyErr_Occurred())
+            return false;
+    }
+
+    pinfo->getdata = GetDataFuncForType(cur, pinfo->sql_type, pinfo->is_unsigned);
+    return true;
+}
+
+
+PyObject* GetData(Cursor* cur, Py_ssize_t iCol)
+{
+    // Returns an object representing the value in the row/field.  If 0 is returned, an exception has already been set.
+    //
+    // The data is assumed to be the default C type for the column's SQL type.
+
+    return cur->colinfos[iCol].getdata(cur, iCol);
+}
+
+// The largest buffer, in bytes, we'll bind a single text or binary value to when fetching
+// rowsets.  Wider columns are read with SQLGetData like LOBs so a rowset of them doesn't turn
+// into an enormous buffer.
+static const SQLULEN MAX_BIND_SIZE = 16 * 1024;
+
+static bool GetTextBindSize(SQLSMALLINT ctype, SQLULEN cch, SQLLEN& cbElement)
+{
+    // Computes the buffer size needed to bind a text value of up to `cch` characters.
+    // Returns false if it is too large to bind.
+    //
+    // The column size is in characters but the driver converts to the client encoding, so
+    // leave room for the worst case: 4 bytes per character for UTF-8 and surrogate pairs for
+    // UTF-16.
+
+    if (cch == 0 || cch > MAX_BIND_SIZE)
+        return false;
+
+    SQLULEN cb = (ctype == SQL_C_WCHAR) ? (cch * 2 + 1) * sizeof(uint16_t) : (cch * 4 + 1);
+    if (cb > MAX_BIND_SIZE)
+        return false;
+
+    cbElement = (SQLLEN)cb;
+    return true;
+}
+
+
+bool GetBindType(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT& ctype, SQLLEN& cbElement)
+{
+    // Determines how a column can be bound with SQLBindCol when fetching rowsets.  Sets ctype
+    // to the C type to bind and cbElement to the buffer size needed for one value, including
+    // any null terminator.  If the column must be read with SQLGetData (LOBs, columns with an
+    // output converter, etc.) ctype is set to 0.
+    //
+    // Returns false if an error occurs, in which case an exception is set.
+    //
+    // Keep this in sync with GetData and GetBoundData.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    ctype = 0;
+    cbElement = 0;
+
+    if (pinfo->converter)
+        return true;
+
+    switch (pinfo->sql_type)
+    {
+    case SQL_WCHAR:
+    case SQL_WVARCHAR:
+    case SQL_CHAR:
+    case SQL_VARCHAR:
+    {
+        const TextEnc& enc = IsWideType(pinfo->sql_type) ? cur->cnxn->sqlwchar_enc : cur->cnxn->sqlchar_enc;
+        if (GetTextBindSize(enc.ctype, pinfo->column_size, cbElement))
+            ctype = enc.ctype;
+        break;
+    }
+
+    case SQL_GUID:
+        if (cur->native_uuid)
+        {
+            ctype = SQL_GUID;
+            cbElement = sizeof(PYSQLGUID);
+        }
+        else if (GetTextBindSize(cur->cnxn->sqlchar_enc.ctype, pinfo->column_size, cbElement))
+        {
+            ctype = cur->cnxn->sqlchar_enc.ctype;
+        }
+        break;
+
+    case SQL_BINARY:
+    case SQL_VARBINARY:
+        if (pinfo->column_size != 0 && pinfo->column_size <= MAX_BIND_SIZE)
+        {
+            ctype = SQL_C_BINARY;
+            cbElement = (SQLLEN)pinfo->column_size;
+        }
+        break;
+
+    case SQL_DECIMAL:
+    case SQL_NUMERIC:
+        if (cur->decimal_mode == DECIMAL_MODE_FLOAT)
+        {
+            ctype = SQL_C_DOUBLE;
+            cbElement = sizeof(double);
+            break;
+        }
+        // Read as text like GetDataDecimal.  Leave room for the sign, decimal point, and any
+        // group separators or currency symbols the driver inserts.
+        if (pinfo->column_size <= MAX_BIND_SIZE &&
+            GetTextBindSize(cur->cnxn->sqlwchar_enc.ctype, pinfo->column_size * 2 + 8, cbElement))
+        {
+            ctype = cur->cnxn->sqlwchar_enc.ctype;
+        }
+        break;
+
+    case SQL_BIT:
+        ctype = SQL_C_BIT;
+        cbElement = sizeof(SQLCHAR);
+        break;
+
+    case SQL_TINYINT:
+    case SQL_SMALLINT:
+    case SQL_INTEGER:
+        ctype = pinfo->is_unsigned ? SQL_C_ULONG : SQL_C_LONG;
+        cbElement = sizeof(SQLINTEGER);
+        break;
+
+    case SQL_BIGINT:
+        ctype = pinfo->is_unsigned ? SQL_C_UBIGINT : SQL_C_SBIGINT;
+        cbElement = sizeof(SQLBIGINT);
+        break;
+
+    case SQL_REAL:
+    case SQL_FLOAT:
+    case SQL_DOUBLE:
+        ctype = SQL_C_DOUBLE;
+        cbElement = sizeof(double);
+        break;
+
+    case SQL_DATE:
+    case SQL_TYPE_DATE:
+    case SQL_TYPE_TIME:
+    case SQL_TIMESTAMP:
+    case SQL_TYPE_TIMESTAMP:
+        ctype = SQL_C_TYPE_TIMESTAMP;
+        cbElement = sizeof(TIMESTAMP_STRUCT);
+        break;
+
+    case SQL_SS_TIME2:
+        ctype = SQL_C_BINARY;
+        cbElement = sizeof(SQL_SS_TIME2_STRUCT);
+        break;
+    }
+
+    return true;
+}
+
+
+static bool CheckBoundLength(ColumnInfo* pinfo, Py_ssize_t iCol, SQLLEN cbData)
+{
+    // Ensures a variable length value fit in its bound buffer.  The buffers were sized from
+    // the column size, so this only fails if the driver returns more than it described.  We
+    // can't go back for the rest once the rowset has been fetched.
+
+    const SQLLEN cbNullTerminator = (pinfo->bind_ctype == SQL_C_BINARY) ? 0 :
+        ((pinfo->bind_ctype == SQL_C_WCHAR) ? (SQLLEN)sizeof(uint16_t) : 1);
+
+    if (cbData < 0 || cbData > pinfo->bind_size - cbNullTerminator)
+    {
+        RaiseErrorV("01004", DataError,
+                    "Column %zd was truncated when fetching rowsets (%ld bytes bound).  Set rowsetsize to 1 to read it with SQLGetData.",
+                    iCol, (long)pinfo->bind_size);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool GetDataFixed(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow, SQLSMALLINT ctype, void* pv, SQLLEN cbValue, bool& isNull)
+{
+    // Reads a fixed-size value as C type `ctype` into the `cbValue` bytes at `pv` without
+    // creating a Python object.  If the column is bound, `ctype` must be the bound type and the
+    // value is copied from row `iRow` of the bound buffers.  Otherwise it is read using
+    // SQLGetData.
+    //
+    // Returns false if an error occurs, in which case an exception is set.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    if (pinfo->bind_ctype)
+    {
+        assert(pinfo->bind_ctype == ctype && pinfo->bind_size == cbValue);
+        isNull = (pinfo->bind_ind[iRow] == SQL_NULL_DATA);
+        if (!isNull)
+            memcpy(pv, &pinfo->bind_data[pinfo->bind_size * (SQLLEN)iRow], (size_t)cbValue);
+        return true;
+    }
+
+    SQLLEN cbFetched = 0;
+    SQLRETURN ret;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetData(cur->hstmt, (SQLUSMALLINT)(iCol+1), ctype, pv, cbValue, &cbFetched);
+    Py_END_ALLOW_THREADS
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle(cur->cnxn, "SQLGetData", cur->cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    isNull = (cbFetched == SQL_NULL_DATA);
+    return true;
+}
+
+
+bool GetDataBuffer(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow, SQLSMALLINT ctype, bool& isNull, byte*& pbData,
+                   Py_ssize_t& cbData)
+{
+    // Reads a variable-length value as C type `ctype` without creating a Python object.  The
+    // results are the same as ReadVarColumn's, except that if the column is bound, pbData
+    // points into row `iRow` of the bound buffers.  Either way the data is owned by the cursor
+    // and must not be freed.
+    //
+    // Returns false if an error occurs, in which case an exception is set.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    if (pinfo->bind_ctype)
+    {
+        assert(pinfo->bind_ctype == ctype);
+
+        pbData = 0;
+        cbData = 0;
+
+        SQLLEN cb = pinfo->bind_ind[iRow];
+        isNull = (cb == SQL_NULL_DATA);
+        if (isNull)
+            return true;
+
+        if (!CheckBoundLength(pinfo, iCol, cb))
+            return false;
+
+        if (cb > 0)
+        {
+            pbData = &pinfo->bind_data[pinfo->bind_size * (SQLLEN)iRow];
+            cbData = (Py_ssize_t)cb;
+        }
+        return true;
+    }
+
+    return ReadVarColumn(cur, iCol, ctype, isNull, pbData, cbData);
+}
+
+
+int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d)
+{
+    // Returns the number of days since 1970-01-01 in the proleptic Gregorian calendar.  This is
+    // Howard Hinnant's days_from_civil algorithm.
+
+    y -= (m <= 2);
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+
+void CivilFromDays(int64_t days, int64_t& y, unsigned& m, unsigned& d)
+{
+    // The inverse of DaysFromCivil: Howard Hinnant's civil_from_days algorithm.
+
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = (unsigned)(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int64_t)yoe + era * 400 + (m <= 2);
+}
+
+PyObject* GetBoundData(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow)
+{
+    // Returns an object representing the value in row `iRow` of the current rowset for a
+    // column that was bound using the type from GetBindType.  If 0 is returned, an exception
+    // has already been set.
+
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    SQLLEN cbData = pinfo->bind_ind[iRow];
+    if (cbData == SQL_NULL_DATA)
+        Py_RETURN_NONE;
+
+    byte* pbData = &pinfo->bind_data[pinfo->bind_size * (SQLLEN)iRow];
+
+    switch (pinfo->bind_ctype)
+    {
+    case SQL_C_BIT:
+        if (*(SQLCHAR*)pbData == SQL_TRUE)
+            Py_RETURN_TRUE;
+        Py_RETURN_FALSE;
+
+    case SQL_C_LONG:
+        return PyLong_FromLong(*(SQLINTEGER*)pbData);
+
+    case SQL_C_ULONG:
+        return PyLong_FromUnsignedLong(*(SQLUINTEGER*)pbData);
+
+    case SQL_C_SBIGINT:
+        return PyLong_FromLongLong((PY_LONG_LONG)*(SQLBIGINT*)pbData);
+
+    case SQL_C_UBIGINT:
+        return PyLong_FromUnsignedLongLong((unsigned PY_LONG_LONG)*(SQLUBIGINT*)pbData);
+
+    case SQL_C_DOUBLE:
+        return PyFloat_FromDouble(*(double*)pbData);
+
+    case SQL_C_TYPE_TIMESTAMP:
+    {
+        // TimestampToObject clamps the year, so give it a copy.
+        TIMESTAMP_STRUCT value = *(TIMESTAMP_STRUCT*)pbData;
+        return TimestampToObject(pinfo->sql_type, value);
+    }
+
+    case SQL_GUID:
+        return UUIDFromGuid(cur, *(PYSQLGUID*)pbData);
+    }
+
+    // What's left are the variable length types.
+
+    if (!CheckBoundLength(pinfo, iCol, cbData))
+        return 0;
+
+    if (pinfo->bind_ctype == SQL_C_BINARY)
+    {
+        if (pinfo->sql_type == SQL_SS_TIME2)
+        {
+            SQL_SS_TIME2_STRUCT* pvalue = (SQL_SS_TIME2_STRUCT*)pbData;
+            int micros = (int)(pvalue->fraction / 1000); // nanos --> micros
+            return PyTime_FromTime(pvalue->hour, pvalue->minute, pvalue->second, micros);
+        }
+        return PyBytes_FromStringAndSize((char*)pbData, cbData);
+    }
+
+    if (pinfo->sql_type == SQL_DECIMAL || pinfo->sql_type == SQL_NUMERIC)
+    {
+        if (cur->decimal_mode == DECIMAL_MODE_INT)
+            return ScaledIntFromText(cur->cnxn->sqlwchar_enc, pbData, cbData, pinfo->decimal_digits);
+        if (cur->decimal_mode == DECIMAL_MODE_STR)
+            return TextBufferToObject(cur->cnxn->sqlwchar_enc, pbData, cbData);
+        return DecimalFromText(cur->cnxn->sqlwchar_enc, pbData, cbData);
+    }
+
+    const TextEnc& enc = IsWideType(pinfo->sql_type) ? cur->cnxn->sqlwchar_enc : cur->cnxn->sqlchar_enc;
+    return TextBufferToObject(enc, pbData, cbData);
 }
 
+
 PyObject *GetData_SqlVariant(Cursor *cur, Py_ssize_t iCol) {
     char pBuff;
 
@@ -790,9 +1353,16 @@ PyObject *GetData_SqlVariant(Cursor *cur, Py_ssize_t iCol) {
     if (!SQL_SUCCEEDED(retcode))
         return RaiseErrorFromHandle(cur->cnxn, "SQLColAttribute", cur->cnxn->hdbc, cur->hstmt);
 
-    // Replace the original SQL_VARIANT data type with the underlying data type then call GetData() again
+    // Replace the original SQL_VARIANT data type with the underlying data type and read it.  The type is only known
+    // now, so the converter and reader are looked up for each value instead of using ColumnInfo.getdata.
     cur->colinfos[iCol].sql_type = static_cast<SQLSMALLINT>(variantType);
-    decodeResult = GetData(cur, iCol);
+
+    decodeResult = 0;
+    PyObject* func = cur->cnxn->map_sqltype_to_converter ? Connection_GetConverter(cur->cnxn, cur->colinfos[iCol].sql_type) : 0;
+    if (func)
+        decodeResult = GetDataUser(cur, iCol, func);
+    else if (!PyErr_Occurred())
+        decodeResult = GetDataFuncForType(cur, cur->colinfos[iCol].sql_type, cur->colinfos[iCol].is_unsigned)(cur, iCol);
 
     // Restore the original SQL_VARIANT data type so that the next decode will call this method again
     cur->colinfos[iCol].sql_type = static_cast<SQLSMALLINT>(SQL_SS_VARIANT);
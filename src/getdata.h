@@ -6,8 +6,19 @@ void GetData_init();
 
 PyObject* PythonTypeFromSqlType(Cursor* cur, SQLSMALLINT type);
 
+bool ResolveGetData(Cursor* cur, Py_ssize_t iCol);
 PyObject* GetData(Cursor* cur, Py_ssize_t iCol);
 
+bool GetBindType(Cursor* cur, Py_ssize_t iCol, SQLSMALLINT& ctype, SQLLEN& cbElement);
+PyObject* GetBoundData(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow);
+
+bool GetDataFixed(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow, SQLSMALLINT ctype, void* pv, SQLLEN cbValue, bool& isNull);
+bool GetDataBuffer(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow, SQLSMALLINT ctype, bool& isNull, byte*& pbData,
+                   Py_ssize_t& cbData);
+
+int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d);
+void CivilFromDays(int64_t days, int64_t& y, unsigned& m, unsigned& d);
+
 /**
  * If this sql type has a user-defined conversion, the index into the connection's `conv_funcs` array is returned.
  * Otherwise -1 is returned.
@@ -0,0 +1,348 @@
+// Implements Cursor.fetchnumpy, which reads rows into NumPy arrays, one per column.
+//
+// Numeric, bit, date, and timestamp values are written directly into the arrays' memory without
+// creating a Python object for each value.  Other types are read using GetData into object
+// arrays.
+//
+// NumPy is not needed to build pyodbc.  The values are collected in bytearrays which are wrapped
+// using numpy.frombuffer (without copying) once all of the rows have been read.
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "getdata.h"
+#include "numpyfetch.h"
+
+enum NumpyKind
+{
+    NK_BOOL,
+    NK_INT32,                   // read as 32-bit, stored as int64
+    NK_UINT32,                  // read as unsigned 32-bit, stored as int64
+    NK_INT64,
+    NK_UINT64,
+    NK_DOUBLE,
+    NK_DATE,
+    NK_TIMESTAMP,
+    NK_OBJECT
+};
+
+struct NumpyColumn
+{
+    NumpyKind kind;
+
+    SQLSMALLINT ctype;
+    // The C type the values are read as.  This matches GetBindType so the bound buffers can be
+    // read when the cursor is fetching rowsets.
+
+    Py_ssize_t width;
+    // The number of bytes per element in the array.
+
+    const char* dtype;
+
+    PyObject* values;
+    // A bytearray holding the array elements, or a list of values for NK_OBJECT columns.
+
+    PyObject* mask;
+    // A bytearray with 1 for each null and 0 otherwise.
+};
+
+
+static void InitColumn(Cursor* cur, Py_ssize_t iCol, NumpyColumn& col)
+{
+    ColumnInfo* pinfo = &cur->colinfos[iCol];
+
+    col.kind   = NK_OBJECT;
+    col.ctype  = 0;
+    col.width  = 0;
+    col.dtype  = "O";
+
+    if (pinfo->converter)
+    {
+        // Output converters return Python objects.
+        return;
+    }
+
+    switch (pinfo->sql_type)
+    {
+    case SQL_BIT:
+        col.kind  = NK_BOOL;
+        col.ctype = SQL_C_BIT;
+        col.width = 1;
+        col.dtype = "?";
+        break;
+
+    case SQL_TINYINT:
+    case SQL_SMALLINT:
+    case SQL_INTEGER:
+        col.kind  = pinfo->is_unsigned ? NK_UINT32 : NK_INT32;
+        col.ctype = pinfo->is_unsigned ? SQL_C_ULONG : SQL_C_LONG;
+        col.width = 8;
+        col.dtype = "i8";
+        break;
+
+    case SQL_BIGINT:
+        col.kind  = pinfo->is_unsigned ? NK_UINT64 : NK_INT64;
+        col.ctype = pinfo->is_unsigned ? SQL_C_UBIGINT : SQL_C_SBIGINT;
+        col.width = 8;
+        col.dtype = pinfo->is_unsigned ? "u8" : "i8";
+        break;
+
+    case SQL_DECIMAL:
+    case SQL_NUMERIC:
+        if (cur->decimal_mode != DECIMAL_MODE_FLOAT)
+            break;
+        // fall through: read as SQL_C_DOUBLE like GetBindType
+
+    case SQL_REAL:
+    case SQL_FLOAT:
+    case SQL_DOUBLE:
+        col.kind  = NK_DOUBLE;
+        col.ctype = SQL_C_DOUBLE;
+        col.width = 8;
+        col.dtype = "f8";
+        break;
+
+    case SQL_TYPE_DATE:
+    case SQL_DATE:
+        col.kind  = NK_DATE;
+        col.ctype = SQL_C_TYPE_TIMESTAMP;
+        col.width = 8;
+        col.dtype = "M8[D]";
+        break;
+
+    case SQL_TYPE_TIMESTAMP:
+    case SQL_TIMESTAMP:
+        col.kind  = NK_TIMESTAMP;
+        col.ctype = SQL_C_TYPE_TIMESTAMP;
+        col.width = 8;
+        col.dtype = "M8[us]";
+        break;
+    }
+}
+
+
+static bool ResizeColumns(NumpyColumn* cols, Py_ssize_t cCols, Py_ssize_t cRows)
+{
+    // Resizes the bytearrays to hold cRows values.
+
+    for (Py_ssize_t i = 0; i < cCols; i++)
+    {
+        if (cols[i].kind != NK_OBJECT && PyByteArray_Resize(cols[i].values, cols[i].width * cRows) != 0)
+            return false;
+        if (PyByteArray_Resize(cols[i].mask, cRows) != 0)
+            return false;
+    }
+    return true;
+}
+
+
+static bool ReadValue(Cursor* cur, Py_ssize_t iCol, SQLULEN iRow, NumpyColumn& col, Py_ssize_t iValue)
+{
+    char* pMask = &PyByteArray_AS_STRING(col.mask)[iValue];
+
+    if (col.kind == NK_OBJECT)
+    {
+        PyObject* value = cur->colinfos[iCol].bind_ctype ? GetBoundData(cur, iCol, iRow) : GetData(cur, iCol);
+        if (!value)
+            return false;
+        *pMask = (value == Py_None);
+        int result = PyList_Append(col.values, value);
+        Py_DECREF(value);
+        return result == 0;
+    }
+
+    char* pValue = &PyByteArray_AS_STRING(col.values)[col.width * iValue];
+    bool isNull = false;
+
+    switch (col.kind)
+    {
+    case NK_BOOL:
+    {
+        SQLCHAR ch = 0;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &ch, sizeof(ch), isNull))
+            return false;
+        *pValue = (!isNull && ch == SQL_TRUE);
+        break;
+    }
+
+    case NK_INT32:
+    case NK_UINT32:
+    {
+        SQLINTEGER n = 0;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &n, sizeof(n), isNull))
+            return false;
+        int64_t value = isNull ? 0 : (col.kind == NK_INT32 ? (int64_t)n : (int64_t)(SQLUINTEGER)n);
+        memcpy(pValue, &value, sizeof(value));
+        break;
+    }
+
+    case NK_INT64:
+    case NK_UINT64:
+    case NK_DOUBLE:
+        // These are read directly into the array.
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, pValue, col.width, isNull))
+            return false;
+        if (isNull)
+            memset(pValue, 0, (size_t)col.width);
+        break;
+
+    case NK_DATE:
+    case NK_TIMESTAMP:
+    {
+        TIMESTAMP_STRUCT ts;
+        if (!GetDataFixed(cur, iCol, iRow, col.ctype, &ts, sizeof(ts), isNull))
+            return false;
+
+        int64_t value = 0;
+        if (!isNull)
+        {
+            value = DaysFromCivil(ts.year, ts.month, ts.day);
+            if (col.kind == NK_TIMESTAMP)
+                value = (((value * 24 + ts.hour) * 60 + ts.minute) * 60 + ts.second) * 1000000 + ts.fraction / 1000;
+        }
+        memcpy(pValue, &value, sizeof(value));
+        break;
+    }
+
+    case NK_OBJECT:
+        break;
+    }
+
+    *pMask = isNull;
+    return true;
+}
+
+
+static PyObject* MakeArray(PyObject* numpy, NumpyColumn& col, Py_ssize_t cRows)
+{
+    // Returns a numpy.ma.MaskedArray for the column.
+
+    Object data;
+
+    if (col.kind == NK_OBJECT)
+    {
+        // Assign each item instead of passing the list to numpy.array, which would create
+        // multi-dimensional arrays from values that are sequences.
+        data = PyObject_CallMethod(numpy, "empty", "ns", cRows, "O");
+        if (!data)
+            return 0;
+        for (Py_ssize_t i = 0; i < cRows; i++)
+        {
+            if (PySequence_SetItem(data, i, PyList_GET_ITEM(col.values, i)) != 0)
+                return 0;
+        }
+    }
+    else
+    {
+        data = PyObject_CallMethod(numpy, "frombuffer", "Os", col.values, col.dtype);
+        if (!data)
+            return 0;
+    }
+
+    Object mask(PyObject_CallMethod(numpy, "frombuffer", "Os", col.mask, "?"));
+    if (!mask)
+        return 0;
+
+    Object ma(PyObject_GetAttrString(numpy, "ma"));
+    if (!ma)
+        return 0;
+
+    return PyObject_CallMethod(ma, "masked_array", "OO", data.Get(), mask.Get());
+}
+
+
+PyObject* FetchNumpy(Cursor* cur, Py_ssize_t cMax)
+{
+    // cMax
+    //   The maximum number of rows to fetch.  If -1, fetch all rows.
+
+    Object numpy(PyImport_ImportModule("numpy"));
+    if (!numpy)
+        return 0;
+
+    Py_ssize_t cCols = PyTuple_GET_SIZE(cur->description);
+
+    NumpyColumn* cols = (NumpyColumn*)PyMem_Malloc(sizeof(NumpyColumn) * max(cCols, 1));
+    if (!cols)
+        return PyErr_NoMemory();
+    memset(cols, 0, sizeof(NumpyColumn) * max(cCols, 1));
+
+    PyObject* result = 0;
+    Py_ssize_t cRows = 0;
+    Py_ssize_t cAlloc = (cMax >= 0) ? min(cMax, 1024) : 1024;
+    Py_ssize_t i;
+
+    for (i = 0; i < cCols; i++)
+    {
+        InitColumn(cur, i, cols[i]);
+
+        cols[i].values = (cols[i].kind == NK_OBJECT) ? PyList_New(0) : PyByteArray_FromStringAndSize(0, 0);
+        cols[i].mask   = PyByteArray_FromStringAndSize(0, 0);
+        if (!cols[i].values || !cols[i].mask)
+            goto done;
+    }
+
+    if (!ResizeColumns(cols, cCols, cAlloc))
+        goto done;
+
+    while (cMax < 0 || cRows < cMax)
+    {
+        SQLULEN iRow;
+        if (!Cursor_NextRow(cur, iRow))
+        {
+            if (PyErr_Occurred())
+                goto done;
+            break;
+        }
+
+        if (cRows == cAlloc)
+        {
+            // Grow geometrically so the number of reallocations is logarithmic.
+            cAlloc *= 2;
+            if (cMax >= 0)
+                cAlloc = min(cAlloc, cMax);
+            if (!ResizeColumns(cols, cCols, cAlloc))
+                goto done;
+        }
+
+        for (i = 0; i < cCols; i++)
+        {
+            if (!ReadValue(cur, i, iRow, cols[i], cRows))
+                goto done;
+        }
+
+        cRows++;
+    }
+
+    if (!ResizeColumns(cols, cCols, cRows))
+        goto done;
+
+    result = PyDict_New();
+    if (!result)
+        goto done;
+
+    for (i = 0; i < cCols; i++)
+    {
+        PyObject* name = PyTuple_GET_ITEM(PyTuple_GET_ITEM(cur->description, i), 0);
+        Object array(MakeArray(numpy, cols[i], cRows));
+        if (!array || PyDict_SetItem(result, name, array) != 0)
+        {
+            Py_CLEAR(result);
+            goto done;
+        }
+    }
+
+  done:
+    for (i = 0; i < cCols; i++)
+    {
+        Py_XDECREF(cols[i].values);
+        Py_XDECREF(cols[i].mask);
+    }
+    PyMem_Free(cols);
+
+    return result;
+}
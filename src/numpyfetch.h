@@ -0,0 +1,10 @@
+#ifndef NUMPYFETCH_H
+#define NUMPYFETCH_H
+
+struct Cursor;
+
+PyObject* FetchNumpy(Cursor* cur, Py_ssize_t cMax);
+// Reads up to cMax rows (or all remaining rows if cMax is -1) and returns a dictionary mapping
+// each column name to a numpy.ma.MaskedArray.  NumPy is imported when this is called.
+
+#endif // NUMPYFETCH_H
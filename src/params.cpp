@@ -22,6 +22,7 @@
 #include "errors.h"
 #include "dbspecific.h"
 #include "row.h"
+#include "stmtcache.h"
 #include <datetime.h>
 
 
@@ -34,8 +35,187 @@ struct DAEParam
 {
     PyObject *cell;
     SQLLEN maxlen;
+    SQLSMALLINT ctype;          // only set for streams
 };
 
+// The column sizes reported for stream parameters since their lengths aren't known in advance.
+// These are the largest sizes SQL Server's image and ntext types allow.
+static const SQLULEN STREAM_BINARY_SIZE = 0x7FFFFFFF;
+static const SQLULEN STREAM_TEXT_SIZE   = 0x3FFFFFFF;
+
+// The size of the buffer file-like stream parameters are read into.
+static const Py_ssize_t STREAM_CHUNK_SIZE = 64 * 1024;
+
+
+inline SQLLEN MaxTypeBufferLength(const ParamInfo* pi)
+{
+    // Returns the buffer length for a (max) parameter in the fast executemany parameter array.
+    // Each element has to hold a DAEParam for values sent with SQLPutData.
+    return max(pi->cbInline, (SQLLEN)sizeof(DAEParam));
+}
+
+// Whether a (max) parameter value of `len` bytes is copied into the parameter array instead of
+// being sent with SQLPutData.
+#define IS_INLINE(pi, len) ((pi)->cbInline != 0 && (SQLLEN)(len) <= (pi)->BufferLength)
+
+// The most types GetParamKind caches per thread.  When it is full it is cleared.
+#define MAX_PARAM_KINDS 64
+
+
+enum
+{
+    // The kinds of parameter values, which determine how each is converted.  See
+    // GetParamKind.
+
+    PK_ERROR = -1,              // an exception was raised
+    PK_UNKNOWN,
+    PK_NONE,
+    PK_NULL_BINARY,
+    PK_BOOL,
+    PK_LONG,
+    PK_FLOAT,
+    PK_BYTES,
+    PK_UNICODE,
+    PK_BYTEARRAY,
+    PK_DATETIME,
+    PK_DATE,
+    PK_TIME,
+    PK_DECIMAL,
+    PK_UUID,
+    PK_STREAM,
+    PK_SEQUENCE,
+};
+
+static PyObject* paramkinds_key;
+// The thread state dictionary key for the cache of kinds by type.
+
+
+static int ClassifyParam(PyObject* param)
+{
+    // The slow path of GetParamKind, which checks the value against each type.  The order
+    // matters for subclasses: bool is an int and datetime is a date.
+
+    if (PyBool_Check(param))
+        return PK_BOOL;
+    if (PyLong_Check(param))
+        return PK_LONG;
+    if (PyFloat_Check(param))
+        return PK_FLOAT;
+    if (PyBytes_Check(param))
+        return PK_BYTES;
+    if (PyUnicode_Check(param))
+        return PK_UNICODE;
+    if (PyDateTime_Check(param))
+        return PK_DATETIME;
+    if (PyDate_Check(param))
+        return PK_DATE;
+    if (PyTime_Check(param))
+        return PK_TIME;
+    if (PyByteArray_Check(param))
+        return PK_BYTEARRAY;
+
+    PyObject* cls = 0;
+    if (!IsInstanceForThread(param, "decimal", "Decimal", &cls))
+        return PK_ERROR;
+    if (cls)
+    {
+        Py_DECREF(cls);
+        return PK_DECIMAL;
+    }
+
+    if (!IsInstanceForThread(param, "uuid", "UUID", &cls))
+        return PK_ERROR;
+    if (cls)
+    {
+        Py_DECREF(cls);
+        return PK_UUID;
+    }
+
+    if (IsStreamParameter(param))
+        return PK_STREAM;
+
+    if (PySequence_Check(param))
+        return PK_SEQUENCE;
+
+    return PK_UNKNOWN;
+}
+
+
+static int GetParamKind(PyObject* param)
+{
+    // Returns the PK_ kind of a parameter value or PK_ERROR if an exception was raised.
+    //
+    // The exact builtin types are recognized by comparing the type pointer.  Everything else,
+    // like Decimal, UUID, and subclasses, is classified once and cached by type.  The cache is
+    // kept in the thread state like GetClassForThread since the Decimal and UUID classes are
+    // different in each interpreter.  It keeps a reference to each type so a type's address
+    // can't be reused by another.  Only a few types are normally passed, so the cache is
+    // cleared when it reaches MAX_PARAM_KINDS instead of keeping every type, such as classes
+    // created at runtime, alive.
+
+    PyTypeObject* type = Py_TYPE(param);
+
+    if (type == &PyUnicode_Type)
+        return PK_UNICODE;
+    if (type == &PyLong_Type)
+        return PK_LONG;
+    if (type == &PyFloat_Type)
+        return PK_FLOAT;
+    if (param == Py_None)
+        return PK_NONE;
+    if (type == &PyBytes_Type)
+        return PK_BYTES;
+    if (type == &PyBool_Type)
+        return PK_BOOL;
+    if (type == PyDateTimeAPI->DateTimeType)
+        return PK_DATETIME;
+    if (type == PyDateTimeAPI->DateType)
+        return PK_DATE;
+    if (type == PyDateTimeAPI->TimeType)
+        return PK_TIME;
+    if (type == &PyByteArray_Type)
+        return PK_BYTEARRAY;
+    if (param == null_binary)
+        return PK_NULL_BINARY;
+
+    PyObject* dict = PyThreadState_GetDict();
+    if (dict == 0)
+    {
+        PyErr_SetString(PyExc_Exception, "pyodbc: PyThreadState_GetDict returned NULL");
+        return PK_ERROR;
+    }
+
+    // GetItem returns borrowed references.
+    PyObject* kinds = PyDict_GetItem(dict, paramkinds_key);
+    if (!kinds)
+    {
+        Object newkinds(PyDict_New());
+        if (!newkinds || PyDict_SetItem(dict, paramkinds_key, newkinds) == -1)
+            return PK_ERROR;
+        kinds = newkinds;
+    }
+
+    PyObject* cached = PyDict_GetItem(kinds, (PyObject*)type);
+    if (cached)
+        return (int)PyLong_AS_LONG(cached);
+
+    int kind = ClassifyParam(param);
+
+    // Whether an object is a stream can depend on its instance attributes, so streams are not
+    // cached.  There is no need to cache errors or unknown types either.
+    if (kind == PK_STREAM || kind == PK_UNKNOWN || kind == PK_ERROR)
+        return kind;
+
+    if (PyDict_Size(kinds) >= MAX_PARAM_KINDS)
+        PyDict_Clear(kinds);
+
+    Object value(PyLong_FromLong(kind));
+    if (!value || PyDict_SetItem(kinds, (PyObject*)type, value) == -1)
+        return PK_ERROR;
+
+    return kind;
+}
+
 
 static int DetectCType(PyObject *cell, ParamInfo *pi)
 {
@@ -46,14 +226,16 @@ static int DetectCType(PyObject *cell, ParamInfo *pi)
     // value if not None or binary.  For those, the *existing* ParameterType is used.  This
     // could be from a previous row or could have been initialized from SQLDescribeParam.
 
-    PyObject* cls = 0;
-    if (PyBool_Check(cell))
+    switch (GetParamKind(cell))
+    {
+    case PK_BOOL:
     {
     Type_Bool:
         pi->ValueType = SQL_C_BIT;
         pi->BufferLength = 1;
+        break;
     }
-    else if (PyLong_Check(cell))
+    case PK_LONG:
     {
     Type_Long:
         if (pi->ParameterType == SQL_NUMERIC ||
@@ -67,42 +249,48 @@ static int DetectCType(PyObject *cell, ParamInfo *pi)
             pi->ValueType = SQL_C_SBIGINT;
             pi->BufferLength = sizeof(long long);
         }
+        break;
     }
-    else if (PyFloat_Check(cell))
+    case PK_FLOAT:
     {
     Type_Float:
         pi->ValueType = SQL_C_DOUBLE;
         pi->BufferLength = sizeof(double);
+        break;
     }
-    else if (PyBytes_Check(cell))
+    case PK_BYTES:
     {
     Type_Bytes:
         // Assume the SQL type is also character (2.x) or binary (3.x).
-        // If it is a max-type (ColumnSize == 0), use DAE.
+        // If it is a max-type (ColumnSize == 0), bind short values inline and use DAE for the rest.
         pi->ValueType = SQL_C_BINARY;
-        pi->BufferLength = pi->ColumnSize ? pi->ColumnSize : sizeof(DAEParam);
+        pi->BufferLength = pi->ColumnSize ? pi->ColumnSize : MaxTypeBufferLength(pi);
+        break;
     }
-    else if (PyUnicode_Check(cell))
+    case PK_UNICODE:
     {
     Type_Unicode:
         // Assume the SQL type is also wide character.
-        // If it is a max-type (ColumnSize == 0), use DAE.
+        // If it is a max-type (ColumnSize == 0), bind short values inline and use DAE for the rest.
         pi->ValueType = SQL_C_WCHAR;
-        pi->BufferLength = pi->ColumnSize ? pi->ColumnSize * sizeof(SQLWCHAR) : sizeof(DAEParam);
+        pi->BufferLength = pi->ColumnSize ? pi->ColumnSize * sizeof(SQLWCHAR) : MaxTypeBufferLength(pi);
+        break;
     }
-    else if (PyDateTime_Check(cell))
+    case PK_DATETIME:
     {
     Type_DateTime:
         pi->ValueType = SQL_C_TYPE_TIMESTAMP;
         pi->BufferLength = sizeof(SQL_TIMESTAMP_STRUCT);
+        break;
     }
-    else if (PyDate_Check(cell))
+    case PK_DATE:
     {
     Type_Date:
         pi->ValueType = SQL_C_TYPE_DATE;
         pi->BufferLength = sizeof(SQL_DATE_STRUCT);
+        break;
     }
-    else if (PyTime_Check(cell))
+    case PK_TIME:
     {
     Type_Time:
         if (pi->ParameterType == SQL_SS_TIME2)
@@ -115,14 +303,17 @@ static int DetectCType(PyObject *cell, ParamInfo *pi)
             pi->ValueType = SQL_C_TYPE_TIME;
             pi->BufferLength = sizeof(SQL_TIME_STRUCT);
         }
+        break;
     }
-    else if (PyByteArray_Check(cell))
+    case PK_BYTEARRAY:
     {
         // Type_ByteArray:
         pi->ValueType = SQL_C_BINARY;
-        pi->BufferLength = pi->ColumnSize ? pi->ColumnSize : sizeof(DAEParam);
+        pi->BufferLength = pi->ColumnSize ? pi->ColumnSize : MaxTypeBufferLength(pi);
+        break;
     }
-    else if (cell == Py_None || cell == null_binary)
+    case PK_NONE:
+    case PK_NULL_BINARY:
     {
         // Use the SQL type to guess what Nones should be inserted as here.
         switch (pi->ParameterType)
@@ -168,25 +359,56 @@ static int DetectCType(PyObject *cell, ParamInfo *pi)
         default:
             goto Type_Bytes;
         }
+        break;
     }
-    else if (IsInstanceForThread(cell, "uuid", "UUID", &cls) && cls)
+    case PK_UUID:
     {
     Type_UUID:
         // UUID
         pi->ValueType = SQL_C_GUID;
         pi->BufferLength = 16;
+        break;
     }
-    else if (IsInstanceForThread(cell, "decimal", "Decimal", &cls) && cls)
+    case PK_DECIMAL:
     {
     Type_Decimal:
         pi->ValueType = SQL_C_NUMERIC;
         pi->BufferLength = sizeof(SQL_NUMERIC_STRUCT);
+        break;
     }
-    else
+    case PK_STREAM:
+    {
+        // Streams are always sent with SQLPutData, which is only used for (max) parameters.
+        if (pi->ColumnSize)
+        {
+            RaiseErrorV(0, ProgrammingError, "File-like objects and iterators can only be used for (max) parameters with fast_executemany.");
+            return false;
+        }
+        switch (pi->ParameterType)
+        {
+        case SQL_CHAR:
+        case SQL_VARCHAR:
+        case SQL_LONGVARCHAR:
+        case SQL_WCHAR:
+        case SQL_WVARCHAR:
+        case SQL_WLONGVARCHAR:
+            pi->ValueType = SQL_C_WCHAR;
+            break;
+        default:
+            pi->ValueType = SQL_C_BINARY;
+            break;
+        }
+        pi->BufferLength = MaxTypeBufferLength(pi);
+        break;
+    }
+    case PK_ERROR:
+        return false;
+    default:
     {
         RaiseErrorV(0, ProgrammingError, "Unknown object type %s during describe", cell->ob_type->tp_name);
         return false;
     }
+    }
     return true;
 }
 
@@ -196,17 +418,17 @@ static int DetectCType(PyObject *cell, ParamInfo *pi)
 // Returns false if object could not be converted.
 static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamInfo *pi)
 {
-    PyObject *cls = 0;
-    // TODO: Any way to make this a switch (O(1)) or similar instead of if-else chain?
-    // TODO: Otherwise, rearrange these cases in order of frequency...
     SQLLEN ind;
-    if (PyBool_Check(cell))
+    switch (GetParamKind(cell))
+    {
+    case PK_BOOL:
     {
         if (pi->ValueType != SQL_C_BIT)
             return false;
         WRITEOUT(char, outbuf, cell == Py_True, ind);
+        break;
     }
-    else if (PyLong_Check(cell))
+    case PK_LONG:
     {
         if (pi->ValueType == SQL_C_SBIGINT)
         {
@@ -260,26 +482,28 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
         }
         else
             return false;
+        break;
     }
-    else if (PyFloat_Check(cell))
+    case PK_FLOAT:
     {
         if (pi->ValueType != SQL_C_DOUBLE)
             return false;
         WRITEOUT(double, outbuf, PyFloat_AS_DOUBLE(cell), ind);
+        break;
     }
-    else if (PyBytes_Check(cell))
+    case PK_BYTES:
     {
         if (pi->ValueType != SQL_C_BINARY)
             return false;
         Py_ssize_t len = PyBytes_GET_SIZE(cell);
 
-        if (!pi->ColumnSize) // DAE
+        if (!pi->ColumnSize && !IS_INLINE(pi, len)) // DAE
         {
             DAEParam *pParam = (DAEParam*)*outbuf;
             Py_INCREF(cell);
             pParam->cell = cell;
             pParam->maxlen = cur->cnxn->GetMaxLength(pi->ValueType);
-            *outbuf += sizeof(DAEParam);
+            *outbuf += pi->BufferLength;
             ind = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)len) : SQL_DATA_AT_EXEC;
         }
         else
@@ -293,32 +517,48 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
             *outbuf += pi->BufferLength;
             ind = len;
         }
+        break;
     }
-    else if (PyUnicode_Check(cell))
+    case PK_UNICODE:
     {
         if (pi->ValueType != SQL_C_WCHAR)
             return false;
 
+        // The standard encodings are written straight into the buffer.  Others need the codec
+        // and a temporary bytes object.
         const TextEnc& enc = cur->cnxn->unicode_enc;
-        Object encoded(PyCodec_Encode(cell, enc.name, "strict"));
-        if (!encoded)
-            return false;
-
-        if (enc.optenc == OPTENC_NONE && !PyBytes_CheckExact(encoded))
+        Object encoded;
+        Py_ssize_t len = enc.EncodedLength(cell);
+        if (len < 0)
         {
-            PyErr_Format(PyExc_TypeError, "Unicode write encoding '%s' returned unexpected data type: %s",
-                         enc.name, encoded.Get()->ob_type->tp_name);
-            return false;
+            encoded = enc.Encode(cell);
+            if (!encoded)
+                return false;
+
+            if (enc.optenc == OPTENC_NONE && !PyBytes_CheckExact(encoded))
+            {
+                PyErr_Format(PyExc_TypeError, "Unicode write encoding '%s' returned unexpected data type: %s",
+                             enc.name, encoded.Get()->ob_type->tp_name);
+                return false;
+            }
+
+            len = PyBytes_GET_SIZE(encoded);
         }
 
-        Py_ssize_t len = PyBytes_GET_SIZE(encoded);
-        if (!pi->ColumnSize)
+        if (!pi->ColumnSize && !IS_INLINE(pi, len))
         {
             // DAE
+            if (!encoded)
+            {
+                encoded = PyBytes_FromStringAndSize(0, len);
+                if (!encoded)
+                    return false;
+                enc.EncodeInto(cell, (byte*)PyBytes_AS_STRING(encoded.Get()));
+            }
             DAEParam *pParam = (DAEParam*)*outbuf;
             pParam->cell = encoded.Detach();
             pParam->maxlen = cur->cnxn->GetMaxLength(pi->ValueType);
-            *outbuf += sizeof(DAEParam);
+            *outbuf += pi->BufferLength;
             ind = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)len) : SQL_DATA_AT_EXEC;
         }
         else
@@ -328,12 +568,16 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
                 RaiseErrorV(0, ProgrammingError, "String data, right truncation: length %u buffer %u", len, pi->BufferLength);
                 return false;
             }
-            memcpy(*outbuf, PyBytes_AS_STRING((PyObject*)encoded), len);
+            if (encoded)
+                memcpy(*outbuf, PyBytes_AS_STRING(encoded.Get()), len);
+            else
+                enc.EncodeInto(cell, *outbuf);
             *outbuf += pi->BufferLength;
             ind = len;
         }
+        break;
     }
-    else if (PyDateTime_Check(cell))
+    case PK_DATETIME:
     {
         if (pi->ValueType != SQL_C_TYPE_TIMESTAMP)
             return false;
@@ -353,8 +597,9 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
 
         *outbuf += sizeof(SQL_TIMESTAMP_STRUCT);
         ind = sizeof(SQL_TIMESTAMP_STRUCT);
+        break;
     }
-    else if (PyDate_Check(cell))
+    case PK_DATE:
     {
         if (pi->ValueType != SQL_C_TYPE_DATE)
             return false;
@@ -364,8 +609,9 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
         pds->day = PyDateTime_GET_DAY(cell);
         *outbuf += sizeof(SQL_DATE_STRUCT);
         ind = sizeof(SQL_DATE_STRUCT);
+        break;
     }
-    else if (PyTime_Check(cell))
+    case PK_TIME:
     {
         if (pi->ParameterType == SQL_SS_TIME2)
         {
@@ -391,19 +637,20 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
             *outbuf += sizeof(SQL_TIME_STRUCT);
             ind = sizeof(SQL_TIME_STRUCT);
         }
+        break;
     }
-    else if (PyByteArray_Check(cell))
+    case PK_BYTEARRAY:
     {
         if (pi->ValueType != SQL_C_BINARY)
             return false;
         Py_ssize_t len = PyByteArray_GET_SIZE(cell);
-        if (!pi->ColumnSize) // DAE
+        if (!pi->ColumnSize && !IS_INLINE(pi, len)) // DAE
         {
             DAEParam *pParam = (DAEParam*)*outbuf;
             Py_INCREF(cell);
             pParam->cell = cell;
             pParam->maxlen = cur->cnxn->GetMaxLength(pi->ValueType);
-            *outbuf += sizeof(DAEParam);
+            *outbuf += pi->BufferLength;
             ind = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC((SQLLEN)len) : SQL_DATA_AT_EXEC;
         }
         else
@@ -417,8 +664,9 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
             *outbuf += pi->BufferLength;
             ind = len;
         }
+        break;
     }
-    else if (IsInstanceForThread(cell, "uuid", "UUID", &cls) && cls)
+    case PK_UUID:
     {
         if (pi->ValueType != SQL_C_GUID)
             return false;
@@ -430,8 +678,9 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
         memcpy(*outbuf, PyBytes_AS_STRING(b.Get()), sizeof(SQLGUID));
         *outbuf += pi->BufferLength;
         ind = 16;
+        break;
     }
-    else if (IsInstanceForThread(cell, "decimal", "Decimal", &cls) && cls)
+    case PK_DECIMAL:
     {
         if (pi->ValueType != SQL_C_NUMERIC)
             return false;
@@ -497,8 +746,10 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
         }
         *outbuf += pi->BufferLength;
         ind = sizeof(SQL_NUMERIC_STRUCT);
+        break;
     }
-    else if (cell == Py_None || cell == null_binary)
+    case PK_NONE:
+    case PK_NULL_BINARY:
     {
         // REVIEW: Theoretically we could eliminate the initial call to SQLDescribeParam for
         // all columns if we had a special value for "unknown" and called SQLDescribeParam only
@@ -507,12 +758,37 @@ static int PyToCType(Cursor *cur, unsigned char **outbuf, PyObject *cell, ParamI
 
         *outbuf += pi->BufferLength;
         ind = SQL_NULL_DATA;
+        break;
     }
-    else
+    case PK_STREAM:
+    {
+        if (pi->ColumnSize) // not DAE
+            return false;
+        if (cur->fastexecmany_continue)
+        {
+            // The rows after a failed row may be executed again, but a stream can only be read
+            // once.
+            RaiseErrorV(0, ProgrammingError, "File-like objects and iterators can't be used with fast_executemany_continue_on_error.");
+            return false;
+        }
+        DAEParam *pParam = (DAEParam*)*outbuf;
+        Py_INCREF(cell);
+        pParam->cell = cell;
+        pParam->maxlen = cur->cnxn->GetMaxLength(pi->ValueType);
+        pParam->ctype = pi->ValueType;
+        *outbuf += pi->BufferLength;
+        // The length isn't known, so drivers that want it are told zero.
+        ind = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC(0) : SQL_DATA_AT_EXEC;
+        break;
+    }
+    case PK_ERROR:
+        return false;
+    default:
     {
         RaiseErrorV(0, ProgrammingError, "Unknown object type: %s",cell->ob_type->tp_name);
         return false;
     }
+    }
     *(SQLLEN*)(*outbuf) = ind;
     *outbuf += sizeof(SQLLEN);
     return true;
@@ -530,6 +806,7 @@ static void FreeInfos(ParamInfo* a, Py_ssize_t count)
         if (a[i].ParameterType == SQL_SS_TABLE && a[i].nested)
             FreeInfos(a[i].nested, a[i].maxlength);
         Py_XDECREF(a[i].pObject);
+        Py_XDECREF(a[i].pChunk);
     }
     PyMem_Free(a);
 }
@@ -595,7 +872,7 @@ static bool GetUnicodeInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Param
 
     info.ValueType = enc.ctype;
 
-    Object encoded(PyCodec_Encode(param, enc.name, "strict"));
+    Object encoded(enc.Encode(param));
     if (!encoded)
         return false;
 
@@ -850,11 +1127,8 @@ static char* CreateDecimalString(long sign, PyObject* digits, long exp)
     return pch;
 }
 
-static bool GetUUIDInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, PyObject* uuid_type)
+static bool GetUUIDInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
 {
-    // uuid_type: This is a new reference that we are responsible for freeing.
-    Object tmp(uuid_type);
-
     info.ValueType = SQL_C_GUID;
     info.ParameterType = SQL_GUID;
     info.ColumnSize = 16;
@@ -877,11 +1151,8 @@ static bool GetUUIDInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInf
 }
 
 
-static bool GetDecimalInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, PyObject* decimal_type)
+static bool GetDecimalInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
 {
-    // decimal_type: This is a new reference that we are responsible for freeing.
-    Object tmp(decimal_type);
-
     // The NUMERIC structure never works right with SQL Server and probably a lot of other drivers.  We'll bind as a
     // string.  Unfortunately, the Decimal class doesn't seem to have a way to force it to return a string without
     // exponents, so we'll have to build it ourselves.
@@ -967,6 +1238,210 @@ static bool GetByteArrayInfo(Cursor* cur, Py_ssize_t index, PyObject* param, Par
 }
 
 
+static bool GetStreamInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, bool isTVP)
+{
+    // A file-like object with readinto or an iterator of chunks, which is read and sent with
+    // SQLPutData during the execute so the data is never all in memory.  File-like objects are
+    // binary.  Iterators are text if their first chunk is a str, so it is read now.
+
+    if (isTVP)
+    {
+        RaiseErrorV(0, ProgrammingError, "File-like objects and iterators cannot be used in table-valued parameters.");
+        return false;
+    }
+
+    bool text = false;
+    if (!PyObject_HasAttrString(param, "readinto"))
+    {
+        info.pChunk = PyIter_Next(param);
+        if (!info.pChunk && PyErr_Occurred())
+            return false;
+        text = info.pChunk && PyUnicode_Check(info.pChunk);
+    }
+
+    if (text)
+    {
+        info.ValueType     = cur->cnxn->unicode_enc.ctype;
+        info.ParameterType = (info.ValueType == SQL_C_CHAR) ? SQL_LONGVARCHAR : SQL_WLONGVARCHAR;
+        info.ColumnSize    = STREAM_TEXT_SIZE;
+    }
+    else
+    {
+        info.ValueType     = SQL_C_BINARY;
+        info.ParameterType = SQL_LONGVARBINARY;
+        info.ColumnSize    = STREAM_BINARY_SIZE;
+    }
+
+    // The length isn't known, so drivers that want it are told zero.
+    info.StrLen_or_Ind     = cur->cnxn->need_long_data_len ? SQL_LEN_DATA_AT_EXEC(0) : SQL_DATA_AT_EXEC;
+    info.ParameterValuePtr = &info;
+    info.BufferLength      = sizeof(ParamInfo*);
+    info.pObject           = param;
+    Py_INCREF(info.pObject);
+    info.maxlength         = cur->cnxn->GetMaxLength(info.ValueType);
+    info.stream            = true;
+
+    return true;
+}
+
+
+bool IsStreamParameter(PyObject* param)
+{
+    // Returns true if param is a file-like object or an iterator that GetStreamInfo accepts.
+    // Only call this for objects that aren't one of the other parameter types.
+
+    return PyIter_Check(param) || PyObject_HasAttrString(param, "readinto");
+}
+
+
+static bool PutChunk(Cursor* cur, const char* pb, Py_ssize_t cb, SQLLEN maxlength)
+{
+    // Sends cb bytes with SQLPutData, at most maxlength bytes at a time if it is not zero.
+
+    Py_ssize_t offset = 0;
+    do
+    {
+        SQLLEN cbPut = (SQLLEN)(cb - offset);
+        if (maxlength > 0)
+            cbPut = min(cbPut, maxlength);
+
+        SQLRETURN ret;
+        Py_BEGIN_ALLOW_THREADS
+        ret = SQLPutData(cur->hstmt, (SQLPOINTER)(pb + offset), cbPut);
+        Py_END_ALLOW_THREADS
+        if (!SQL_SUCCEEDED(ret))
+        {
+            RaiseErrorFromHandle(cur->cnxn, "SQLPutData", cur->cnxn->hdbc, cur->hstmt);
+            return false;
+        }
+        offset += cbPut;
+    }
+    while (offset < cb);
+
+    return true;
+}
+
+
+bool PutStreamData(Cursor* cur, PyObject* stream, PyObject* first, SQLSMALLINT ctype, SQLLEN maxlength)
+{
+    // Sends the data of a stream parameter after SQLParamData asks for it.
+    //
+    // first
+    //   The chunk GetStreamInfo already read from an iterator, or zero.
+    //
+    // File-like objects are read into one buffer that is reused for each chunk.  Iterators must
+    // produce str chunks for text parameters, which are encoded with the connection's unicode
+    // encoding, or bytes-like chunks for binary parameters.
+    //
+    // Returns false if an error occurs, in which case an exception is set.
+
+    // An empty value still needs one SQLPutData call or the driver may treat it as NULL.
+    bool empty = true;
+
+    if (PyObject_HasAttrString(stream, "readinto"))
+    {
+        Object buffer(PyByteArray_FromStringAndSize(0, STREAM_CHUNK_SIZE));
+        if (!buffer)
+            return false;
+
+        for (;;)
+        {
+            Object result(PyObject_CallMethod(stream, "readinto", "O", buffer.Get()));
+            if (!result)
+                return false;
+            if (result.Get() == Py_None)
+            {
+                RaiseErrorV(0, ProgrammingError, "The stream parameter is non-blocking and has no data available.");
+                return false;
+            }
+            Py_ssize_t cb = PyNumber_AsSsize_t(result, PyExc_OverflowError);
+            if (cb == -1 && PyErr_Occurred())
+                return false;
+            if (cb < 0 || cb > STREAM_CHUNK_SIZE)
+            {
+                PyErr_Format(PyExc_ValueError, "readinto returned an invalid length: %zd", cb);
+                return false;
+            }
+            if (cb == 0)
+                break;
+            if (!PutChunk(cur, PyByteArray_AS_STRING(buffer.Get()), cb, maxlength))
+                return false;
+            empty = false;
+        }
+    }
+    else
+    {
+        for (;;)
+        {
+            Object chunk;
+            if (first)
+            {
+                Py_INCREF(first);
+                chunk.Attach(first);
+                first = 0;
+            }
+            else
+            {
+                chunk.Attach(PyIter_Next(stream));
+            }
+
+            if (!chunk)
+            {
+                if (PyErr_Occurred())
+                    return false;
+                break;
+            }
+
+            if (PyUnicode_Check(chunk))
+            {
+                if (ctype == SQL_C_BINARY)
+                {
+                    PyErr_SetString(PyExc_TypeError, "A binary stream parameter produced a str chunk.");
+                    return false;
+                }
+                Object encoded(cur->cnxn->unicode_enc.Encode(chunk));
+                if (!encoded)
+                    return false;
+                if (!PyBytes_Check(encoded))
+                {
+                    PyErr_Format(PyExc_TypeError, "Unicode write encoding '%s' returned unexpected data type: %s",
+                                 cur->cnxn->unicode_enc.name, Py_TYPE(encoded.Get())->tp_name);
+                    return false;
+                }
+                if (PyBytes_GET_SIZE(encoded) == 0)
+                    continue;
+                if (!PutChunk(cur, PyBytes_AS_STRING(encoded.Get()), PyBytes_GET_SIZE(encoded), maxlength))
+                    return false;
+            }
+            else
+            {
+                if (ctype != SQL_C_BINARY)
+                {
+                    PyErr_Format(PyExc_TypeError, "A text stream parameter produced a %s chunk.", Py_TYPE(chunk.Get())->tp_name);
+                    return false;
+                }
+                Py_buffer view;
+                if (PyObject_GetBuffer(chunk, &view, PyBUF_SIMPLE) != 0)
+                    return false;
+                bool success = (view.len == 0) || PutChunk(cur, (const char*)view.buf, view.len, maxlength);
+                Py_ssize_t cb = view.len;
+                PyBuffer_Release(&view);
+                if (!success)
+                    return false;
+                if (cb == 0)
+                    continue;
+            }
+            empty = false;
+        }
+    }
+
+    if (empty && !PutChunk(cur, "", 0, maxlength))
+        return false;
+
+    return true;
+}
+
+
 // TVP
 static bool GetTableInfo(Cursor *cur, Py_ssize_t index, PyObject* param, ParamInfo& info)
 {
@@ -1022,54 +1497,41 @@ bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo&
     //
     // Populates `info`.
 
-    if (param == Py_None)
+    switch (GetParamKind(param))
+    {
+    case PK_NONE:
         return GetNullInfo(cur, index, info);
-
-    if (param == null_binary)
+    case PK_NULL_BINARY:
         return GetNullBinaryInfo(cur, index, info);
-
-    if (PyBytes_Check(param))
+    case PK_BYTES:
         return GetBytesInfo(cur, index, param, info, isTVP);
-
-    if (PyUnicode_Check(param))
+    case PK_UNICODE:
         return GetUnicodeInfo(cur, index, param, info, isTVP);
-
-    if (PyBool_Check(param))
+    case PK_BOOL:
         return GetBooleanInfo(cur, index, param, info);
-
-    if (PyDateTime_Check(param))
+    case PK_DATETIME:
         return GetDateTimeInfo(cur, index, param, info);
-
-    if (PyDate_Check(param))
+    case PK_DATE:
         return GetDateInfo(cur, index, param, info);
-
-    if (PyTime_Check(param))
+    case PK_TIME:
         return GetTimeInfo(cur, index, param, info);
-
-    if (PyLong_Check(param))
+    case PK_LONG:
         return GetLongInfo(cur, index, param, info, isTVP);
-
-    if (PyFloat_Check(param))
+    case PK_FLOAT:
         return GetFloatInfo(cur, index, param, info);
-
-    if (PyByteArray_Check(param))
+    case PK_BYTEARRAY:
         return GetByteArrayInfo(cur, index, param, info, isTVP);
-
-    PyObject* cls = 0;
-    if (!IsInstanceForThread(param, "decimal", "Decimal", &cls))
-        return false;
-
-    if (cls != 0)
-        return GetDecimalInfo(cur, index, param, info, cls);
-
-    if (!IsInstanceForThread(param, "uuid", "UUID", &cls))
-        return false;
-
-    if (cls != 0)
-        return GetUUIDInfo(cur, index, param, info, cls);
-
-    if (PySequence_Check(param))
+    case PK_DECIMAL:
+        return GetDecimalInfo(cur, index, param, info);
+    case PK_UUID:
+        return GetUUIDInfo(cur, index, param, info);
+    case PK_STREAM:
+        return GetStreamInfo(cur, index, param, info, isTVP);
+    case PK_SEQUENCE:
         return GetTableInfo(cur, index, param, info);
+    case PK_ERROR:
+        return false;
+    }
 
     RaiseErrorV("HY105", ProgrammingError, "Invalid parameter type.  param-index=%zd param-type=%s", index, Py_TYPE(param)->tp_name);
     return false;
@@ -1340,11 +1802,15 @@ void FreeParameterInfo(Cursor* cur)
 {
     // Internal function to free just the cached parameter information.  This is not used by the general cursor code
     // since this information is also freed in the less granular free_results function that clears everything.
+    //
+    // The saved result set columns belong to the prepared statement too, so they are freed here as well.
 
     Py_XDECREF(cur->pPreparedSQL);
-    PyMem_Free(cur->paramtypes);
+    PyMem_Free(cur->paramdescs);
+    FreeResultInfo(cur->resultinfo);
     cur->pPreparedSQL = 0;
-    cur->paramtypes   = 0;
+    cur->paramdescs   = 0;
+    cur->resultinfo   = 0;
     cur->paramcount   = 0;
 }
 
@@ -1353,8 +1819,19 @@ bool Prepare(Cursor* cur, PyObject* pSql)
     //
     // Prepare the SQL if necessary.
     //
-    if (pSql != cur->pPreparedSQL)
+    if (!IsPrepared(cur, pSql))
     {
+        if (cur->cnxn->stmtcache_size > 0 && !cur->noscan)
+        {
+            // Keep the statement prepared for the previous SQL in the connection's cache and
+            // take one already prepared for this SQL if there is one.
+            bool found;
+            if (!SwapCachedStatement(cur, pSql, found))
+                return false;
+            if (found)
+                return true;
+        }
+
         FreeParameterInfo(cur);
 
         SQLRETURN ret = 0;
@@ -1466,12 +1943,73 @@ bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* original_params, bool
 }
 
 
-bool ExecuteMulti(Cursor* cur, PyObject* pSql, PyObject* paramArrayObj)
+static bool DescribeParams(Cursor* cur, Py_ssize_t iFirst, Py_ssize_t iLast)
 {
-    bool ret = true;
-    char *szLastFunction = 0;
-    SQLRETURN rc = SQL_SUCCESS;
-    if (!Prepare(cur, pSql))
+    // Ensures parameters iFirst through iLast-1 of the prepared statement are described in
+    // cur->paramdescs.  SQLDescribeParam is a round trip to the server for some drivers, so
+    // each parameter is described once and the GIL is released while describing.
+
+    if (cur->paramdescs == 0)
+    {
+        cur->paramdescs = (ParamDesc*)PyMem_Malloc(sizeof(ParamDesc) * cur->paramcount);
+        if (cur->paramdescs == 0)
+        {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        // SQL_UNKNOWN_TYPE is zero, so zero out all parameters since we haven't described any yet.
+        memset(cur->paramdescs, 0, sizeof(ParamDesc) * cur->paramcount);
+    }
+
+    Py_ssize_t i = iFirst;
+    while (i < iLast && cur->paramdescs[i].ParameterType != SQL_UNKNOWN_TYPE)
+        i++;
+    if (i == iLast)
+        return true;
+
+    HSTMT hstmt = cur->hstmt;
+    ParamDesc* descs = cur->paramdescs;
+
+    Py_BEGIN_ALLOW_THREADS
+    for (; i < iLast; i++)
+    {
+        ParamDesc& desc = descs[i];
+        if (desc.ParameterType != SQL_UNKNOWN_TYPE)
+            continue;
+
+        SQLSMALLINT nullable;
+        if (!SQL_SUCCEEDED(SQLDescribeParam(hstmt, (SQLUSMALLINT)(i + 1), &desc.ParameterType, &desc.ColumnSize,
+                                            &desc.DecimalDigits, &nullable)) ||
+            desc.ParameterType == SQL_UNKNOWN_TYPE)
+        {
+            // This can happen with ("select ?", None).  Default to a medium-length varchar, which works with most
+            // types.
+            desc.ParameterType = SQL_VARCHAR;
+            desc.ColumnSize    = 255;
+            desc.DecimalDigits = 0;
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool DescribeMultiParams(Cursor* cur)
+{
+    // Allocates cur->paramInfos and describes each parameter (SQL type) in preparation for
+    // allocation of the parameter array.  The descriptions are kept with the prepared
+    // statement, so repeated calls with the same SQL don't describe again.
+
+    if (cur->paramcount > 0 && !DescribeParams(cur, 0, cur->paramcount))
         return false;
 
     if (!(cur->paramInfos = (ParamInfo*)PyMem_Malloc(sizeof(ParamInfo) * cur->paramcount)))
@@ -1481,325 +2019,850 @@ bool ExecuteMulti(Cursor* cur, PyObject* pSql, PyObject* paramArrayObj)
     }
     memset(cur->paramInfos, 0, sizeof(ParamInfo) * cur->paramcount);
 
-    // Wouldn't hurt to free threads here?  Or is this fast enough because it is local?
-
-  // Describe each parameter (SQL type) in preparation for allocation of paramset array
     for (Py_ssize_t i = 0; i < cur->paramcount; i++)
     {
-        SQLSMALLINT nullable;
-        if (!SQL_SUCCEEDED(SQLDescribeParam(cur->hstmt, i + 1, &(cur->paramInfos[i].ParameterType),
-            &cur->paramInfos[i].ColumnSize, &cur->paramInfos[i].DecimalDigits,
-            &nullable)))
-        {
-            // Default to a medium-length varchar if describing the parameter didn't work
-            cur->paramInfos[i].ParameterType = SQL_VARCHAR;
-            cur->paramInfos[i].ColumnSize = 255;
-            cur->paramInfos[i].DecimalDigits = 0;
-        }
+        cur->paramInfos[i].ParameterType = cur->paramdescs[i].ParameterType;
+        cur->paramInfos[i].ColumnSize    = cur->paramdescs[i].ColumnSize;
+        cur->paramInfos[i].DecimalDigits = cur->paramdescs[i].DecimalDigits;
 
-    // This supports overriding of input sizes via setinputsizes
-    // See issue 380
-    // The logic is duplicated from BindParameter
-    UpdateParamInfo(cur, i, &cur->paramInfos[i]);
-  }
+        // This supports overriding of input sizes via setinputsizes
+        // See issue 380
+        // The logic is duplicated from BindParameter
+        UpdateParamInfo(cur, i, &cur->paramInfos[i]);
+    }
+
+    return true;
+}
+
+
+static PyObject* NextParamRow(Cursor* cur, PyObject* iter)
+{
+    // Returns the next row of parameters from the iterator as a new reference to a list or
+    // tuple.  Returns zero at the end of the iterator or on error, so check PyErr_Occurred.
 
-    PyObject *rowseq = PySequence_Fast(paramArrayObj, "Parameter array must be a sequence.");
-    if (!rowseq)
+    Object row(PyIter_Next(iter));
+    if (!row)
+        return 0;
+
+    if (!PyTuple_Check(row) && !PyList_Check(row) && !Row_Check(row))
     {
-    ErrorRet1:
-        if (cur->paramInfos)
-            FreeInfos(cur->paramInfos, cur->paramcount);
-        cur->paramInfos = 0;
-        return false;
+        RaiseErrorV(0, PyExc_TypeError, "Params must be in a list, tuple, or Row");
+        return 0;
     }
-    Py_ssize_t rowcount = PySequence_Fast_GET_SIZE(rowseq);
-    PyObject **rowptr = PySequence_Fast_ITEMS(rowseq);
 
-    Py_ssize_t r = 0;
-    while ( r < rowcount )
+    PyObject* colseq = PySequence_Fast(row, "Row must be a sequence.");
+    if (colseq && PySequence_Fast_GET_SIZE(colseq) != cur->paramcount)
     {
-        // Scan current row to determine C types
-        PyObject *currow = *rowptr++;
-        // REVIEW: This check is not needed - PySequence_Fast below is sufficient.
-        if (!PyTuple_Check(currow) && !PyList_Check(currow) && !Row_Check(currow))
-        {
-            RaiseErrorV(0, PyExc_TypeError, "Params must be in a list, tuple, or Row");
-        ErrorRet2:
-            Py_XDECREF(rowseq);
-            goto ErrorRet1;
-        }
-        PyObject *colseq = PySequence_Fast(currow, "Row must be a sequence.");
-        if (!colseq)
+        RaiseErrorV(0, ProgrammingError, "Expected %d parameters, supplied %zd", (int)cur->paramcount,
+                    PySequence_Fast_GET_SIZE(colseq));
+        Py_DECREF(colseq);
+        return 0;
+    }
+    return colseq;
+}
+
+
+// The number of rows scanned to size the inline buffers of (max) parameters.
+static const Py_ssize_t INLINE_SCAN_ROWS = 1000;
+
+
+static Py_ssize_t MaxEncodedLength(Cursor* cur, PyObject* cell)
+{
+    // Returns an upper bound on the number of bytes PyToCType writes for a text or binary
+    // value, or zero for other types.
+
+    if (PyBytes_Check(cell))
+        return PyBytes_GET_SIZE(cell);
+    if (PyByteArray_Check(cell))
+        return PyByteArray_GET_SIZE(cell);
+    if (!PyUnicode_Check(cell))
+        return 0;
+
+    Py_ssize_t cch = PyUnicode_GET_LENGTH(cell);
+    int kind = PyUnicode_KIND(cell);
+
+    switch (cur->cnxn->unicode_enc.optenc)
+    {
+    case OPTENC_UTF16LE:
+    case OPTENC_UTF16BE:
+        // Only characters outside the BMP, which need a 4-byte kind, take two code units.
+        return cch * (kind == PyUnicode_4BYTE_KIND ? 4 : 2);
+    case OPTENC_UTF16:
+        // Plus the BOM.
+        return cch * (kind == PyUnicode_4BYTE_KIND ? 4 : 2) + 2;
+    case OPTENC_UTF8:
+        if (PyUnicode_IS_ASCII(cell))
+            return cch;
+        return cch * (kind + 1);
+    case OPTENC_LATIN1:
+        return cch;
+    }
+    return cch * 4 + 4;
+}
+
+
+static SQLLEN GetInlineLength(Cursor* cur, Py_ssize_t iParam, PyObject* rows, Py_ssize_t iRow)
+{
+    // Returns the number of bytes to reserve in the parameter array for a (max) parameter's
+    // values.  This is fast_executemany_max_inline, but if the rows are in a list or tuple, the
+    // next rows are scanned and it is reduced to the longest value found so short values don't
+    // waste space.  Values that turn out to be longer are sent with SQLPutData.
+    //
+    // rows
+    //   The list or tuple being executed, or zero if the rows come from an iterator.
+    //
+    // iRow
+    //   The index in `rows` of the row the parameters are being bound for.
+
+    if (cur->fastexecmany_max_inline <= 0)
+        return 0;
+
+    SQLLEN cbLimit = (SQLLEN)cur->fastexecmany_max_inline;
+    if (!rows)
+        return cbLimit;
+
+    SQLLEN cbMax = 0;
+    Py_ssize_t cRows = PySequence_Fast_GET_SIZE(rows);
+    Py_ssize_t iEnd = min(cRows, iRow + INLINE_SCAN_ROWS);
+
+    for (Py_ssize_t i = iRow; i < iEnd && cbMax < cbLimit; i++)
+    {
+        PyObject* row = PySequence_Fast_GET_ITEM(rows, i);
+        if (!PyTuple_Check(row) && !PyList_Check(row))
+            return cbLimit;
+        if (iParam >= PySequence_Fast_GET_SIZE(row))
+            break;
+        cbMax = max(cbMax, (SQLLEN)MaxEncodedLength(cur, PySequence_Fast_GET_ITEM(row, iParam)));
+    }
+
+    // Keep at least one byte so the values that fit in the DAEParam space are still inline.
+    return max(min(cbMax, cbLimit), (SQLLEN)1);
+}
+
+
+static bool BindMultiParams(Cursor* cur, PyObject** cells, PyObject* rows, Py_ssize_t iRow, Py_ssize_t& rowlen)
+{
+    // Determines the C types from a row of parameters and binds them row-wise.  Sets rowlen to
+    // the number of bytes each row needs in the parameter array.
+    //
+    // rows, iRow
+    //   The list or tuple of rows and the index of this row in it, used to size the buffers of
+    //   (max) parameters.  `rows` is zero if the rows come from an iterator.
+
+    // REVIEW: We need a better description of what is going on here.  Why is it OK to pass
+    // a fake bindptr to SQLBindParameter.
+
+    // Start at a non-zero offset to prevent null pointer detection.
+    char *bindptr = (char*)16;
+
+    for (Py_ssize_t i = 0; i < cur->paramcount; i++)
+    {
+        if (cur->paramInfos[i].ColumnSize == 0)
+            cur->paramInfos[i].cbInline = GetInlineLength(cur, i, rows, iRow);
+
+        if (!DetectCType(cells[i], &cur->paramInfos[i]))
+            return false;
+
+        if (!SQL_SUCCEEDED(SQLBindParameter(cur->hstmt, i + 1, SQL_PARAM_INPUT, cur->paramInfos[i].ValueType,
+            cur->paramInfos[i].ParameterType, cur->paramInfos[i].ColumnSize, cur->paramInfos[i].DecimalDigits,
+            bindptr, cur->paramInfos[i].BufferLength, (SQLLEN*)(bindptr + cur->paramInfos[i].BufferLength))))
         {
-            goto ErrorRet2;
+            RaiseErrorFromHandle(cur->cnxn, "SQLBindParameter", GetConnection(cur)->hdbc, cur->hstmt);
+            return false;
         }
-        if (PySequence_Fast_GET_SIZE(colseq) != cur->paramcount)
+        if (cur->paramInfos[i].ValueType == SQL_C_NUMERIC)
         {
-            RaiseErrorV(0, ProgrammingError, "Expected %u parameters, supplied %u", cur->paramcount, PySequence_Fast_GET_SIZE(colseq));
-        ErrorRet3:
-            Py_XDECREF(colseq);
-            goto ErrorRet2;
+            SQLHDESC desc;
+            SQLGetStmtAttr(cur->hstmt, SQL_ATTR_APP_PARAM_DESC, &desc, 0, 0);
+            SQLSetDescField(desc, i + 1, SQL_DESC_TYPE, (SQLPOINTER)SQL_C_NUMERIC, 0);
+            SQLSetDescField(desc, i + 1, SQL_DESC_PRECISION, (SQLPOINTER)cur->paramInfos[i].ColumnSize, 0);
+            SQLSetDescField(desc, i + 1, SQL_DESC_SCALE, (SQLPOINTER)(uintptr_t)cur->paramInfos[i].DecimalDigits, 0);
+            SQLSetDescField(desc, i + 1, SQL_DESC_DATA_PTR, bindptr, 0);
         }
-        PyObject **cells = PySequence_Fast_ITEMS(colseq);
+        bindptr += cur->paramInfos[i].BufferLength + sizeof(SQLLEN);
+    }
+
+    rowlen = bindptr - (char*)16;
+    return true;
+}
+
+
+static bool PutMultiDAEParams(Cursor* cur, SQLRETURN& rc)
+{
+    // One or more parameters were too long to bind normally so we set the length to
+    // SQL_LEN_DATA_AT_EXEC.  ODBC will return SQL_NEED_DATA for each of the parameters we did
+    // this for.
+    //
+    // For each one we set a pointer to the DAEParam as the "parameter data" we can access with
+    // SQLParamData.  We've stashed everything we need in there.  The cells are released by
+    // ReleaseDAEParams after the batch is finished.
+    //
+    // Returns false if an exception was raised sending the data.  Otherwise `rc` is set to the
+    // result of the final SQLParamData call, which the caller checks.
 
-        // REVIEW: We need a better description of what is going on here.  Why is it OK to pass
-        // a fake bindptr to SQLBindParameter.
+    while (rc == SQL_NEED_DATA)
+    {
+        DAEParam *pInfo;
+        Py_BEGIN_ALLOW_THREADS
+        rc = SQLParamData(cur->hstmt, (SQLPOINTER*)&pInfo);
+        Py_END_ALLOW_THREADS
 
-        // Start at a non-zero offset to prevent null pointer detection.
-        char *bindptr = (char*)16;
+        TRACE("SQLParamData() --> %d\n", rc);
 
-        Py_ssize_t i = 0;
-        for (; i < cur->paramcount; i++)
+        if (rc == SQL_NEED_DATA)
         {
-            if (!DetectCType(cells[i], &cur->paramInfos[i]))
+            PyObject* objCell = pInfo->cell;
+
+            // If the object is Unicode it needs to be converted into bytes before it can be used by SQLPutData
+            if (PyUnicode_Check(objCell))
             {
-                goto ErrorRet3;
+                const TextEnc& enc = cur->cnxn->sqlwchar_enc;
+                PyObject* bytes = NULL;
+
+                switch (enc.optenc)
+                {
+                case OPTENC_UTF8:
+                    bytes = PyUnicode_AsUTF8String(objCell);
+                    break;
+                case OPTENC_UTF16:
+                    bytes = PyUnicode_AsUTF16String(objCell);
+                    break;
+                case OPTENC_UTF16LE:
+                    bytes = PyUnicode_AsEncodedString(objCell, "utf_16_le", NULL);
+                    break;
+                case OPTENC_UTF16BE:
+                    bytes = PyUnicode_AsEncodedString(objCell, "utf_16_be", NULL);
+                    break;
+                }
+                if (bytes && PyBytes_Check(bytes))
+                {
+                    objCell = bytes;
+                }
+                //TODO: Raise or clear error when bytes == NULL.
             }
 
-            if (!SQL_SUCCEEDED(SQLBindParameter(cur->hstmt, i + 1, SQL_PARAM_INPUT, cur->paramInfos[i].ValueType,
-                cur->paramInfos[i].ParameterType, cur->paramInfos[i].ColumnSize, cur->paramInfos[i].DecimalDigits,
-                bindptr, cur->paramInfos[i].BufferLength, (SQLLEN*)(bindptr + cur->paramInfos[i].BufferLength))))
+            if (PyBytes_Check(objCell) || PyByteArray_Check(objCell))
             {
-                RaiseErrorFromHandle(cur->cnxn, "SQLBindParameter", GetConnection(cur)->hdbc, cur->hstmt);
-            ErrorRet4:
-                SQLFreeStmt(cur->hstmt, SQL_RESET_PARAMS);
-                goto ErrorRet3;
+                char *(*pGetPtr)(PyObject*);
+                Py_ssize_t (*pGetLen)(PyObject*);
+                if (PyByteArray_Check(objCell))
+                {
+                    pGetPtr = PyByteArray_AsString;
+                    pGetLen = PyByteArray_Size;
+                }
+                else
+                {
+                    pGetPtr = PyBytes_AsString;
+                    pGetLen = PyBytes_Size;
+                }
+
+                const char* p = pGetPtr(objCell);
+                SQLLEN cb = (SQLLEN)pGetLen(objCell);
+                SQLLEN offset = 0;
+
+                do
+                {
+                    SQLLEN remaining = min(pInfo->maxlen, cb - offset);
+                    TRACE("SQLPutData [%d] (%d) %.10s\n", offset, remaining, &p[offset]);
+
+                    Py_BEGIN_ALLOW_THREADS
+                    rc = SQLPutData(cur->hstmt, (SQLPOINTER)&p[offset], remaining);
+                    Py_END_ALLOW_THREADS
+                    if (!SQL_SUCCEEDED(rc))
+                        return RaiseErrorFromHandle(cur->cnxn, "SQLPutData", cur->cnxn->hdbc, cur->hstmt) != NULL;
+                    offset += remaining;
+                }
+                while (offset < cb);
+
+                if (PyUnicode_Check(pInfo->cell) && PyBytes_Check(objCell))
+                {
+                    Py_XDECREF(objCell);
+                }
             }
-            if (cur->paramInfos[i].ValueType == SQL_C_NUMERIC)
+            else if (IsStreamParameter(objCell))
             {
-                SQLHDESC desc;
-                SQLGetStmtAttr(cur->hstmt, SQL_ATTR_APP_PARAM_DESC, &desc, 0, 0);
-                SQLSetDescField(desc, i + 1, SQL_DESC_TYPE, (SQLPOINTER)SQL_C_NUMERIC, 0);
-                SQLSetDescField(desc, i + 1, SQL_DESC_PRECISION, (SQLPOINTER)cur->paramInfos[i].ColumnSize, 0);
-                SQLSetDescField(desc, i + 1, SQL_DESC_SCALE, (SQLPOINTER)(uintptr_t)cur->paramInfos[i].DecimalDigits, 0);
-                SQLSetDescField(desc, i + 1, SQL_DESC_DATA_PTR, bindptr, 0);
+                if (!PutStreamData(cur, objCell, 0, pInfo->ctype, pInfo->maxlen))
+                    return false;
             }
-            bindptr += cur->paramInfos[i].BufferLength + sizeof(SQLLEN);
+            rc = SQL_NEED_DATA;
         }
+    }
+
+    return true;
+}
+
+
+static void ResetParamArrayAttrs(Cursor* cur)
+{
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, SQL_IS_UINTEGER);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_OFFSET_PTR, 0, SQL_IS_POINTER);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_TYPE, SQL_BIND_BY_COLUMN, SQL_IS_UINTEGER);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_STATUS_PTR, 0, SQL_IS_POINTER);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, 0, SQL_IS_POINTER);
+}
+
+
+struct PendingExecute
+{
+    // A batch of the parameter array that has been executed, possibly still running on a helper
+    // thread so the next batch can be converted at the same time.
+
+    SQLHSTMT hstmt;
+    SQLRETURN rc;
+
+    bool running;
+    // True if the helper thread has been started and FinishParamArray hasn't waited for it.
+
+    PyThread_type_lock done;
+    // Held while the helper thread is executing.  Zero if the lock couldn't be allocated, in
+    // which case batches are executed synchronously.
 
-        Py_ssize_t rowlen = bindptr - (char*)16;
-        // Assume parameters are homogeneous between rows in the common case, to avoid
-        // another rescan for determining the array height.
-        // Subtract number of rows processed as an upper bound.
-        if (!(cur->paramArray = (unsigned char*)PyMem_Malloc(rowlen * (rowcount - r))))
+    SQLULEN bop;
+    // The SQL_ATTR_PARAM_BIND_OFFSET_PTR value for the batch.  The driver reads this during the
+    // execute so it must not change until the batch is finished.
+
+    SQLULEN cProcessed;
+    // The SQL_ATTR_PARAMS_PROCESSED_PTR value: the number of rows the driver processed.
+
+    unsigned char* paramArray;
+    Py_ssize_t rowlen;
+    Py_ssize_t cRows;
+    // The rows of the batch.
+
+    Py_ssize_t iFirstRow;
+    Py_ssize_t cExecRows;
+    // The index in the input of the first row being executed and the number of rows.  These
+    // are the whole batch unless the driver stopped at a failed row and the rest are being
+    // executed.
+
+    Py_ssize_t cStatusAlloc;
+    // The number of elements allocated for cur->param_status.
+
+    bool schema_changed;
+    // Set if the execute failed because the statement no longer matches its tables.  Checked
+    // once the parameters are freed, since that clears the diagnostic records.
+};
+
+
+static void ExecuteParamArrayThread(void* p)
+{
+    // The helper thread started by StartParamArray.  This must not touch any Python objects.
+
+    PendingExecute* pending = (PendingExecute*)p;
+    pending->rc = SQLExecute(pending->hstmt);
+    PyThread_release_lock(pending->done);
+}
+
+
+static void ReleaseDAEParams(Cursor* cur, PendingExecute& pending)
+{
+    // Releases the cells referenced by the DAEParams in the batch's rows.  They are kept until
+    // the batch is finished so the rows can be executed again if the driver stops at a failed
+    // row.
+
+    Py_ssize_t offset = 0;
+    for (int i = 0; i < cur->paramcount; i++)
+    {
+        const ParamInfo& info = cur->paramInfos[i];
+        if (info.ColumnSize == 0)
+        {
+            for (Py_ssize_t iRow = 0; iRow < pending.cRows; iRow++)
+            {
+                unsigned char* pElement = pending.paramArray + iRow * pending.rowlen + offset;
+                SQLLEN ind = *(SQLLEN*)(pElement + info.BufferLength);
+                if (ind == SQL_DATA_AT_EXEC || ind <= SQL_LEN_DATA_AT_EXEC_OFFSET)
+                    Py_CLEAR(((DAEParam*)pElement)->cell);
+            }
+        }
+        offset += info.BufferLength + sizeof(SQLLEN);
+    }
+    pending.cRows = 0;
+}
+
+
+static bool SetParamArrayRows(Cursor* cur, PendingExecute& pending)
+{
+    // Points the statement at the rows to execute, pending.cExecRows rows starting at
+    // pending.iFirstRow, and their elements of the status array.
+
+    SQLUSMALLINT* pStatus = cur->param_status + pending.iFirstRow;
+    Py_ssize_t iBatchRow = pending.cRows - pending.cExecRows;
+
+    // The parameters were bound relative to address 16 (see BindMultiParams), so this offset
+    // makes them point into the array.
+    pending.bop = (SQLULEN)(pending.paramArray + iBatchRow * pending.rowlen) - 16;
+    pending.cProcessed = 0;
+
+    if (!SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER)pending.rowlen, SQL_IS_UINTEGER)) ||
+        !SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)pending.cExecRows, SQL_IS_UINTEGER)) ||
+        !SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_OFFSET_PTR, (SQLPOINTER)&pending.bop, SQL_IS_POINTER)))
+    {
+        RaiseErrorFromHandle(cur->cnxn, "SQLSetStmtAttr", GetConnection(cur)->hdbc, cur->hstmt);
+        ResetParamArrayAttrs(cur);
+        return false;
+    }
+
+    // Not all drivers report these, so failures are ignored.  The statuses are initialized to
+    // SQL_PARAM_DIAG_UNAVAILABLE for them.
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_STATUS_PTR, (SQLPOINTER)pStatus, SQL_IS_POINTER);
+    SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, (SQLPOINTER)&pending.cProcessed, SQL_IS_POINTER);
+
+    return true;
+}
+
+
+static bool StartParamArray(Cursor* cur, PendingExecute& pending, unsigned char* paramArray, Py_ssize_t rowlen,
+                            Py_ssize_t cRows, Py_ssize_t iFirstRow, bool async)
+{
+    // Executes the prepared statement for the first cRows rows of paramArray, which were converted
+    // using the current bindings.  iFirstRow is the index of the first one in the input.  If
+    // async is true the execute runs on a helper thread and the caller must not use the
+    // statement or paramArray until it calls FinishParamArray.
+
+    pending.paramArray = paramArray;
+    pending.rowlen = rowlen;
+    pending.cRows = cRows;
+    pending.iFirstRow = iFirstRow;
+    pending.cExecRows = cRows;
+
+    if (iFirstRow + cRows > pending.cStatusAlloc)
+    {
+        Py_ssize_t cAlloc = max(iFirstRow + cRows, pending.cStatusAlloc * 2);
+        SQLUSMALLINT* pNew = (SQLUSMALLINT*)PyMem_Realloc(cur->param_status, sizeof(SQLUSMALLINT) * (size_t)cAlloc);
+        if (!pNew)
         {
             PyErr_NoMemory();
-            goto ErrorRet4;
+            ReleaseDAEParams(cur, pending);
+            return false;
         }
+        cur->param_status = pNew;
+        pending.cStatusAlloc = cAlloc;
+    }
+    for (Py_ssize_t i = iFirstRow; i < iFirstRow + cRows; i++)
+        cur->param_status[i] = SQL_PARAM_DIAG_UNAVAILABLE;
+    cur->param_status_count = iFirstRow + cRows;
 
-        unsigned char *pParamDat = cur->paramArray;
-        Py_ssize_t rows_converted = 0;
+    if (!SetParamArrayRows(cur, pending))
+    {
+        ReleaseDAEParams(cur, pending);
+        return false;
+    }
 
-        ParamInfo *pi;
-        for (;;)
+    pending.hstmt = cur->hstmt;
+
+    if (async && pending.done)
+    {
+        PyThread_acquire_lock(pending.done, WAIT_LOCK);
+        if (PyThread_start_new_thread(ExecuteParamArrayThread, &pending) != PYTHREAD_INVALID_THREAD_ID)
+        {
+            pending.running = true;
+            return true;
+        }
+        // Couldn't start a thread, so just execute it here.
+        PyThread_release_lock(pending.done);
+    }
+
+    SQLRETURN rc;
+    Py_BEGIN_ALLOW_THREADS
+    rc = SQLExecute(cur->hstmt);
+    Py_END_ALLOW_THREADS
+    pending.rc = rc;
+    return true;
+}
+
+
+static void WaitParamArray(PendingExecute& pending)
+{
+    if (pending.running)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(pending.done, WAIT_LOCK);
+        PyThread_release_lock(pending.done);
+        Py_END_ALLOW_THREADS
+        pending.running = false;
+    }
+}
+
+
+static bool AddParamMessages(Cursor* cur, PendingExecute& pending)
+{
+    // Appends the statement's diagnostic records to param_messages with the index of the row of
+    // parameters each is for.
+
+    for (SQLSMALLINT iRecord = 1; ; iRecord++)
+    {
+        Object msg(GetDiagRec(cur, iRecord));
+        if (!msg)
+            return !PyErr_Occurred();
+
+        SQLLEN iRow = SQL_NO_ROW_NUMBER;
+        if (!SQL_SUCCEEDED(SQLGetDiagField(SQL_HANDLE_STMT, cur->hstmt, iRecord, SQL_DIAG_ROW_NUMBER, &iRow, 0, 0)))
+            iRow = SQL_NO_ROW_NUMBER;
+
+        // The driver's row numbers are 1-based and relative to the rows executed.
+        Object row;
+        if (iRow > 0)
+            row.Attach(PyLong_FromSsize_t(pending.iFirstRow + (Py_ssize_t)iRow - 1));
+        else
+        {
+            Py_INCREF(Py_None);
+            row.Attach(Py_None);
+        }
+        if (!row)
+            return false;
+
+        Object entry(Py_BuildValue("(OOO)", row.Get(), PyTuple_GET_ITEM(msg.Get(), 0), PyTuple_GET_ITEM(msg.Get(), 1)));
+        if (!entry || PyList_Append(cur->param_messages, entry) == -1)
+            return false;
+    }
+}
+
+
+static bool FinishParamArray(Cursor* cur, PendingExecute& pending, SQLLEN& rowcount)
+{
+    // Waits for the batch started by StartParamArray, sends any data-at-execution parameters,
+    // and adds the number of rows affected to rowcount, or sets it to -1 if the driver doesn't
+    // know.
+    //
+    // If fast_executemany_continue_on_error is set, failed rows don't raise an error.  Some
+    // drivers execute the rest of the rows after one fails but others stop, so the rows after
+    // the ones the driver processed are executed again.
+
+    WaitParamArray(pending);
+
+    SQLRETURN rc = pending.rc;
+    const char* szFunction = "SQLExecute";
+    bool success = false;
+
+    if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread while the batch was executing.  MS ODBC
+        // will crash if we use the HSTMT now, so don't reset anything.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        ReleaseDAEParams(cur, pending);
+        return false;
+    }
+
+    for (;;)
+    {
+        if (rc == SQL_NEED_DATA)
         {
-            // Column loop.
-            pi = &cur->paramInfos[0];
-            for (int c = 0; c < cur->paramcount; c++, pi++)
+            szFunction = "SQLParamData";
+            if (!PutMultiDAEParams(cur, rc))
             {
-                if (!PyToCType(cur, &pParamDat, *cells++, pi))
+                // Cancel the execute so the statement isn't left waiting for data.
+                if (cur->cnxn->hdbc != SQL_NULL_HANDLE)
                 {
-                    // "schema change" or conversion error. Try again on next batch.
-                    rowptr--;
-                    Py_XDECREF(colseq);
-                    colseq = 0;
-                    // Finish this batch of rows and attempt to execute before starting another.
-                    goto DoExecute;
+                    Py_BEGIN_ALLOW_THREADS
+                    SQLCancel(cur->hstmt);
+                    Py_END_ALLOW_THREADS
                 }
+                goto done;
             }
-            rows_converted++;
-            Py_XDECREF(colseq);
-            colseq = 0;
-            r++;
-            if ( r >= rowcount )
-            {
-                break;
-            }
-            currow = *rowptr++;
-            colseq = PySequence_Fast(currow, "Row must be a sequence.");
-            if (!colseq)
-            {
-            ErrorRet5:
-                PyMem_Free(cur->paramArray);
-                cur->paramArray = 0;
-                goto ErrorRet4;
-            }
-            if (PySequence_Fast_GET_SIZE(colseq) != cur->paramcount)
-            {
-                RaiseErrorV(0, ProgrammingError, "Expected %u parameters, supplied %u", cur->paramcount, PySequence_Fast_GET_SIZE(colseq));
-                Py_XDECREF(colseq);
-                goto ErrorRet5;
-            }
-            cells = PySequence_Fast_ITEMS(colseq);
-        }
-    DoExecute:
-        if (!rows_converted || PyErr_Occurred())
-        {
-            if (!PyErr_Occurred())
-                RaiseErrorV(0, ProgrammingError, "No suitable conversion for one or more parameters.");
-            goto ErrorRet5;
         }
 
-        SQLULEN bop = (SQLULEN)(cur->paramArray) - 16;
-        if (!SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_TYPE, (SQLPOINTER)rowlen, SQL_IS_UINTEGER)))
+        bool failed = !SQL_SUCCEEDED(rc) && rc != SQL_NO_DATA;
+
+        if (rc != SQL_SUCCESS && rc != SQL_NO_DATA && !AddParamMessages(cur, pending))
+            goto done;
+
+        if (failed && (!cur->fastexecmany_continue || pending.cProcessed == 0))
         {
-            RaiseErrorFromHandle(cur->cnxn, "SQLSetStmtAttr", GetConnection(cur)->hdbc, cur->hstmt);
-        ErrorRet6:
-            SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_TYPE, SQL_BIND_BY_COLUMN, SQL_IS_UINTEGER);
-            goto ErrorRet5;
+            // If the driver didn't process any rows, the statement itself failed.
+            RaiseErrorFromHandle(cur->cnxn, szFunction, cur->cnxn->hdbc, cur->hstmt);
+            pending.schema_changed = IsSchemaChangeError(cur->hstmt);
+            goto done;
         }
-        if (!SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)rows_converted, SQL_IS_UINTEGER)))
+
+        if (rc != SQL_SUCCESS)
         {
-            RaiseErrorFromHandle(cur->cnxn, "SQLSetStmtAttr", GetConnection(cur)->hdbc, cur->hstmt);
-            goto ErrorRet6;
+            GetDiagRecs(cur);
         }
-        if (!SQL_SUCCEEDED(SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_OFFSET_PTR, (SQLPOINTER)&bop, SQL_IS_POINTER)))
+
+        if (rowcount != -1)
         {
-            RaiseErrorFromHandle(cur->cnxn, "SQLSetStmtAttr", GetConnection(cur)->hdbc, cur->hstmt);
-        ErrorRet7:
-            SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, SQL_IS_UINTEGER);
-            goto ErrorRet6;
+            SQLLEN cAffected = -1;
+            if (!SQL_SUCCEEDED(SQLRowCount(cur->hstmt, &cAffected)) || cAffected < 0)
+                rowcount = -1;
+            else
+                rowcount += cAffected;
         }
 
-        // The code below was copy-pasted from cursor.cpp's execute() for convenience.
-        // TODO: REFACTOR if there is possibility to reuse (maybe not, because DAE structure is different)
+        if (!failed || pending.cProcessed >= (SQLULEN)pending.cExecRows)
+            break;
+
+        // The driver stopped at a failed row, so execute the rest.
+        pending.iFirstRow += (Py_ssize_t)pending.cProcessed;
+        pending.cExecRows -= (Py_ssize_t)pending.cProcessed;
+        if (!SetParamArrayRows(cur, pending))
+            goto done;
+
+        szFunction = "SQLExecute";
         Py_BEGIN_ALLOW_THREADS
         rc = SQLExecute(cur->hstmt);
         Py_END_ALLOW_THREADS
 
         if (cur->cnxn->hdbc == SQL_NULL_HANDLE)
         {
-            // The connection was closed by another thread in the ALLOW_THREADS block above.
             RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
-        ErrorRet8:
-            FreeParameterData(cur);
-            SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_OFFSET_PTR, 0, SQL_IS_POINTER);
-            goto ErrorRet7;
+            ReleaseDAEParams(cur, pending);
+            return false;
         }
+    }
 
-        if (!SQL_SUCCEEDED(rc) && rc != SQL_NEED_DATA && rc != SQL_NO_DATA)
-        {
-            // We could try dropping through the while and if below, but if there is an error, we need to raise it before
-            // FreeParameterData calls more ODBC functions.
-            RaiseErrorFromHandle(cur->cnxn, "SQLExecute", cur->cnxn->hdbc, cur->hstmt);
-            goto ErrorRet8;
-        }
+    success = true;
 
-        if (rc == SQL_SUCCESS_WITH_INFO)
-        {
-            GetDiagRecs(cur);
-        }
+  done:
+    ReleaseDAEParams(cur, pending);
+    ResetParamArrayAttrs(cur);
+    return success;
+}
 
-        // TODO: Refactor into ProcessDAEParams() ?
-        while (rc == SQL_NEED_DATA)
-        {
-            // One or more parameters were too long to bind normally so we set the
-            // length to SQL_LEN_DATA_AT_EXEC.  ODBC will return SQL_NEED_DATA for
-            // each of the parameters we did this for.
-            //
-            // For each one we set a pointer to the ParamInfo as the "parameter
-            // data" we can access with SQLParamData.  We've stashed everything we
-            // need in there.
-
-            szLastFunction = "SQLParamData";
-            DAEParam *pInfo;
-            Py_BEGIN_ALLOW_THREADS
-            rc = SQLParamData(cur->hstmt, (SQLPOINTER*)&pInfo);
-            Py_END_ALLOW_THREADS
 
-            if (rc != SQL_NEED_DATA && rc != SQL_NO_DATA && !SQL_SUCCEEDED(rc))
-                return RaiseErrorFromHandle(cur->cnxn, "SQLParamData", cur->cnxn->hdbc, cur->hstmt) != NULL;
+static void AbandonParamArray(Cursor* cur, PendingExecute& pending)
+{
+    // Called on errors to wait for a batch that is still running without reporting its result,
+    // since an exception has already been raised.
 
-            TRACE("SQLParamData() --> %d\n", rc);
+    if (!pending.running)
+        return;
+
+    WaitParamArray(pending);
+
+    if (cur->cnxn->hdbc != SQL_NULL_HANDLE)
+    {
+        if (pending.rc == SQL_NEED_DATA)
+            SQLCancel(cur->hstmt);
+        ResetParamArrayAttrs(cur);
+    }
+    ReleaseDAEParams(cur, pending);
+}
+
+
+static Py_ssize_t GetBatchRows(Cursor* cur, Py_ssize_t rowlen)
+{
+    // Returns the maximum number of rows to convert and execute at a time with the current
+    // bindings, or 0 if there is no limit.
+
+    Py_ssize_t cRows = max(cur->fastexecmany_batch_rows, (Py_ssize_t)0);
+    if (cur->fastexecmany_batch_bytes > 0)
+    {
+        Py_ssize_t cFit = max(cur->fastexecmany_batch_bytes / max(rowlen, (Py_ssize_t)1), (Py_ssize_t)1);
+        cRows = cRows ? min(cRows, cFit) : cFit;
+    }
+    return cRows;
+}
 
-            if (rc == SQL_NEED_DATA)
-            {
-                PyObject* objCell = pInfo->cell;
 
-                // If the object is Unicode it needs to be converted into bytes before it can be used by SQLPutData
-                if (PyUnicode_Check(objCell))
+static bool ReserveParamArray(unsigned char*& paramArray, size_t cb, size_t& cbAlloc)
+{
+    if (cb <= cbAlloc)
+        return true;
+
+    unsigned char* pNew = (unsigned char*)PyMem_Realloc(paramArray, cb);
+    if (!pNew)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+    paramArray = pNew;
+    cbAlloc = cb;
+    return true;
+}
+
+
+bool ExecuteMulti(Cursor* cur, PyObject* pSql, PyObject* paramArrayObj)
+{
+    // Executes pSql for each row of parameters in paramArrayObj, which can be any iterable.
+    //
+    // The C types are determined from the first row and the rows are converted into the
+    // parameter array until a row needs different types, at which point the converted rows are
+    // executed and the parameters are rebound using that row.  The rows are also executed in
+    // batches limited by fast_executemany_batch_rows and fast_executemany_batch_bytes so the
+    // memory used is bounded.
+    //
+    // There are two arrays.  While one batch is executing on a helper thread, the next is
+    // converted into the other array, so a load takes about as long as the slower of the two
+    // instead of their sum.
+
+    if (!Prepare(cur, pSql))
+        return false;
+
+    if (!DescribeMultiParams(cur))
+        return false;
+
+    bool success = false;
+    SQLLEN rowcount = 0;
+    size_t cbAlloc = 0;
+    Object colseq;
+
+    // The index in the input of the first row of the next batch.
+    Py_ssize_t cRowsExecuted = 0;
+
+    // The array not being converted into, which the pending batch (if any) is using.
+    unsigned char* pSpare = 0;
+    size_t cbSpare = 0;
+
+    PendingExecute pending;
+    memset(&pending, 0, sizeof(pending));
+    pending.done = PyThread_allocate_lock();
+
+    // The number of rows left, if known, to avoid allocating more than the whole input needs.
+    Py_ssize_t cRemaining = PyObject_LengthHint(paramArrayObj, 0);
+
+    // If the rows are in a list or tuple, they are scanned ahead to size (max) parameters.
+    PyObject* rows = (PyList_Check(paramArrayObj) || PyTuple_Check(paramArrayObj)) ? paramArrayObj : 0;
+    Py_ssize_t cRowsRead = 0;
+
+    Object iter(PyObject_GetIter(paramArrayObj));
+    if (cRemaining < 0 || !iter)
+        goto done;
+
+    PyMem_Free(cur->param_status);
+    cur->param_status = 0;
+    cur->param_status_count = 0;
+    Py_XDECREF(cur->param_messages);
+    cur->param_messages = PyList_New(0);
+    if (!cur->param_messages)
+        goto done;
+
+    colseq.Attach(NextParamRow(cur, iter));
+    cRowsRead = 1;
+
+    while (colseq)
+    {
+        // Bind using the types of the current row.
+
+        Py_ssize_t rowlen;
+        if (!BindMultiParams(cur, PySequence_Fast_ITEMS(colseq.Get()), rows, cRowsRead - 1, rowlen))
+            goto done;
+
+        Py_ssize_t cBatch = GetBatchRows(cur, rowlen);
+
+        // Allocate enough for the rest of the rows if we know how many there are, otherwise
+        // start small and grow.  Either way, not more than a batch.
+        Py_ssize_t cInitial = (cRemaining > 0) ? cRemaining : 1024;
+        if (cBatch)
+            cInitial = min(cInitial, cBatch);
+        if (!ReserveParamArray(cur->paramArray, (size_t)rowlen * (size_t)cInitial, cbAlloc))
+            goto done;
+
+        bool rebind = false;
+
+        // True until a batch has been converted with these bindings.
+        bool fresh = true;
+
+        while (colseq && !rebind)
+        {
+            // Convert up to a batch of rows and execute them.
+
+            unsigned char *pParamDat = cur->paramArray;
+            Py_ssize_t rows_converted = 0;
+
+            while (colseq && (cBatch == 0 || rows_converted < cBatch))
+            {
+                if ((size_t)rowlen * (size_t)(rows_converted + 1) > cbAlloc)
                 {
-                    const TextEnc& enc = cur->cnxn->sqlwchar_enc;
-                    PyObject* bytes = NULL;
+                    Py_ssize_t cAlloc = max((Py_ssize_t)(cbAlloc / (size_t)max(rowlen, (Py_ssize_t)1)) * 2, cInitial);
+                    if (cBatch)
+                        cAlloc = min(cAlloc, cBatch);
+                    if (!ReserveParamArray(cur->paramArray, (size_t)rowlen * (size_t)cAlloc, cbAlloc))
+                        goto done;
+                    pParamDat = cur->paramArray + rowlen * rows_converted;
+                }
 
-                    switch (enc.optenc)
+                PyObject** cells = PySequence_Fast_ITEMS(colseq.Get());
+                ParamInfo *pi = &cur->paramInfos[0];
+                for (int c = 0; c < cur->paramcount; c++, pi++)
+                {
+                    if (!PyToCType(cur, &pParamDat, *cells++, pi))
                     {
-                    case OPTENC_UTF8:
-                        bytes = PyUnicode_AsUTF8String(objCell);
-                        break;
-                    case OPTENC_UTF16:
-                        bytes = PyUnicode_AsUTF16String(objCell);
-                        break;
-                    case OPTENC_UTF16LE:
-                        bytes = PyUnicode_AsEncodedString(objCell, "utf_16_le", NULL);
+                        // "schema change" or conversion error.  Finish this batch of rows and
+                        // rebind using the current row.
+                        rebind = true;
                         break;
-                    case OPTENC_UTF16BE:
-                        bytes = PyUnicode_AsEncodedString(objCell, "utf_16_be", NULL);
-                        break;
-                    }
-                    if (bytes && PyBytes_Check(bytes))
-                    {
-                        objCell = bytes;
                     }
-                    //TODO: Raise or clear error when bytes == NULL.
                 }
+                if (rebind)
+                    break;
 
-                szLastFunction = "SQLPutData";
-                if (PyBytes_Check(objCell) || PyByteArray_Check(objCell))
-                {
-                    char *(*pGetPtr)(PyObject*);
-                    Py_ssize_t (*pGetLen)(PyObject*);
-                    if (PyByteArray_Check(objCell))
-                    {
-                        pGetPtr = PyByteArray_AsString;
-                        pGetLen = PyByteArray_Size;
-                    }
-                    else
-                    {
-                        pGetPtr = PyBytes_AsString;
-                        pGetLen = PyBytes_Size;
-                    }
+                rows_converted++;
+                if (cRemaining > 0)
+                    cRemaining--;
 
-                    const char* p = pGetPtr(objCell);
-                    SQLLEN cb = (SQLLEN)pGetLen(objCell);
-                    SQLLEN offset = 0;
+                colseq.Attach(NextParamRow(cur, iter));
+                cRowsRead++;
+                if (!colseq && PyErr_Occurred())
+                    goto done;
+            }
 
-                    do
-                    {
-                        SQLLEN remaining = min(pInfo->maxlen, cb - offset);
-                        TRACE("SQLPutData [%d] (%d) %.10s\n", offset, remaining, &p[offset]);
-
-                        Py_BEGIN_ALLOW_THREADS
-                        rc = SQLPutData(cur->hstmt, (SQLPOINTER)&p[offset], remaining);
-                        Py_END_ALLOW_THREADS
-                        if (!SQL_SUCCEEDED(rc))
-                            return RaiseErrorFromHandle(cur->cnxn, "SQLPutData", cur->cnxn->hdbc, cur->hstmt) != NULL;
-                        offset += remaining;
-                    }
-                    while (offset < cb);
+            if (PyErr_Occurred())
+                goto done;
 
-                    if (PyUnicode_Check(pInfo->cell) && PyBytes_Check(objCell))
-                    {
-                        Py_XDECREF(objCell);
-                    }
+            if (!rows_converted)
+            {
+                // A row that can't be converted right after rebinding using it can't be
+                // converted at all.  Otherwise a batch just ended before a row that needs
+                // different types.
+                if (fresh)
+                {
+                    RaiseErrorV(0, ProgrammingError, "No suitable conversion for one or more parameters.");
+                    goto done;
                 }
-                Py_XDECREF(pInfo->cell);
-                rc = SQL_NEED_DATA;
+
+                // The bindings can't change until the previous batch finishes with them.
+                if (pending.running && !FinishParamArray(cur, pending, rowcount))
+                    goto done;
+                break;
             }
+            fresh = false;
+
+            // The previous batch must finish before the statement can be executed again.
+            if (pending.running && !FinishParamArray(cur, pending, rowcount))
+                goto done;
+
+            // Only execute in the background if there are more rows to convert with the same
+            // bindings.  Rebinding requires the statement.
+            bool async = colseq && !rebind;
+
+            if (!StartParamArray(cur, pending, cur->paramArray, rowlen, rows_converted, cRowsExecuted, async))
+                goto done;
+            cRowsExecuted += rows_converted;
+
+            if (!async && !FinishParamArray(cur, pending, rowcount))
+                goto done;
+
+            // Convert the next batch into the other array.
+            unsigned char* pT = cur->paramArray;
+            cur->paramArray = pSpare;
+            pSpare = pT;
+            size_t cbT = cbAlloc;
+            cbAlloc = cbSpare;
+            cbSpare = cbT;
         }
 
-        if (!SQL_SUCCEEDED(rc) && rc != SQL_NO_DATA)
-            return RaiseErrorFromHandle(cur->cnxn, szLastFunction, cur->cnxn->hdbc, cur->hstmt) != NULL;
-
-        SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER)1, SQL_IS_UINTEGER);
-        SQLSetStmtAttr(cur->hstmt, SQL_ATTR_PARAM_BIND_OFFSET_PTR, 0, SQL_IS_POINTER);
-        PyMem_Free(cur->paramArray);
-        cur->paramArray = 0;
+        if (colseq)
+            SQLFreeStmt(cur->hstmt, SQL_RESET_PARAMS);
     }
 
-    Py_XDECREF(rowseq);
+    if (PyErr_Occurred())
+        goto done;
+
+    cur->rowcount = (int)rowcount;
+    success = true;
+
+  done:
+    AbandonParamArray(cur, pending);
+    if (pending.done)
+        PyThread_free_lock(pending.done);
+
+    PyMem_Free(cur->paramArray);
+    cur->paramArray = 0;
+    PyMem_Free(pSpare);
     FreeParameterData(cur);
-  return ret;
+    if (pending.schema_changed)
+        InvalidatePrepared(cur);
+    return success;
 }
 
 
@@ -1820,38 +2883,10 @@ static bool GetParamType(Cursor* cur, Py_ssize_t index, SQLSMALLINT& type)
         return true;
     }
 
-    if (cur->paramtypes == 0)
-    {
-        cur->paramtypes = reinterpret_cast<SQLSMALLINT*>(PyMem_Malloc(sizeof(SQLSMALLINT) * cur->paramcount));
-        if (cur->paramtypes == 0)
-        {
-            PyErr_NoMemory();
-            return false;
-        }
-
-        // SQL_UNKNOWN_TYPE is zero, so zero out all columns since we haven't looked any up yet.
-        memset(cur->paramtypes, 0, sizeof(SQLSMALLINT) * cur->paramcount);
-    }
-
-    if (cur->paramtypes[index] == SQL_UNKNOWN_TYPE)
-    {
-        SQLULEN ParameterSizePtr;
-        SQLSMALLINT DecimalDigitsPtr;
-        SQLSMALLINT NullablePtr;
-        SQLRETURN ret;
-
-        Py_BEGIN_ALLOW_THREADS
-        ret = SQLDescribeParam(cur->hstmt, (SQLUSMALLINT)(index + 1), &cur->paramtypes[index], &ParameterSizePtr, &DecimalDigitsPtr, &NullablePtr);
-        Py_END_ALLOW_THREADS
-
-        if (!SQL_SUCCEEDED(ret))
-        {
-            // This can happen with ("select ?", None).  We'll default to VARCHAR which works with most types.
-            cur->paramtypes[index] = SQL_VARCHAR;
-        }
-    }
+    if (!DescribeParams(cur, index, index + 1))
+        return false;
 
-    type = cur->paramtypes[index];
+    type = cur->paramdescs[index].ParameterType;
     return true;
 }
 
@@ -1898,5 +2933,9 @@ bool Params_init()
 
     PyDateTime_IMPORT;
 
+    paramkinds_key = PyUnicode_InternFromString("pyodbc.paramkinds");
+    if (!paramkinds_key)
+        return false;
+
     return true;
 }
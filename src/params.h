@@ -4,12 +4,21 @@
 
 bool Params_init();
 
+// The default for Cursor.fast_executemany_batch_bytes.
+#define FAST_EXECUTEMANY_BATCH_BYTES (32 * 1024 * 1024)
+
+// The default for Cursor.fast_executemany_max_inline.
+#define FAST_EXECUTEMANY_MAX_INLINE 8000
+
 struct Cursor;
 
+bool Prepare(Cursor* cur, PyObject* pSql);
 bool PrepareAndBind(Cursor* cur, PyObject* pSql, PyObject* params, bool skip_first);
 bool ExecuteMulti(Cursor* cur, PyObject* pSql, PyObject* paramArrayObj);
 bool GetParameterInfo(Cursor* cur, Py_ssize_t index, PyObject* param, ParamInfo& info, bool isTVP);
 void FreeParameterData(Cursor* cur);
 void FreeParameterInfo(Cursor* cur);
+bool IsStreamParameter(PyObject* param);
+bool PutStreamData(Cursor* cur, PyObject* stream, PyObject* first, SQLSMALLINT ctype, SQLLEN maxlength);
 
 #endif
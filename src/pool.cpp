@@ -0,0 +1,708 @@
+// Implements pyodbc.Pool, which keeps open connections for one connection string and lends them
+// out so each use doesn't pay for a new login.
+//
+// Idle connections are kept on a stack.  The most recently returned, and most likely to still be
+// alive, is lent first, and those at the bottom are the first closed when they have been idle
+// too long.  A returned connection is rolled back and reset, then moved into a new Connection
+// object by Connection_Recycle so the borrower's references to it are left closed.
+//
+// All of the pool's fields are protected by the GIL.  It is released while connecting, probing
+// connections, and waiting for one to be returned, so the counts must be checked again after
+// each of those.
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "connection.h"
+#include "errors.h"
+#include "pool.h"
+#include <time.h>
+
+struct IdleConnection
+{
+    Connection* cnxn;
+    double since;
+    // When the connection was returned, from Now().
+};
+
+struct Pool
+{
+    PyObject_HEAD
+
+    PyObject* connstring;
+    bool autocommit;
+    bool readonly;
+    long timeout;
+    PyObject* attrs_before;
+    PyObject* encoding;
+    // The arguments passed to Connection_New.  attrs_before and encoding may be zero.
+
+    PyObject* info;
+    // The CnxnInfo of the first connection, or zero.  It is passed to Connection_New so the
+    // other connections don't look it up again.
+
+    int minsize;
+    int maxsize;
+    double max_idle;
+    // Zero if idle connections are never closed.
+
+    IdleConnection* idle;
+    int cIdle;
+    // A stack of maxsize entries, the most recently returned last.
+
+    int cBusy;
+    // The number of connections lent out plus those being opened or probed.  cIdle + cBusy is
+    // never more than maxsize.
+
+    bool closed;
+
+    PyThread_type_lock wakeup;
+    int waiting;
+    bool signaled;
+    // Threads waiting in acquire() block on `wakeup`, which is held unless `signaled` is true.
+    // When a connection is returned while there are waiters, it is released to wake one.
+};
+
+// The most threads used to open the minimum number of connections when the pool is created.
+static const int MAX_PREWARM_THREADS = 8;
+
+
+static double Now()
+{
+    // Returns a monotonic time in seconds.
+#ifdef _MSC_VER
+    return (double)GetTickCount64() / 1000;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+
+static void Signal(Pool* pool)
+{
+    // Wakes one thread waiting in acquire(), if there are any.
+    if (pool->waiting > 0 && !pool->signaled)
+    {
+        pool->signaled = true;
+        PyThread_release_lock(pool->wakeup);
+    }
+}
+
+
+static PyObject* Connect(Pool* pool)
+{
+    PyObject* info = pool->info;
+    Py_XINCREF(info);
+
+    Py_XINCREF(pool->attrs_before); // Connection_New steals this.
+    PyObject* cnxn = Connection_New(pool->connstring, pool->autocommit, pool->timeout, pool->readonly,
+                                    pool->attrs_before, pool->encoding, &info);
+
+    // Other threads may have connected while the GIL was released, so only keep the first.
+    if (pool->info == 0 && info != 0)
+        pool->info = info;
+    else
+        Py_XDECREF(info);
+
+    return cnxn;
+}
+
+
+static bool IsAlive(Connection* cnxn)
+{
+    // A cheap check for connections the driver already knows are broken, which doesn't go to
+    // the server.  Drivers that don't support SQL_ATTR_CONNECTION_DEAD are assumed to be alive.
+
+    SQLUINTEGER dead = SQL_CD_FALSE;
+    SQLRETURN ret;
+    HDBC hdbc = cnxn->hdbc;
+    Py_BEGIN_ALLOW_THREADS
+    ret = SQLGetConnectAttr(hdbc, SQL_ATTR_CONNECTION_DEAD, &dead, SQL_IS_UINTEGER, 0);
+    Py_END_ALLOW_THREADS
+
+    return !SQL_SUCCEEDED(ret) || dead != SQL_CD_TRUE;
+}
+
+
+static PyObject* Lend(Pool* pool, Connection* cnxn)
+{
+    // Gives a connection, already counted in cBusy, to the caller.
+
+    Py_INCREF(pool);
+    cnxn->pool = (PyObject*)pool;
+
+    // If several connections were returned before a waiter woke, wake another.
+    if (pool->cIdle > 0 || pool->cIdle + pool->cBusy < pool->maxsize)
+        Signal(pool);
+
+    return (PyObject*)cnxn;
+}
+
+
+static void EvictIdle(Pool* pool)
+{
+    // Closes connections, oldest first, that have been idle longer than max_idle while the pool
+    // has more than minsize.
+
+    if (pool->max_idle <= 0)
+        return;
+
+    double cutoff = Now() - pool->max_idle;
+
+    while (pool->cIdle > 0 && pool->cIdle + pool->cBusy > pool->minsize && pool->idle[0].since <= cutoff)
+    {
+        Connection* cnxn = pool->idle[0].cnxn;
+        pool->cIdle--;
+        memmove(&pool->idle[0], &pool->idle[1], sizeof(IdleConnection) * (size_t)pool->cIdle);
+        Py_DECREF(cnxn);
+    }
+}
+
+
+static void CloseIdle(Pool* pool)
+{
+    while (pool->cIdle > 0)
+    {
+        pool->cIdle--;
+        Py_DECREF(pool->idle[pool->cIdle].cnxn);
+    }
+}
+
+
+void Pool_Return(Connection* cnxn)
+{
+    Pool* pool = (Pool*)cnxn->pool;
+    cnxn->pool = 0;
+
+    // This is called from Connection_dealloc, possibly while an exception is being raised.
+    PyObject* type;
+    PyObject* value;
+    PyObject* tb;
+    PyErr_Fetch(&type, &value, &tb);
+
+    Connection* fresh = pool->closed ? 0 : Connection_Recycle(cnxn, pool->autocommit);
+
+    pool->cBusy--;
+
+    if (fresh && !pool->closed)
+    {
+        pool->idle[pool->cIdle].cnxn  = fresh;
+        pool->idle[pool->cIdle].since = Now();
+        pool->cIdle++;
+    }
+    else
+    {
+        // Either the connection can't be reused, in which case the caller closes it, or the pool
+        // was closed while it was being reset.
+        Py_XDECREF(fresh);
+    }
+
+    Signal(pool);
+
+    Py_DECREF(pool);
+    PyErr_Restore(type, value, tb);
+}
+
+
+struct Prewarm
+{
+    Pool* pool;
+
+    int remaining;
+    // The number of connections not yet started.
+
+    int running;
+    // The number of threads that have not finished.  The last releases `done`.
+
+    PyThread_type_lock done;
+
+    PyObject* type;
+    PyObject* value;
+    PyObject* tb;
+    // The first error, if any.
+};
+
+
+static void PrewarmThread(void* p)
+{
+    Prewarm* prewarm = (Prewarm*)p;
+    Pool* pool = prewarm->pool;
+
+    PyGILState_STATE state = PyGILState_Ensure();
+
+    while (prewarm->remaining > 0 && prewarm->type == 0)
+    {
+        prewarm->remaining--;
+
+        pool->cBusy++;
+        PyObject* cnxn = Connect(pool);
+        pool->cBusy--;
+
+        if (cnxn)
+        {
+            pool->idle[pool->cIdle].cnxn  = (Connection*)cnxn;
+            pool->idle[pool->cIdle].since = Now();
+            pool->cIdle++;
+        }
+        else if (prewarm->type == 0)
+        {
+            PyErr_Fetch(&prewarm->type, &prewarm->value, &prewarm->tb);
+        }
+        else
+        {
+            PyErr_Clear();
+        }
+    }
+
+    // The thread waiting on `done` needs the GIL to continue, so `prewarm` stays valid until the
+    // GIL is released below.
+    if (--prewarm->running == 0)
+        PyThread_release_lock(prewarm->done);
+
+    PyGILState_Release(state);
+}
+
+
+static bool PrewarmPool(Pool* pool)
+{
+    // Opens minsize connections using several threads.  Each holds the GIL except while
+    // connecting, so the logins overlap.
+
+    Prewarm prewarm;
+    prewarm.pool      = pool;
+    prewarm.remaining = pool->minsize;
+    prewarm.running   = 0;
+    prewarm.type      = 0;
+    prewarm.value     = 0;
+    prewarm.tb        = 0;
+
+    prewarm.done = PyThread_allocate_lock();
+    if (!prewarm.done)
+    {
+        PyErr_NoMemory();
+        return false;
+    }
+    PyThread_acquire_lock(prewarm.done, WAIT_LOCK);
+
+    // The threads can't start connecting until this thread releases the GIL, so `running` can
+    // be counted as they are started.
+    int threads = min(pool->minsize, MAX_PREWARM_THREADS);
+    for (int i = 0; i < threads; i++)
+    {
+        if (PyThread_start_new_thread(PrewarmThread, &prewarm) == PYTHREAD_INVALID_THREAD_ID)
+            break;
+        prewarm.running++;
+    }
+
+    if (prewarm.running == 0)
+    {
+        // No threads could be started, so connect on this one.
+        prewarm.running = 1;
+        PrewarmThread(&prewarm);
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(prewarm.done, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+
+    PyThread_free_lock(prewarm.done);
+
+    if (prewarm.type)
+    {
+        PyErr_Restore(prewarm.type, prewarm.value, prewarm.tb);
+        return false;
+    }
+
+    return true;
+}
+
+
+static void Pool_dealloc(PyObject* self)
+{
+    Pool* pool = (Pool*)self;
+
+    pool->closed = true;
+    if (pool->idle)
+        CloseIdle(pool);
+    PyMem_Free(pool->idle);
+
+    if (pool->wakeup)
+    {
+        if (!pool->signaled)
+            PyThread_release_lock(pool->wakeup);
+        PyThread_free_lock(pool->wakeup);
+    }
+
+    Py_XDECREF(pool->connstring);
+    Py_XDECREF(pool->attrs_before);
+    Py_XDECREF(pool->encoding);
+    Py_XDECREF(pool->info);
+
+    PyObject_Del(self);
+}
+
+
+static PyObject* Pool_new(PyTypeObject* type, PyObject* args, PyObject* kwargs)
+{
+    static const char* kwlist[] = { "connstring", "min", "max", "max_idle", "autocommit", "readonly", "timeout",
+                                    "attrs_before", "encoding", 0 };
+
+    PyObject* connstring   = 0;
+    int minsize            = 0;
+    int maxsize            = 10;
+    double max_idle        = 600;
+    int autocommit         = 0;
+    int readonly           = 0;
+    long timeout           = 0;
+    PyObject* attrs_before = 0;
+    PyObject* encoding     = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "U|ii$dpplOO", (char**)kwlist, &connstring, &minsize, &maxsize,
+                                     &max_idle, &autocommit, &readonly, &timeout, &attrs_before, &encoding))
+        return 0;
+
+    if (maxsize < 1)
+    {
+        PyErr_SetString(PyExc_ValueError, "max must be at least 1");
+        return 0;
+    }
+
+    if (minsize < 0 || minsize > maxsize)
+    {
+        PyErr_SetString(PyExc_ValueError, "min must be between zero and max");
+        return 0;
+    }
+
+    if (max_idle < 0)
+    {
+        PyErr_SetString(PyExc_ValueError, "max_idle cannot be negative");
+        return 0;
+    }
+
+    if (encoding == Py_None)
+        encoding = 0;
+    if (encoding && !PyUnicode_Check(encoding))
+    {
+        PyErr_SetString(PyExc_TypeError, "encoding must be a string");
+        return 0;
+    }
+
+    Object attrs;
+    if (attrs_before && attrs_before != Py_None)
+    {
+        if (!PyDict_Check(attrs_before))
+        {
+            PyErr_SetString(PyExc_TypeError, "attrs_before must be a dictionary");
+            return 0;
+        }
+        attrs.Attach(CheckAttrsDict(attrs_before));
+        if (PyErr_Occurred())
+            return 0;
+    }
+
+    if (henv == SQL_NULL_HANDLE && !AllocateEnv())
+        return 0;
+
+    Pool* pool = PyObject_NEW(Pool, type);
+    if (!pool)
+        return 0;
+
+    Py_INCREF(connstring);
+    Py_XINCREF(encoding);
+
+    pool->connstring   = connstring;
+    pool->autocommit   = autocommit != 0;
+    pool->readonly     = readonly != 0;
+    pool->timeout      = timeout;
+    pool->attrs_before = attrs.Detach();
+    pool->encoding     = encoding;
+    pool->info         = 0;
+    pool->minsize      = minsize;
+    pool->maxsize      = maxsize;
+    pool->max_idle     = max_idle;
+    pool->idle         = PyMem_New(IdleConnection, (size_t)maxsize);
+    pool->cIdle        = 0;
+    pool->cBusy        = 0;
+    pool->closed       = false;
+    pool->wakeup       = PyThread_allocate_lock();
+    pool->waiting      = 0;
+    pool->signaled     = false;
+
+    if (pool->wakeup)
+        PyThread_acquire_lock(pool->wakeup, WAIT_LOCK);
+
+    Object result((PyObject*)pool);
+
+    if (!pool->idle || !pool->wakeup)
+        return PyErr_NoMemory();
+
+    if (minsize > 0 && !PrewarmPool(pool))
+        return 0;
+
+    return result.Detach();
+}
+
+
+static char acquire_doc[] =
+    "acquire(timeout=None) --> Connection\n"
+    "\n"
+    "Returns an idle connection from the pool or, if all are in use and the pool has\n"
+    "fewer than `max`, opens a new one.  Otherwise this waits for a connection to be\n"
+    "returned.  If `timeout` is not None and no connection is available within that\n"
+    "many seconds, an OperationalError is raised.\n"
+    "\n"
+    "Closing the connection, or using it as a context manager, returns it.";
+
+static PyObject* Pool_acquire(PyObject* self, PyObject* args, PyObject* kwargs)
+{
+    static const char* kwlist[] = { "timeout", 0 };
+
+    PyObject* pTimeout = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", (char**)kwlist, &pTimeout))
+        return 0;
+
+    double deadline = -1; // wait forever
+    if (pTimeout != Py_None)
+    {
+        double seconds = PyFloat_AsDouble(pTimeout);
+        if (seconds == -1 && PyErr_Occurred())
+            return 0;
+        if (seconds < 0)
+        {
+            PyErr_SetString(PyExc_ValueError, "timeout cannot be negative");
+            return 0;
+        }
+        deadline = Now() + seconds;
+    }
+
+    Pool* pool = (Pool*)self;
+
+    for (;;)
+    {
+        if (pool->closed)
+        {
+            // Wake the next waiter so it sees the pool is closed too.
+            Signal(pool);
+            PyErr_SetString(ProgrammingError, "Attempt to use a closed pool.");
+            return 0;
+        }
+
+        EvictIdle(pool);
+
+        while (pool->cIdle > 0)
+        {
+            pool->cIdle--;
+            Connection* cnxn = pool->idle[pool->cIdle].cnxn;
+
+            pool->cBusy++;
+            if (IsAlive(cnxn))
+                return Lend(pool, cnxn);
+            pool->cBusy--;
+
+            Py_DECREF(cnxn);
+        }
+
+        if (pool->cIdle + pool->cBusy < pool->maxsize)
+        {
+            pool->cBusy++;
+            PyObject* cnxn = Connect(pool);
+            if (!cnxn)
+            {
+                pool->cBusy--;
+                Signal(pool);
+                return 0;
+            }
+            return Lend(pool, (Connection*)cnxn);
+        }
+
+        // Every connection is in use, so wait for one to be returned.
+
+        PY_TIMEOUT_T us = -1;
+        if (deadline >= 0)
+        {
+            double remaining = deadline - Now();
+            if (remaining <= 0)
+            {
+                RaiseErrorV(0, OperationalError, "Timed out waiting for a connection from the pool.");
+                return 0;
+            }
+            us = (remaining * 1e6 < (double)PY_TIMEOUT_MAX) ? (PY_TIMEOUT_T)(remaining * 1e6) : PY_TIMEOUT_MAX;
+        }
+
+        pool->waiting++;
+
+        PyLockStatus status;
+        Py_BEGIN_ALLOW_THREADS
+        status = PyThread_acquire_lock_timed(pool->wakeup, us, 1);
+        Py_END_ALLOW_THREADS
+
+        pool->waiting--;
+
+        if (status == PY_LOCK_ACQUIRED)
+            pool->signaled = false;
+        else if (status == PY_LOCK_INTR && PyErr_CheckSignals() != 0)
+            return 0;
+    }
+}
+
+
+static char close_doc[] =
+    "close() --> None\n"
+    "\n"
+    "Closes the idle connections.  Connections that are in use are closed when they\n"
+    "are returned and no more can be acquired.";
+
+static PyObject* Pool_close(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+
+    Pool* pool = (Pool*)self;
+    if (!pool->closed)
+    {
+        pool->closed = true;
+        CloseIdle(pool);
+        Signal(pool);
+    }
+    Py_RETURN_NONE;
+}
+
+
+static PyObject* Pool_enter(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+    Py_INCREF(self);
+    return self;
+}
+
+
+static PyObject* Pool_exit(PyObject* self, PyObject* args)
+{
+    UNUSED(args);
+    return Pool_close(self, 0);
+}
+
+
+static PyObject* Pool_getsize(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    Pool* pool = (Pool*)self;
+    return PyLong_FromLong(pool->cIdle + pool->cBusy);
+}
+
+
+static PyObject* Pool_getidle(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    return PyLong_FromLong(((Pool*)self)->cIdle);
+}
+
+
+static PyObject* Pool_getmin(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    return PyLong_FromLong(((Pool*)self)->minsize);
+}
+
+
+static PyObject* Pool_getmax(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    return PyLong_FromLong(((Pool*)self)->maxsize);
+}
+
+
+static PyObject* Pool_getclosed(PyObject* self, void* closure)
+{
+    UNUSED(closure);
+    return PyBool_FromLong(((Pool*)self)->closed);
+}
+
+
+static PyMethodDef Pool_methods[] =
+{
+    { "acquire",   (PyCFunction)Pool_acquire, METH_VARARGS|METH_KEYWORDS, acquire_doc },
+    { "close",     Pool_close,                METH_NOARGS,                close_doc   },
+    { "__enter__", Pool_enter,                METH_NOARGS,                0           },
+    { "__exit__",  Pool_exit,                 METH_VARARGS,               0           },
+    { 0, 0, 0, 0 }
+};
+
+
+static PyGetSetDef Pool_getseters[] =
+{
+    { "size",   Pool_getsize,   0, "The number of open connections, idle or in use.", 0 },
+    { "idle",   Pool_getidle,   0, "The number of idle connections.", 0 },
+    { "min",    Pool_getmin,    0, "The number of connections kept open even when idle.", 0 },
+    { "max",    Pool_getmax,    0, "The most connections the pool will open.", 0 },
+    { "closed", Pool_getclosed, 0, "True if the pool has been closed.", 0 },
+    { 0 }
+};
+
+
+static char pool_doc[] =
+    "Pool(connstring, min=0, max=10, *, max_idle=600, autocommit=False, readonly=False,\n"
+    "     timeout=0, attrs_before=None, encoding=None)\n"
+    "\n"
+    "A pool of connections to one database.  The keyword arguments after max_idle\n"
+    "are passed to each connect.  `min` connections are opened, several at once,\n"
+    "when the pool is created:\n"
+    "\n"
+    "  pool = pyodbc.Pool(cnxnstr, min=4, max=20)\n"
+    "  with pool.acquire() as cnxn:\n"
+    "      cnxn.execute(...)\n"
+    "\n"
+    "A returned connection's cursors are closed, and it is rolled back and its\n"
+    "settings restored.  Connections idle for more than max_idle seconds are closed,\n"
+    "down to `min`.  Zero keeps them open.";
+
+PyTypeObject PoolType =
+{
+    PyVarObject_HEAD_INIT(0, 0)
+    "pyodbc.Pool",                                          // tp_name
+    sizeof(Pool),                                           // tp_basicsize
+    0,                                                      // tp_itemsize
+    Pool_dealloc,                                           // destructor tp_dealloc
+    0,                                                      // tp_print
+    0,                                                      // tp_getattr
+    0,                                                      // tp_setattr
+    0,                                                      // tp_compare
+    0,                                                      // tp_repr
+    0,                                                      // tp_as_number
+    0,                                                      // tp_as_sequence
+    0,                                                      // tp_as_mapping
+    0,                                                      // tp_hash
+    0,                                                      // tp_call
+    0,                                                      // tp_str
+    0,                                                      // tp_getattro
+    0,                                                      // tp_setattro
+    0,                                                      // tp_as_buffer
+    Py_TPFLAGS_DEFAULT,                                     // tp_flags
+    pool_doc,                                               // tp_doc
+    0,                                                      // tp_traverse
+    0,                                                      // tp_clear
+    0,                                                      // tp_richcompare
+    0,                                                      // tp_weaklistoffset
+    0,                                                      // tp_iter
+    0,                                                      // tp_iternext
+    Pool_methods,                                           // tp_methods
+    0,                                                      // tp_members
+    Pool_getseters,                                         // tp_getset
+    0,                                                      // tp_base
+    0,                                                      // tp_dict
+    0,                                                      // tp_descr_get
+    0,                                                      // tp_descr_set
+    0,                                                      // tp_dictoffset
+    0,                                                      // tp_init
+    0,                                                      // tp_alloc
+    Pool_new,                                               // tp_new
+    0,                                                      // tp_free
+    0,                                                      // tp_is_gc
+    0,                                                      // tp_bases
+    0,                                                      // tp_mro
+    0,                                                      // tp_cache
+    0,                                                      // tp_subclasses
+    0,                                                      // tp_weaklist
+};
@@ -0,0 +1,13 @@
+#ifndef POOL_H
+#define POOL_H
+
+struct Connection;
+
+extern PyTypeObject PoolType;
+
+void Pool_Return(Connection* cnxn);
+// Called when a connection lent by a pool (cnxn->pool is set) is closed or deallocated.  Clears
+// cnxn->pool and, if the connection can be reused, moves it into the pool, leaving cnxn closed.
+// Otherwise cnxn is left open for the caller to close.  This never sets an exception.
+
+#endif // POOL_H
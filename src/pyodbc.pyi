@@ -134,6 +134,11 @@ SQL_SCOPE_SESSION: int
 SQL_PC_UNKNOWN: int
 SQL_PC_NOT_PSEUDO: int
 SQL_PC_PSEUDO: int
+SQL_PARAM_SUCCESS: int
+SQL_PARAM_SUCCESS_WITH_INFO: int
+SQL_PARAM_ERROR: int
+SQL_PARAM_UNUSED: int
+SQL_PARAM_DIAG_UNAVAILABLE: int
 # SQL_INDEX_BTREE: int
 # SQL_INDEX_CLUSTERED: int
 # SQL_INDEX_CONTENT: int
@@ -314,6 +319,8 @@ lowercase: bool = False
 native_uuid: bool = False
 odbcversion: str = '3.X'
 pooling: bool = True
+info_cache: str | None = None  # path of a file caching driver info across processes
+info_cache_ttl: float = 86400  # seconds entries in info_cache are used
 
 
 # exceptions
@@ -355,6 +362,18 @@ class Connection:
         """Returns True if the connection is closed, False otherwise."""
         ...
 
+    @property
+    def decimal_mode(self) -> str:
+        """The type decimal and numeric columns are returned as: "decimal" (the default) for
+        decimal.Decimal, "float", "str" for the driver's text, or "int" for the value multiplied
+        by 10**scale, where scale is the column's scale in Cursor.description.  Changes take
+        effect when the next query is executed."""
+        ...
+
+    @decimal_mode.setter
+    def decimal_mode(self, value: str) -> None:
+        ...
+
     @property
     def maxwrite(self) -> int:
         """The maximum bytes to write before using SQLPutData, default is zero for no maximum."""
@@ -370,6 +389,25 @@ class Connection:
         This is typically the backslash character but can be driver-specific."""
         ...
 
+    @property
+    def statement_cache_size(self) -> int:
+        """The number of prepared statements the connection keeps for its cursors to reuse.
+
+        Normally a prepared statement is only reused when a cursor executes the same SQL again.
+        When this is not zero, a cursor that executes different SQL, or is closed, gives its
+        prepared statement to the connection, and any cursor executing equal SQL later takes
+        it instead of preparing the SQL again.  The least recently used statements are freed
+        when there are more than this.  The default is zero, which disables the cache.
+
+        Only use this with drivers that keep prepared statements across commits and rollbacks,
+        which can be checked with getinfo(SQL_CURSOR_COMMIT_BEHAVIOR).  Cursors with noscan
+        turned on do not share their statements."""
+        ...
+
+    @statement_cache_size.setter
+    def statement_cache_size(self, value: int) -> None:
+        ...
+
     @property
     def timeout(self) -> int:
         """The timeout in seconds for SQL queries, use zero (the default) for no timeout limit."""
@@ -508,7 +546,11 @@ class Connection:
         ...
 
     def close(self) -> None:
-        """Close the connection.  Any uncommitted SQL statements will be rolled back."""
+        """Close the connection.  Any uncommitted SQL statements will be rolled back.
+
+        A connection from a Pool is returned to the pool instead, and using a pooled
+        connection as a context manager returns it on exit after committing.
+        """
         ...
 
 
@@ -567,12 +609,71 @@ class Cursor:
     def fast_executemany(self, value: bool) -> None:
         ...
 
+    @property
+    def fast_executemany_continue_on_error(self) -> bool:
+        """Whether fast_executemany keeps executing the remaining rows when some rows fail
+        instead of raising an error, default is False.  Check param_status and
+        param_messages for the rows that failed.  File-like objects and iterators can't be
+        used as parameters when this is set."""
+        ...
+
+    @fast_executemany_continue_on_error.setter
+    def fast_executemany_continue_on_error(self, value: bool) -> None:
+        ...
+
+    @property
+    def fast_executemany_batch_rows(self) -> int:
+        """The maximum number of rows fast_executemany converts and sends to the driver at
+        a time, default is 0 (no limit).  While one batch executes, the next is converted."""
+        ...
+
+    @fast_executemany_batch_rows.setter
+    def fast_executemany_batch_rows(self, value: int) -> None:
+        ...
+
+    @property
+    def fast_executemany_batch_bytes(self) -> int:
+        """The maximum size in bytes of the parameter array fast_executemany allocates,
+        default is 32MB.  Rows are sent to the driver in batches that fit in it, so the
+        memory used is bounded however many rows there are.  Zero means no limit."""
+        ...
+
+    @fast_executemany_batch_bytes.setter
+    def fast_executemany_batch_bytes(self, value: int) -> None:
+        ...
+
+    @property
+    def fast_executemany_max_inline(self) -> int:
+        """The size in bytes of the largest varchar(max), nvarchar(max), or varbinary(max)
+        value fast_executemany copies into the parameter array, default is 8000.  Longer
+        values are sent with SQLPutData, a round trip per value.  Zero means always use
+        SQLPutData."""
+        ...
+
+    @fast_executemany_max_inline.setter
+    def fast_executemany_max_inline(self, value: int) -> None:
+        ...
+
     @property
     def messages(self) -> list[tuple[str, Union[str, bytes]]] | None:
         """Any descriptive messages returned by the last call to execute(), e.g. PRINT
         statements, or None."""
         ...
 
+    @property
+    def param_messages(self) -> list[tuple[int | None, str, Union[str, bytes]]] | None:
+        """The diagnostic messages from the last fast_executemany as (row, class, message)
+        tuples, where row is the index of the row of parameters the message is for, or None
+        if the driver didn't say."""
+        ...
+
+    @property
+    def param_status(self) -> list[int] | None:
+        """The status of each row of parameters in the last fast_executemany: one of
+        SQL_PARAM_SUCCESS, SQL_PARAM_SUCCESS_WITH_INFO, SQL_PARAM_ERROR, SQL_PARAM_UNUSED,
+        or SQL_PARAM_DIAG_UNAVAILABLE (if the driver doesn't report them)."""
+        ...
+
     @property
     def noscan(self) -> bool:
         """Whether the driver should scan SQL strings for escape sequences, default is True."""
@@ -589,6 +690,18 @@ class Cursor:
         """
         ...
 
+    @property
+    def rowsetsize(self) -> int:
+        """The number of rows at a time to fetch from the driver into bound column buffers,
+        default is 1 (each value is read with SQLGetData).  Larger values speed up fetching
+        large result sets.  Result sets with columns that cannot be bound, such as LOBs,
+        are fetched one row at a time.  Changes take effect on the next execute."""
+        ...
+
+    @rowsetsize.setter
+    def rowsetsize(self, value: int) -> None:
+        ...
+
 
     # implemented dunder methods
     def __enter__(self) -> Cursor: ...
@@ -627,6 +740,8 @@ class Cursor:
         Args:
             sql: The SQL query.
             *params: Any parameters for the SQL query, as positional arguments or a single iterable.
+                A file-like object with readinto() or an iterator of bytes or str chunks is sent as
+                a long binary or text value in chunks, so it is never all in memory.
 
         Returns:
             The cursor, hence calls on the cursor can be chained.
@@ -646,6 +761,36 @@ class Cursor:
         """
         ...
 
+    def executemany_columns(self, sql: str, columns: Sequence[Any],
+                            masks: Sequence[Any] | None = None) -> None:
+        """Run the SQL query once for each row of a set of parameter columns.  The
+        columns are bound column-wise directly to the arrays' memory without copying.
+
+        Args:
+            sql: The SQL query.
+            columns: One one-dimensional array per parameter supporting the buffer
+                protocol, such as NumPy arrays, array.array, or memoryview.  The elements
+                must be integers, floats, or booleans and all arrays must be the same length.
+            masks: None, or one item per column that is None or an array of bytes that are
+                non-zero for nulls.  A NumPy masked array's own mask is used if its item
+                is None.
+        """
+        ...
+
+    def executemany_arrow(self, sql: str, reader: Any) -> None:
+        """Run the SQL query once for each row of an Arrow object supporting the Arrow
+        PyCapsule interface (__arrow_c_stream__), such as a pyarrow Table or
+        RecordBatchReader.  Each record batch is bound column-wise and executed with a
+        single call to the driver, unless the converted values would need more memory
+        than fast_executemany_batch_bytes, in which case it is split.
+
+        Args:
+            sql: The SQL query.
+            reader: The Arrow data, with one column per parameter.  Integer, floating
+                point, boolean, utf8, binary, date, and timestamp columns are supported.
+        """
+        ...
+
     def fetchone(self) -> Row | None:
         """Retrieve the next row in the current result set for the query.
 
@@ -690,6 +835,49 @@ class Cursor:
         """
         ...
 
+    def fetchnumpy(self, size: int | None = None) -> dict[str, Any]:
+        """Fetches rows into NumPy arrays, one per column.  Integer, floating point, bit,
+        date, and timestamp columns are read directly into int64, float64, bool,
+        datetime64[D], and datetime64[us] arrays.  Other columns are object arrays.
+
+        Args:
+            size: The maximum number of rows to fetch.  If None, all remaining rows are
+                fetched.
+
+        Returns:
+            A dictionary mapping each column name to a numpy.ma.MaskedArray with nulls
+            masked.
+        """
+        ...
+
+    def fetch_arrow(self, batch_rows: int = 65536) -> ArrowStream:
+        """Returns an object exporting the remaining rows of the result set using the Arrow
+        PyCapsule interface, e.g. pyarrow.table(cursor.fetch_arrow()).  Values are read
+        directly into Arrow buffers so output converters are not applied.  Decimal columns
+        follow the connection's decimal_mode: decimal128 (utf8 if the precision is too
+        large), float64, utf8, or int64.
+
+        Args:
+            batch_rows: The maximum number of rows in each record batch.
+
+        Returns:
+            An ArrowStream which can be consumed once.
+        """
+        ...
+
+    def open_blob(self, column: int | str) -> BlobReader | None:
+        """Moves to the next row and returns a file-like object that reads one column in
+        chunks, so long values can be streamed without reading them into memory.
+
+        Args:
+            column: The index or name of the column.
+
+        Returns:
+            A BlobReader, or None if there are no more rows.  The values of the earlier
+            columns are in its values attribute and the later columns are skipped.
+        """
+        ...
+
     def nextset(self) -> bool:
         """Switch to the next result set returned by the SQL query (this happens when
         there are multiple statements within the SQL query that was just executed).
@@ -912,6 +1100,135 @@ class Cursor:
         ...
 
 
+class ArrowStream:
+    """The rows of a result set returned by Cursor.fetch_arrow."""
+
+    def __arrow_c_stream__(self, requested_schema: Any = None) -> object:
+        """Exports the rows as an "arrow_array_stream" PyCapsule.  The requested_schema is
+        ignored.
+        """
+        ...
+
+
+class BlobReader:
+    """A read-only, file-like object returned by Cursor.open_blob.  Values are read as
+    bytes, so text columns are in the database's encoding.  It can only be used until the
+    cursor moves to another row."""
+
+    @property
+    def closed(self) -> bool:
+        """True if the reader has been closed."""
+        ...
+
+    @property
+    def values(self) -> tuple[Any, ...]:
+        """The values of the row's columns before the blob column."""
+        ...
+
+    def read(self, size: int = -1, /) -> bytes:
+        """Reads up to size bytes, or the rest of the value if size is negative."""
+        ...
+
+    def readinto(self, buffer: Any, /) -> int:
+        """Reads into a writable buffer and returns the number of bytes read."""
+        ...
+
+    def readable(self) -> bool:
+        ...
+
+    def close(self) -> None:
+        ...
+
+    def __enter__(self) -> BlobReader:
+        ...
+
+    def __exit__(self, exc_type, exc_value, traceback) -> None:
+        ...
+
+
+class Pool:
+    """A pool of open connections to one database.  Connections are lent by acquire() and
+    returned by closing them or leaving their `with` block:
+
+        pool = pyodbc.Pool(connstring, min=4, max=20)
+        with pool.acquire() as cnxn:
+            cnxn.execute(...)
+
+    A returned connection is rolled back and autocommit, timeout, maxwrite, decimal_mode,
+    statement_cache_size, the encodings, and the output converters are restored to those
+    of a new connection, and its cached statements are freed.  Cursors still open are
+    closed, as when a connection is closed.  The caller's Connection object is always
+    left closed.
+    """
+
+    def __init__(self,
+                 connstring: str,
+                 min: int = 0,
+                 max: int = 10,
+                 *,
+                 max_idle: float = 600,
+                 autocommit: bool = False,
+                 readonly: bool = False,
+                 timeout: int = 0,
+                 attrs_before: dict[int, Union[int, bytes, bytearray, str, Sequence[str]]] | None = None,
+                 encoding: str | None = None) -> None:
+        """Creates the pool and opens `min` connections, several at a time.  If any of
+        them fails, the error is raised.
+
+        Args:
+            connstring: The connection string passed to connect().
+            min: The number of connections kept open even when idle.
+            max: The most connections the pool will open at once.
+            max_idle: Connections idle longer than this many seconds are closed, down to
+                `min`, the next time one is acquired.  Zero keeps them open.
+            autocommit, readonly, timeout, attrs_before, encoding: Passed to connect().
+        """
+        ...
+
+    @property
+    def size(self) -> int:
+        """The number of open connections, idle or in use."""
+        ...
+
+    @property
+    def idle(self) -> int:
+        """The number of idle connections."""
+        ...
+
+    @property
+    def min(self) -> int:
+        ...
+
+    @property
+    def max(self) -> int:
+        ...
+
+    @property
+    def closed(self) -> bool:
+        ...
+
+    def acquire(self, timeout: float | None = None) -> Connection:
+        """Returns an idle connection or, if all are in use and fewer than `max` are open,
+        a new one.  Otherwise waits for one to be returned, raising OperationalError if
+        `timeout` seconds pass first.
+
+        Idle connections are checked with SQL_ATTR_CONNECTION_DEAD before they are lent, so
+        connections the driver knows are broken are closed and skipped.  Drivers that don't
+        support the attribute report every connection as alive.
+        """
+        ...
+
+    def close(self) -> None:
+        """Closes the idle connections.  Connections in use are closed when returned."""
+        ...
+
+    def __enter__(self) -> Pool:
+        ...
+
+    def __exit__(self, exc_type, exc_value, traceback) -> None:
+        ...
+
+
 class Row:
     """The class representing a single record in the result set from a query.  Objects of
     this class behave somewhat similarly to a NamedTuple.  Column values can be accessed
@@ -21,6 +21,9 @@
 #include "params.h"
 #include "dbspecific.h"
 #include "decimal.h"
+#include "arrow.h"
+#include "blob.h"
+#include "pool.h"
 #include <datetime.h>
 
 #include <time.h>
@@ -60,6 +63,16 @@ static char module_doc[] =
     "  connection is made.  The default is True, which enables ODBC connection\n"
     "  pooling.\n"
     "\n"
+    "info_cache\n"
+    "  None or the path of a file used to save the driver information pyodbc reads\n"
+    "  when it first connects with each connection string, so other processes can\n"
+    "  skip reading it.  The file holds hashes of the connection strings, not the\n"
+    "  strings, and is only readable by its owner.  The default is None.\n"
+    "\n"
+    "info_cache_ttl\n"
+    "  The number of seconds entries in info_cache are used before the driver is\n"
+    "  asked again.  The default is one day.\n"
+    "\n"
     "threadsafety\n"
     "  The integer 1, indicating that threads may share the module but not\n"
     "  connections.  Note that connections and cursors may be used by different\n"
@@ -281,7 +294,7 @@ static bool import_types()
 }
 
 
-static bool AllocateEnv()
+bool AllocateEnv()
 {
     PyObject* pooling = PyObject_GetAttrString(pModule, "pooling");
     bool bPooling = pooling == Py_True;
@@ -345,7 +358,7 @@ static bool CheckAttrsVal(PyObject *val, bool allowSeq)
         " integers, buffers, bytes, %s", allowSeq ? "strings, or sequences" : "or strings") != 0;
 }
 
-static PyObject* _CheckAttrsDict(PyObject* attrs)
+PyObject* CheckAttrsDict(PyObject* attrs)
 {
     // The attrs_before dictionary must be keys to integer values.  If valid and non-empty,
     // increment the reference count and return the pointer to indicate the calling code should
@@ -463,7 +476,7 @@ static PyObject* mod_connect(PyObject* self, PyObject* args, PyObject* kwargs)
             }
             if (PyUnicode_CompareWithASCIIString(key, "attrs_before") == 0 && PyDict_Check(value))
             {
-                attrs_before = _CheckAttrsDict(value);
+                attrs_before = CheckAttrsDict(value);
                 if (PyErr_Occurred())
                     return 0;
                 continue;
@@ -895,6 +908,11 @@ static const ConstantDef aConstants[] = {
     MAKECONST(SQL_PC_UNKNOWN),
     MAKECONST(SQL_PC_NOT_PSEUDO),
     MAKECONST(SQL_PC_PSEUDO),
+    MAKECONST(SQL_PARAM_SUCCESS),
+    MAKECONST(SQL_PARAM_SUCCESS_WITH_INFO),
+    MAKECONST(SQL_PARAM_ERROR),
+    MAKECONST(SQL_PARAM_UNUSED),
+    MAKECONST(SQL_PARAM_DIAG_UNAVAILABLE),
 
     // SQLGetInfo
     MAKECONST(SQL_ACCESSIBLE_PROCEDURES),
@@ -1164,7 +1182,8 @@ PyMODINIT_FUNC PyInit_pyodbc()
 {
     ErrorInit();
 
-    if (PyType_Ready(&ConnectionType) < 0 || PyType_Ready(&CursorType) < 0 || PyType_Ready(&RowType) < 0 || PyType_Ready(&CnxnInfoType) < 0)
+    if (PyType_Ready(&ConnectionType) < 0 || PyType_Ready(&CursorType) < 0 || PyType_Ready(&RowType) < 0 || PyType_Ready(&CnxnInfoType) < 0 ||
+        PyType_Ready(&ArrowStreamType) < 0 || PyType_Ready(&BlobReaderType) < 0 || PyType_Ready(&PoolType) < 0)
         return 0;
 
     Object module;
@@ -1189,6 +1208,9 @@ PyMODINIT_FUNC PyInit_pyodbc()
     Py_INCREF(Py_False);
     PyModule_AddObject(module, "native_uuid", Py_False);
     Py_INCREF(Py_False);
+    PyModule_AddObject(module, "info_cache", Py_None);
+    Py_INCREF(Py_None);
+    PyModule_AddIntConstant(module, "info_cache_ttl", 24 * 60 * 60);
 
     PyModule_AddObject(module, "Connection", (PyObject*)&ConnectionType);
     Py_INCREF((PyObject*)&ConnectionType);
@@ -1196,6 +1218,12 @@ PyMODINIT_FUNC PyInit_pyodbc()
     Py_INCREF((PyObject*)&CursorType);
     PyModule_AddObject(module, "Row", (PyObject*)&RowType);
     Py_INCREF((PyObject*)&RowType);
+    PyModule_AddObject(module, "ArrowStream", (PyObject*)&ArrowStreamType);
+    Py_INCREF((PyObject*)&ArrowStreamType);
+    PyModule_AddObject(module, "BlobReader", (PyObject*)&BlobReaderType);
+    Py_INCREF((PyObject*)&BlobReaderType);
+    PyModule_AddObject(module, "Pool", (PyObject*)&PoolType);
+    Py_INCREF((PyObject*)&PoolType);
 
     // Add the SQL_XXX defines from ODBC.
     for (unsigned int i = 0; i < _countof(aConstants); i++)
@@ -53,10 +53,21 @@ extern PyObject* pModule;
 
 inline bool lowercase()
 {
-    return PyObject_GetAttrString(pModule, "lowercase") == Py_True;
+    PyObject* o = PyObject_GetAttrString(pModule, "lowercase");
+    bool b = (o == Py_True);
+    Py_XDECREF(o);
+    return b;
 }
 
 bool UseNativeUUID();
 // Returns True if pyodbc.native_uuid is true, meaning uuid.UUID objects should be returned.
 
+bool AllocateEnv();
+// Allocates the shared HENV, which must be done before connecting.  It is allocated the first
+// time a connection is made so pyodbc.pooling can be changed first.
+
+PyObject* CheckAttrsDict(PyObject* attrs);
+// Validates an attrs_before dictionary.  Returns a new reference if it is valid and not empty.
+// Returns zero if it is empty or an exception was set.
+
 #endif // _PYPGMODULE_H
@@ -0,0 +1,290 @@
+// A per-connection cache of prepared statements.
+//
+// Prepare skips SQLPrepare when a cursor executes the SQL its statement is already prepared
+// with.  When Connection.statement_cache_size is not zero, a cursor that moves on to other SQL
+// or is closed gives its prepared HSTMT to the connection instead of discarding it, and a
+// cursor that needs SQL the connection has cached takes that HSTMT instead of preparing again.
+//
+// A statement is only ever owned by one cursor or by the cache, never shared, so there is no
+// locking beyond the GIL.  The cache is only modified while holding the GIL and entries are
+// removed from the list before the GIL is released to free them.
+
+#include "pyodbc.h"
+#include "wrapper.h"
+#include "textenc.h"
+#include "pyodbcmodule.h"
+#include "cursor.h"
+#include "connection.h"
+#include "errors.h"
+#include "params.h"
+#include "stmtcache.h"
+
+
+static Py_hash_t HashSQL(PyObject* sql)
+{
+    // Returns the hash used to look up sql in the cache or -1 if it cannot be cached.  Only
+    // exact strs are cached so hashing and comparing cannot run Python code or fail.
+    return PyUnicode_CheckExact(sql) ? PyObject_Hash(sql) : -1;
+}
+
+static void Unlink(Connection* cnxn, CachedStatement* entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        cnxn->stmtcache_head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        cnxn->stmtcache_tail = entry->prev;
+
+    entry->prev = entry->next = 0;
+    cnxn->stmtcache_count--;
+}
+
+static void PushFront(Connection* cnxn, CachedStatement* entry)
+{
+    entry->prev = 0;
+    entry->next = cnxn->stmtcache_head;
+    if (cnxn->stmtcache_head)
+        cnxn->stmtcache_head->prev = entry;
+    else
+        cnxn->stmtcache_tail = entry;
+    cnxn->stmtcache_head = entry;
+    cnxn->stmtcache_count++;
+}
+
+static void FreeEntries(Connection* cnxn, CachedStatement* list)
+{
+    // Frees a chain of entries, linked by `next`, that have already been removed from the
+    // cache.  The handles are only freed while the connection is open since MS ODBC will crash
+    // if an HSTMT is used after the HDBC has been freed.  (Disconnecting frees them.)
+
+    if (cnxn->hdbc != SQL_NULL_HANDLE)
+    {
+        Py_BEGIN_ALLOW_THREADS
+        for (CachedStatement* p = list; p; p = p->next)
+            SQLFreeHandle(SQL_HANDLE_STMT, p->hstmt);
+        Py_END_ALLOW_THREADS
+    }
+
+    while (list)
+    {
+        CachedStatement* next = list->next;
+        Py_DECREF(list->sql);
+        PyMem_Free(list->paramdescs);
+        FreeResultInfo(list->resultinfo);
+        PyMem_Free(list);
+        list = next;
+    }
+}
+
+
+bool IsPrepared(Cursor* cur, PyObject* pSql)
+{
+    PyObject* prepared = cur->pPreparedSQL;
+    if (pSql == prepared)
+        return true;
+
+    if (prepared == 0 || !PyUnicode_CheckExact(pSql) || !PyUnicode_CheckExact(prepared))
+        return false;
+
+    return PyObject_Hash(pSql) == PyObject_Hash(prepared) && PyUnicode_Compare(pSql, prepared) == 0;
+}
+
+
+bool CacheStatement(Cursor* cur)
+{
+    Connection* cnxn = cur->cnxn;
+
+    if (cur->pPreparedSQL == 0 || cur->noscan || cnxn == 0 || cnxn->stmtcache_size <= 0)
+        return false;
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE || cur->hstmt == SQL_NULL_HANDLE)
+        return false;
+
+    Py_hash_t hash = HashSQL(cur->pPreparedSQL);
+    if (hash == -1)
+        return false;
+
+    CachedStatement* entry = (CachedStatement*)PyMem_Malloc(sizeof(CachedStatement));
+    if (!entry)
+        return false;
+
+    HSTMT hstmt = cur->hstmt;
+    cur->hstmt = SQL_NULL_HANDLE;
+
+    Py_BEGIN_ALLOW_THREADS
+    SQLFreeStmt(hstmt, SQL_CLOSE);
+    SQLFreeStmt(hstmt, SQL_UNBIND);
+    SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+    Py_END_ALLOW_THREADS
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above, which
+        // also freed the statement.
+        PyMem_Free(entry);
+        return true;
+    }
+
+    entry->sql        = cur->pPreparedSQL;
+    entry->hash       = hash;
+    entry->hstmt      = hstmt;
+    entry->timeout    = cur->timeout;
+    entry->paramcount = cur->paramcount;
+    entry->paramdescs = cur->paramdescs;
+    entry->resultinfo = cur->resultinfo;
+
+    cur->pPreparedSQL = 0;
+    cur->paramcount   = 0;
+    cur->paramdescs   = 0;
+    cur->resultinfo   = 0;
+
+    PushFront(cnxn, entry);
+    TrimStatementCache(cnxn);
+
+    return true;
+}
+
+
+bool SwapCachedStatement(Cursor* cur, PyObject* pSql, bool& found)
+{
+    found = false;
+
+    Connection* cnxn = cur->cnxn;
+
+    CachedStatement* entry = 0;
+    Py_hash_t hash = HashSQL(pSql);
+    if (hash != -1)
+    {
+        for (entry = cnxn->stmtcache_head; entry != 0; entry = entry->next)
+            if (entry->hash == hash && PyUnicode_Compare(entry->sql, pSql) == 0)
+                break;
+    }
+
+    // Remove the entry before caching the cursor's statement, which could evict it.
+    if (entry)
+        Unlink(cnxn, entry);
+
+    HSTMT hstmtOld = SQL_NULL_HANDLE;
+    if (!CacheStatement(cur))
+    {
+        // The cursor's statement is not prepared or could not be cached.  If nothing was found,
+        // pSql will be prepared on it.  Otherwise it is no longer needed.
+        if (!entry)
+            return true;
+        hstmtOld = cur->hstmt;
+        cur->hstmt = SQL_NULL_HANDLE;
+    }
+
+    FreeParameterInfo(cur);
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread while caching the cursor's statement.
+        if (entry)
+            FreeEntries(cnxn, entry);
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (!entry)
+        return AllocateStatement(cur);
+
+    cur->hstmt        = entry->hstmt;
+    cur->pPreparedSQL = entry->sql;
+    cur->paramcount   = entry->paramcount;
+    cur->paramdescs   = entry->paramdescs;
+    cur->resultinfo   = entry->resultinfo;
+
+    long timeout = entry->timeout;
+    PyMem_Free(entry);
+
+    found = true;
+
+    SQLRETURN ret = SQL_SUCCESS;
+    Py_BEGIN_ALLOW_THREADS
+    if (hstmtOld != SQL_NULL_HANDLE)
+        SQLFreeHandle(SQL_HANDLE_STMT, hstmtOld);
+    if (timeout != cur->timeout)
+        ret = SQLSetStmtAttr(cur->hstmt, SQL_ATTR_QUERY_TIMEOUT, (SQLPOINTER)(uintptr_t)cur->timeout, 0);
+    Py_END_ALLOW_THREADS
+
+    if (cnxn->hdbc == SQL_NULL_HANDLE)
+    {
+        // The connection was closed by another thread in the ALLOW_THREADS block above.
+        RaiseErrorV(0, ProgrammingError, "The cursor's connection was closed.");
+        return false;
+    }
+
+    if (!SQL_SUCCEEDED(ret))
+    {
+        RaiseErrorFromHandle(cnxn, "SQLSetStmtAttr(SQL_ATTR_QUERY_TIMEOUT)", cnxn->hdbc, cur->hstmt);
+        return false;
+    }
+
+    return true;
+}
+
+
+void InvalidatePrepared(Cursor* cur)
+{
+    Connection* cnxn = cur->cnxn;
+    PyObject* sql = cur->pPreparedSQL;
+    if (sql == 0)
+        return;
+
+    Py_hash_t hash = HashSQL(sql);
+    if (hash != -1)
+    {
+        CachedStatement* stale = 0;
+        CachedStatement* next;
+        for (CachedStatement* entry = cnxn->stmtcache_head; entry != 0; entry = next)
+        {
+            next = entry->next;
+            if (entry->hash == hash && PyUnicode_Compare(entry->sql, sql) == 0)
+            {
+                Unlink(cnxn, entry);
+                entry->next = stale;
+                stale = entry;
+            }
+        }
+
+        if (stale)
+            FreeEntries(cnxn, stale);
+    }
+
+    FreeParameterInfo(cur);
+}
+
+
+void TrimStatementCache(Connection* cnxn)
+{
+    CachedStatement* evicted = 0;
+
+    while (cnxn->stmtcache_count > cnxn->stmtcache_size)
+    {
+        CachedStatement* entry = cnxn->stmtcache_tail;
+        Unlink(cnxn, entry);
+        entry->next = evicted;
+        evicted = entry;
+    }
+
+    if (evicted)
+        FreeEntries(cnxn, evicted);
+}
+
+
+void ClearStatementCache(Connection* cnxn)
+{
+    CachedStatement* list = cnxn->stmtcache_head;
+
+    cnxn->stmtcache_head  = 0;
+    cnxn->stmtcache_tail  = 0;
+    cnxn->stmtcache_count = 0;
+
+    if (list)
+        FreeEntries(cnxn, list);
+}
@@ -0,0 +1,63 @@
+#ifndef STMTCACHE_H
+#define STMTCACHE_H
+
+struct Connection;
+struct Cursor;
+struct ParamDesc;
+struct ResultInfo;
+
+struct CachedStatement
+{
+    // A prepared statement that is not in use by a cursor, kept by the connection so any of its
+    // cursors can execute the same SQL again without another SQLPrepare.  See
+    // Connection.statement_cache_size.
+    //
+    // The statement has been closed and its columns and parameters unbound.  The fields below
+    // move between the cursor and the cache along with the HSTMT.
+
+    CachedStatement* prev;
+    CachedStatement* next;
+    // The connection's list, most recently used first.
+
+    PyObject* sql;
+    Py_hash_t hash;
+    // The SQL the statement was prepared with, always an exact str, and its hash.
+
+    HSTMT hstmt;
+    long timeout;
+    // The SQL_ATTR_QUERY_TIMEOUT the statement was allocated with.
+
+    int paramcount;
+    ParamDesc* paramdescs;
+    ResultInfo* resultinfo;
+    // Cursor.paramcount, Cursor.paramdescs, and Cursor.resultinfo.
+};
+
+bool IsPrepared(Cursor* cur, PyObject* pSql);
+// Returns true if the cursor's statement is already prepared for pSql: either the same object
+// or an equal str.
+
+bool SwapCachedStatement(Cursor* cur, PyObject* pSql, bool& found);
+// Called when the cursor needs pSql prepared and the connection's cache is enabled.  The
+// cursor's prepared statement, if any, is given to the cache.  If the cache has a statement
+// for pSql, the cursor takes it and `found` is set to true.  Otherwise the cursor is left with
+// an unprepared statement.
+
+bool CacheStatement(Cursor* cur);
+// Gives the cursor's prepared statement to the connection's cache, leaving the cursor with no
+// HSTMT.  Returns false, doing nothing, if the cache is disabled or the statement is not
+// prepared.  This never sets an exception.
+
+void InvalidatePrepared(Cursor* cur);
+// Called when executing the cursor's prepared statement fails because it no longer matches the
+// tables it uses.  The cursor's prepared SQL and parameter descriptions are discarded, as are
+// cached statements for the same SQL, so the next execute prepares and describes it again.
+
+void TrimStatementCache(Connection* cnxn);
+// Frees the least recently used statements until the cache is no larger than
+// cnxn->stmtcache_size.
+
+void ClearStatementCache(Connection* cnxn);
+// Frees every cached statement.  Called before disconnecting.
+
+#endif // STMTCACHE_H
@@ -68,6 +68,18 @@ void SQLWChar::init(PyObject* src, const TextEnc& enc)
 
 PyObject* TextEnc::Encode(PyObject* obj) const
 {
+    if (PyUnicode_Check(obj))
+    {
+        Py_ssize_t cb = EncodedLength(obj);
+        if (cb >= 0)
+        {
+            PyObject* bytes = PyBytes_FromStringAndSize(0, cb);
+            if (bytes)
+                EncodeInto(obj, (byte*)PyBytes_AS_STRING(bytes));
+            return bytes;
+        }
+    }
+
     PyObject* bytes = PyCodec_Encode(obj, name, "strict");
 
     if (bytes && PyErr_Occurred())
@@ -89,6 +101,186 @@ PyObject* TextEnc::Encode(PyObject* obj) const
 
 
 
+// SSE2 is part of the x86-64 baseline so it doesn't need a compiler flag or runtime check.
+// Other platforms use the scalar loops.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2 1
+#endif
+
+#ifdef WORDS_BIGENDIAN
+static const bool HOST_BIGENDIAN = true;
+#else
+static const bool HOST_BIGENDIAN = false;
+#endif
+
+
+static inline uint16_t ReadUnit(const byte* pb, bool swap)
+{
+    uint16_t n;
+    memcpy(&n, pb, sizeof(n));
+    return swap ? (uint16_t)((n << 8) | (n >> 8)) : n;
+}
+
+
+static uint16_t OrUnits(const byte* pb, Py_ssize_t cch)
+{
+    // Returns the bitwise OR of all of the UTF-16 code units in the buffer, in the buffer's
+    // byte order.  The OR is below 0x80 only if all characters are ASCII and below 0x100 only
+    // if all are Latin-1.
+
+    uint16_t result = 0;
+    Py_ssize_t i = 0;
+
+#ifdef HAVE_SSE2
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= cch; i += 8)
+        acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(pb + i * 2)));
+    acc = _mm_or_si128(acc, _mm_srli_si128(acc, 8));
+    acc = _mm_or_si128(acc, _mm_srli_si128(acc, 4));
+    acc = _mm_or_si128(acc, _mm_srli_si128(acc, 2));
+    result = (uint16_t)_mm_cvtsi128_si32(acc);
+#endif
+
+    for (; i < cch; i++)
+        result |= ReadUnit(pb + i * 2, false);
+
+    return result;
+}
+
+
+static bool HasSurrogates(const byte* pb, Py_ssize_t cch, bool swap)
+{
+    Py_ssize_t i = 0;
+
+#ifdef HAVE_SSE2
+    // Compare in the buffer's byte order by swapping the constants instead of the data.
+    const __m128i mask = _mm_set1_epi16((short)(swap ? 0x00F8 : 0xF800));
+    const __m128i surrogate = _mm_set1_epi16((short)(swap ? 0x00D8 : 0xD800));
+    for (; i + 8 <= cch; i += 8)
+    {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)(pb + i * 2)), mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(v, surrogate)) != 0)
+            return true;
+    }
+#endif
+
+    for (; i < cch; i++)
+    {
+        if ((ReadUnit(pb + i * 2, swap) & 0xF800) == 0xD800)
+            return true;
+    }
+    return false;
+}
+
+
+static void NarrowUnits(const byte* pb, Py_ssize_t cch, bool swap, Py_UCS1* out)
+{
+    // Copies UTF-16 code units that are all below 0x100 into a 1-byte string.
+
+    Py_ssize_t i = 0;
+
+#ifdef HAVE_SSE2
+    for (; i + 16 <= cch; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(pb + i * 2));
+        __m128i b = _mm_loadu_si128((const __m128i*)(pb + i * 2 + 16));
+        if (swap)
+        {
+            a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+            b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+        }
+        _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+    }
+#endif
+
+    for (; i < cch; i++)
+        out[i] = (Py_UCS1)ReadUnit(pb + i * 2, swap);
+}
+
+
+static PyObject* DecodeUTF16Fast(const byte* pb, Py_ssize_t cb, bool bigEndian, bool& handled)
+{
+    // Creates a string directly from UTF-16 text without surrogates, which is nearly all of
+    // the text we read, using the narrowest string kind that holds it.
+    //
+    // Sets `handled` to false if the text has surrogates (or is malformed) so the caller can
+    // use the UTF-16 codec.
+
+    handled = false;
+
+    if (cb % 2)
+        return 0;
+
+    Py_ssize_t cch = cb / 2;
+    bool swap = (bigEndian != HOST_BIGENDIAN);
+
+    uint16_t bits = OrUnits(pb, cch);
+    if (swap)
+        bits = (uint16_t)((bits << 8) | (bits >> 8));
+
+    if (bits < 0x100)
+    {
+        handled = true;
+        PyObject* str = PyUnicode_New(cch, (bits < 0x80) ? 0x7F : 0xFF);
+        if (str)
+            NarrowUnits(pb, cch, swap, PyUnicode_1BYTE_DATA(str));
+        return str;
+    }
+
+    if (HasSurrogates(pb, cch, swap))
+        return 0;
+
+    handled = true;
+    PyObject* str = PyUnicode_New(cch, 0xFFFF);
+    if (str)
+    {
+        Py_UCS2* out = PyUnicode_2BYTE_DATA(str);
+        if (!swap)
+        {
+            memcpy(out, pb, (size_t)cb);
+        }
+        else
+        {
+            for (Py_ssize_t i = 0; i < cch; i++)
+                out[i] = ReadUnit(pb + i * 2, true);
+        }
+    }
+    return str;
+}
+
+
+static bool IsASCII(const byte* pb, Py_ssize_t cb)
+{
+    Py_ssize_t i = 0;
+
+#ifdef HAVE_SSE2
+    for (; i + 16 <= cb; i += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(pb + i))) != 0)
+            return false;
+    }
+#endif
+
+    for (; i < cb; i++)
+    {
+        if (pb[i] & 0x80)
+            return false;
+    }
+    return true;
+}
+
+
+static PyObject* DecodeUTF16(const byte* pb, Py_ssize_t cb, int byteorder)
+{
+    bool handled;
+    PyObject* str = DecodeUTF16Fast(pb, cb, (byteorder == BYTEORDER_BE), handled);
+    if (handled)
+        return str;
+    return PyUnicode_DecodeUTF16((char*)pb, cb, "strict", &byteorder);
+}
+
+
 PyObject* TextBufferToObject(const TextEnc& enc, const byte* pbData, Py_ssize_t cbData)
 {
     // cbData
@@ -104,25 +296,34 @@ PyObject* TextBufferToObject(const TextEnc& enc, const byte* pbData, Py_ssize_t
     if (cbData == 0)
         return PyUnicode_FromStringAndSize("", 0);
 
+    // The UTF-8 and UTF-16 cases build the string directly when the text is ASCII (or, for
+    // UTF-16, has no surrogates) and only use the codecs for the rest.
+
     switch (enc.optenc)
     {
         case OPTENC_UTF8:
+            if (IsASCII(pbData, cbData))
+            {
+                PyObject* str = PyUnicode_New(cbData, 0x7F);
+                if (str)
+                    memcpy(PyUnicode_1BYTE_DATA(str), pbData, (size_t)cbData);
+                return str;
+            }
             return PyUnicode_DecodeUTF8((char*)pbData, cbData, "strict");
 
         case OPTENC_UTF16: {
+            // A BOM overrides the native byte order, so leave those to the codec.
             int byteorder = BYTEORDER_NATIVE;
-            return PyUnicode_DecodeUTF16((char*)pbData, cbData, "strict", &byteorder);
+            if (cbData >= 2 && ((pbData[0] == 0xFF && pbData[1] == 0xFE) || (pbData[0] == 0xFE && pbData[1] == 0xFF)))
+                return PyUnicode_DecodeUTF16((char*)pbData, cbData, "strict", &byteorder);
+            return DecodeUTF16(pbData, cbData, HOST_BIGENDIAN ? BYTEORDER_BE : BYTEORDER_LE);
         }
 
-        case OPTENC_UTF16LE: {
-            int byteorder = BYTEORDER_LE;
-            return PyUnicode_DecodeUTF16((char*)pbData, cbData, "strict", &byteorder);
-        }
+        case OPTENC_UTF16LE:
+            return DecodeUTF16(pbData, cbData, BYTEORDER_LE);
 
-        case OPTENC_UTF16BE: {
-            int byteorder = BYTEORDER_BE;
-            return PyUnicode_DecodeUTF16((char*)pbData, cbData, "strict", &byteorder);
-        }
+        case OPTENC_UTF16BE:
+            return DecodeUTF16(pbData, cbData, BYTEORDER_BE);
 
         case OPTENC_LATIN1:
             return PyUnicode_DecodeLatin1((char*)pbData, cbData, "strict");
@@ -131,3 +332,241 @@ PyObject* TextBufferToObject(const TextEnc& enc, const byte* pbData, Py_ssize_t
     // The user set an encoding by name.
     return PyUnicode_Decode((char*)pbData, cbData, enc.name, "strict");
 }
+
+
+static inline void WriteUnit(byte* pb, uint16_t n, bool bigEndian)
+{
+    pb[bigEndian ? 1 : 0] = (byte)(n & 0xFF);
+    pb[bigEndian ? 0 : 1] = (byte)(n >> 8);
+}
+
+
+static void WidenUnits(const Py_UCS1* p, Py_ssize_t cch, bool bigEndian, byte* out)
+{
+    // Writes a 1-byte string as UTF-16.  Every character is a single code unit with a zero
+    // high byte.
+
+    Py_ssize_t i = 0;
+
+#ifdef HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= cch; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i lo = bigEndian ? _mm_unpacklo_epi8(zero, v) : _mm_unpacklo_epi8(v, zero);
+        __m128i hi = bigEndian ? _mm_unpackhi_epi8(zero, v) : _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i*)(out + i * 2), lo);
+        _mm_storeu_si128((__m128i*)(out + i * 2 + 16), hi);
+    }
+#endif
+
+    for (; i < cch; i++)
+        WriteUnit(out + i * 2, p[i], bigEndian);
+}
+
+
+static void CopyUnits(const Py_UCS2* p, Py_ssize_t cch, bool bigEndian, byte* out)
+{
+    // Writes a 2-byte string without surrogates as UTF-16.
+
+    if (bigEndian == HOST_BIGENDIAN)
+    {
+        memcpy(out, p, (size_t)cch * 2);
+        return;
+    }
+
+    Py_ssize_t i = 0;
+
+#ifdef HAVE_SSE2
+    for (; i + 8 <= cch; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+        _mm_storeu_si128((__m128i*)(out + i * 2), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+#endif
+
+    for (; i < cch; i++)
+        WriteUnit(out + i * 2, p[i], bigEndian);
+}
+
+
+static Py_ssize_t UTF16Length(const Py_UCS4* p, Py_ssize_t cch)
+{
+    // Returns the length in bytes of a 4-byte string in UTF-16, or -1 if it has surrogates,
+    // which can't be encoded.
+
+    Py_ssize_t cb = cch * 2;
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        if (p[i] > 0xFFFF)
+            cb += 2;
+        else if ((p[i] & 0xF800) == 0xD800)
+            return -1;
+    }
+    return cb;
+}
+
+
+static void WriteUTF16(const Py_UCS4* p, Py_ssize_t cch, bool bigEndian, byte* out)
+{
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        Py_UCS4 ch = p[i];
+        if (ch > 0xFFFF)
+        {
+            ch -= 0x10000;
+            WriteUnit(out, (uint16_t)(0xD800 | (ch >> 10)), bigEndian);
+            WriteUnit(out + 2, (uint16_t)(0xDC00 | (ch & 0x3FF)), bigEndian);
+            out += 4;
+        }
+        else
+        {
+            WriteUnit(out, (uint16_t)ch, bigEndian);
+            out += 2;
+        }
+    }
+}
+
+
+template<typename T>
+static Py_ssize_t UTF8Length(const T* p, Py_ssize_t cch)
+{
+    // Returns the length in bytes of a string in UTF-8, or -1 if it has surrogates.
+
+    Py_ssize_t cb = cch;
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        Py_UCS4 ch = p[i];
+        if (ch < 0x80)
+            continue;
+        if (ch < 0x800)
+            cb += 1;
+        else if (ch > 0xFFFF)
+            cb += 3;
+        else if ((ch & 0xF800) == 0xD800)
+            return -1;
+        else
+            cb += 2;
+    }
+    return cb;
+}
+
+
+template<typename T>
+static void WriteUTF8(const T* p, Py_ssize_t cch, byte* out)
+{
+    for (Py_ssize_t i = 0; i < cch; i++)
+    {
+        Py_UCS4 ch = p[i];
+        if (ch < 0x80)
+        {
+            *out++ = (byte)ch;
+        }
+        else if (ch < 0x800)
+        {
+            *out++ = (byte)(0xC0 | (ch >> 6));
+            *out++ = (byte)(0x80 | (ch & 0x3F));
+        }
+        else if (ch < 0x10000)
+        {
+            *out++ = (byte)(0xE0 | (ch >> 12));
+            *out++ = (byte)(0x80 | ((ch >> 6) & 0x3F));
+            *out++ = (byte)(0x80 | (ch & 0x3F));
+        }
+        else
+        {
+            *out++ = (byte)(0xF0 | (ch >> 18));
+            *out++ = (byte)(0x80 | ((ch >> 12) & 0x3F));
+            *out++ = (byte)(0x80 | ((ch >> 6) & 0x3F));
+            *out++ = (byte)(0x80 | (ch & 0x3F));
+        }
+    }
+}
+
+
+Py_ssize_t TextEnc::EncodedLength(PyObject* str) const
+{
+    // We encode the common encodings straight from the string's 1, 2, or 4-byte data instead
+    // of looking up the codec by name and creating a bytes object for every value.
+
+    Py_ssize_t cch = PyUnicode_GET_LENGTH(str);
+    int kind = PyUnicode_KIND(str);
+    const void* data = PyUnicode_DATA(str);
+
+    switch (optenc)
+    {
+    case OPTENC_UTF16:
+    case OPTENC_UTF16LE:
+    case OPTENC_UTF16BE:
+    {
+        // The "utf-16" codec writes a BOM, even for empty strings.
+        Py_ssize_t cbBOM = (optenc == OPTENC_UTF16) ? 2 : 0;
+        if (kind == PyUnicode_1BYTE_KIND)
+            return cbBOM + cch * 2;
+        if (kind == PyUnicode_2BYTE_KIND)
+            return HasSurrogates((const byte*)data, cch, false) ? -1 : cbBOM + cch * 2;
+        Py_ssize_t cb = UTF16Length((const Py_UCS4*)data, cch);
+        return (cb < 0) ? -1 : cbBOM + cb;
+    }
+
+    case OPTENC_UTF8:
+        if (PyUnicode_IS_ASCII(str))
+            return cch;
+        if (kind == PyUnicode_1BYTE_KIND)
+            return UTF8Length((const Py_UCS1*)data, cch);
+        if (kind == PyUnicode_2BYTE_KIND)
+            return UTF8Length((const Py_UCS2*)data, cch);
+        return UTF8Length((const Py_UCS4*)data, cch);
+
+    case OPTENC_LATIN1:
+        // Strings use the narrowest kind, so wider ones have characters above 0xFF.
+        return (kind == PyUnicode_1BYTE_KIND) ? cch : -1;
+    }
+
+    return -1;
+}
+
+
+void TextEnc::EncodeInto(PyObject* str, byte* pb) const
+{
+    Py_ssize_t cch = PyUnicode_GET_LENGTH(str);
+    int kind = PyUnicode_KIND(str);
+    const void* data = PyUnicode_DATA(str);
+
+    switch (optenc)
+    {
+    case OPTENC_UTF16:
+    case OPTENC_UTF16LE:
+    case OPTENC_UTF16BE:
+    {
+        bool bigEndian = (optenc == OPTENC_UTF16BE) || (optenc == OPTENC_UTF16 && HOST_BIGENDIAN);
+        if (optenc == OPTENC_UTF16)
+        {
+            WriteUnit(pb, 0xFEFF, bigEndian);
+            pb += 2;
+        }
+        if (kind == PyUnicode_1BYTE_KIND)
+            WidenUnits((const Py_UCS1*)data, cch, bigEndian, pb);
+        else if (kind == PyUnicode_2BYTE_KIND)
+            CopyUnits((const Py_UCS2*)data, cch, bigEndian, pb);
+        else
+            WriteUTF16((const Py_UCS4*)data, cch, bigEndian, pb);
+        break;
+    }
+
+    case OPTENC_UTF8:
+        if (PyUnicode_IS_ASCII(str))
+            memcpy(pb, data, (size_t)cch);
+        else if (kind == PyUnicode_1BYTE_KIND)
+            WriteUTF8((const Py_UCS1*)data, cch, pb);
+        else if (kind == PyUnicode_2BYTE_KIND)
+            WriteUTF8((const Py_UCS2*)data, cch, pb);
+        else
+            WriteUTF8((const Py_UCS4*)data, cch, pb);
+        break;
+
+    case OPTENC_LATIN1:
+        memcpy(pb, data, (size_t)cch);
+        break;
+    }
+}
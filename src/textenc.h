@@ -55,6 +55,16 @@ struct TextEnc
     PyObject* Encode(PyObject*) const;
     // Given a string, return a bytes object encoded.  This is used for encoding a Python
     // object for passing to a function expecting SQLCHAR* or SQLWCHAR*.
+
+    Py_ssize_t EncodedLength(PyObject* str) const;
+    // Returns the number of bytes EncodeInto writes for the Unicode object `str`, or -1 if it
+    // must be encoded with the codec.  That is the case for encodings we don't encode
+    // ourselves and for strings with characters the encoding can't represent, which leaves
+    // raising the error to the codec.
+
+    void EncodeInto(PyObject* str, byte* pb) const;
+    // Encodes `str` into `pb` without creating a temporary object.  This must only be called
+    // after EncodedLength returned a length, and `pb` must have room for it.
 };
 
 
@@ -1,8 +1,12 @@
 # ignore naive dates/datetimes (DTZnnn):
 # ruff: noqa: DTZ001, DTZ005, DTZ011
 
+import array
+import io
 import os
 import re
+import subprocess
+import sys
 import uuid
 from collections.abc import Iterator
 from decimal import Decimal
@@ -93,6 +97,28 @@ def test_varbinary(cursor: pyodbc.Cursor):
     _test_vartype(cursor, 'varbinary')
 
 
+@pytest.mark.parametrize('value', [
+    'ascii only, long enough to use the vector loops',
+    'caf\xe9 latin-1 characters in a longer string',
+    '\u4e2d\u6587 characters outside latin-1',
+    'surrogate pair \U0001F600 needs the codec',
+])
+def test_nvarchar_widths(cursor: pyodbc.Cursor, value):
+    # Text is decoded directly into the narrowest string kind, so check each kind.
+    cursor.execute("create table t1(s nvarchar(100))")
+    cursor.execute("insert into t1 values (?)", value)
+    assert cursor.execute("select s from t1").fetchval() == value
+
+
+def test_nvarchar_widths_fast_executemany(cursor: pyodbc.Cursor):
+    # fast_executemany encodes text straight into the parameter array from each string kind.
+    values = ['ascii ' * 10, 'caf\xe9 ' * 10, '\u4e2d\u6587 ' * 10, '\U0001F600 ' * 10, '']
+    cursor.execute("create table t1(i int, s nvarchar(100))")
+    cursor.fast_executemany = True
+    cursor.executemany("insert into t1 values (?, ?)", list(enumerate(values)))
+    assert [row.s for row in cursor.execute("select s from t1 order by i")] == values
+
+
 @pytest.mark.skipif(SQLSERVER_YEAR < 2005, reason='(max) not supported until 2005')
 def test_unicode_longmax(cursor: pyodbc.Cursor):
     # Issue 188:	Segfault when fetching NVARCHAR(MAX) data over 511 bytes
@@ -294,6 +320,25 @@ def test_native_uuid(cursor: pyodbc.Cursor):
     assert value == result
 
 
+def test_native_uuid_per_result_set(cursor: pyodbc.Cursor):
+    # The setting is captured when the query is executed, so changing it while fetching does
+    # not affect the rest of the result set.
+    values = [uuid.uuid4() for _ in range(3)]
+    cursor.execute("create table t1(n uniqueidentifier)")
+    cursor.executemany("insert into t1 values (?)", [(v,) for v in values])
+
+    try:
+        pyodbc.native_uuid = True
+        cursor.execute("select n from t1")
+        assert isinstance(cursor.fetchone()[0], uuid.UUID)
+        pyodbc.native_uuid = False
+        assert all(isinstance(row[0], uuid.UUID) for row in cursor.fetchall())
+
+        assert isinstance(cursor.execute("select n from t1").fetchval(), str)
+    finally:
+        pyodbc.native_uuid = True
+
+
 def test_nextset(cursor: pyodbc.Cursor):
     cursor.execute("create table t1(i int)")
     for i in range(4):
@@ -391,6 +436,67 @@ def test_decimal_e(cursor: pyodbc.Cursor):
     assert result == value
 
 
+def test_money(cursor: pyodbc.Cursor):
+    cursor.execute("create table t1(m money, s smallmoney)")
+    cursor.execute("insert into t1 values (-1234567.8912, 12.5)")
+    row = cursor.execute("select m, s from t1").fetchone()
+    assert row.m == Decimal('-1234567.8912')
+    assert row.s == Decimal('12.5')
+
+
+def test_decimal_mode(cursor: pyodbc.Cursor):
+    cnxn = cursor.connection
+    assert cnxn.decimal_mode == 'decimal'
+    cursor.execute("create table t1(d decimal(10, 3))")
+    cursor.execute("insert into t1 values (-12.5), (null)")
+
+    try:
+        cnxn.decimal_mode = 'float'
+        cursor.execute("select d from t1")
+        assert cursor.description[0][1] == float
+        assert [row[0] for row in cursor] == [-12.5, None]
+
+        cnxn.decimal_mode = 'str'
+        cursor.execute("select d from t1")
+        assert cursor.description[0][1] == str
+        assert [row[0] for row in cursor] == ['-12.500', None]
+
+        cnxn.decimal_mode = 'int'
+        cursor.execute("select d from t1")
+        assert cursor.description[0][1] == int
+        assert cursor.description[0][5] == 3
+        assert [row[0] for row in cursor] == [-12500, None]
+
+        with pytest.raises(ValueError):
+            cnxn.decimal_mode = 'double'
+    finally:
+        cnxn.decimal_mode = 'decimal'
+
+    assert cursor.execute("select d from t1").fetchval() == Decimal('-12.5')
+
+
+def test_fetch_arrow_decimal_mode(cursor: pyodbc.Cursor):
+    pa = pytest.importorskip('pyarrow')
+
+    cnxn = cursor.connection
+    cursor.execute("create table t1(d decimal(10, 3))")
+    cursor.execute("insert into t1 values (-12.5), (null)")
+
+    try:
+        expected = {
+            'float': ('double', [-12.5, None]),
+            'str': ('string', ['-12.500', None]),
+            'int': ('int64', [-12500, None]),
+        }
+        for mode, (typename, values) in expected.items():
+            cnxn.decimal_mode = mode
+            table = pa.table(cursor.execute("select d from t1").fetch_arrow())
+            assert str(table.schema.field('d').type) == typename
+            assert table.column('d').to_pylist() == values
+    finally:
+        cnxn.decimal_mode = 'decimal'
+
+
 def test_subquery_params(cursor: pyodbc.Cursor):
     """Ensure parameter markers work in a subquery"""
     cursor.execute("create table t1(id integer, s varchar(20))")
@@ -867,6 +973,164 @@ def test_executemany_dae_0(cursor: pyodbc.Cursor):
     cursor.fast_executemany = False
 
 
+
+
+def test_fast_executemany_param_status(cursor: pyodbc.Cursor):
+    # Row 5 violates the primary key.  The error is reported for that row and the rest of the
+    # rows are still inserted.
+    cursor.execute("create table t1(n int primary key)")
+    cursor.fast_executemany = True
+    cursor.fast_executemany_batch_rows = 4
+    cursor.fast_executemany_continue_on_error = True
+    params = [(i,) for i in range(10)]
+    params[5] = (4,)
+    cursor.executemany("insert into t1(n) values (?)", params)
+
+    status = cursor.param_status
+    assert len(status) == 10
+    assert status[5] == pyodbc.SQL_PARAM_ERROR
+    assert all(s in (pyodbc.SQL_PARAM_SUCCESS, pyodbc.SQL_PARAM_SUCCESS_WITH_INFO)
+               for i, s in enumerate(status) if i != 5)
+    assert 5 in [row for row, _, _ in cursor.param_messages]
+
+    values = [row.n for row in cursor.execute("select n from t1 order by n")]
+    assert values == [0, 1, 2, 3, 4, 6, 7, 8, 9]
+
+    # Without continuing, the error is raised but the status still identifies the row.
+    cursor.execute("delete from t1")
+    cursor.fast_executemany_continue_on_error = False
+    with pytest.raises(pyodbc.IntegrityError):
+        cursor.executemany("insert into t1(n) values (?)", params)
+    assert cursor.param_status[5] == pyodbc.SQL_PARAM_ERROR
+
+    # Rows after a failed row can be executed again, so streams, which can only be read once,
+    # are rejected.
+    cursor.execute("create table t2(n int primary key, b varbinary(max))")
+    cursor.fast_executemany_continue_on_error = True
+    with pytest.raises(pyodbc.ProgrammingError):
+        cursor.executemany("insert into t2 values (?, ?)", [(1, io.BytesIO(b'abc'))])
+    assert cursor.execute("select count(*) from t2").fetchval() == 0
+    cursor.fast_executemany_continue_on_error = False
+
+def test_prepared_result_columns(cursor: pyodbc.Cursor):
+    # The columns of a prepared statement are saved the first time it is executed and reused.
+    cursor.execute("create table t1(a int, b varchar(10))")
+    cursor.execute("insert into t1(a, b) values (1, 'one'), (2, 'two')")
+    sql = "select * from t1 where a = ?"
+    assert cursor.execute(sql, 1).fetchone().b == 'one'
+    description = cursor.description
+    row = cursor.execute(sql, 2).fetchone()
+    assert row.b == 'two'
+    assert cursor.description == description
+
+    # A different number of columns is noticed.
+    cursor.connection.execute("alter table t1 add c int")
+    row = cursor.execute(sql, 2).fetchone()
+    assert len(row) == 3 and row.c is None
+    assert len(cursor.description) == 3
+
+    # So is a column whose type changed.
+    cursor.connection.execute("alter table t1 alter column c varchar(10)")
+    cursor.connection.execute("update t1 set c = 'x'")
+    assert cursor.execute(sql, 2).fetchone().c == 'x'
+    assert cursor.description[2][1] == str
+
+    # The columns can depend on the parameter types.
+    assert cursor.execute("select ? as x", 1).fetchone().x == 1
+    assert cursor.execute("select ? as x", 'abc').fetchone().x == 'abc'
+    assert cursor.execute("select ? as x", Decimal('1.5')).fetchone().x == Decimal('1.5')
+
+def test_fast_executemany_describe_cache(cursor: pyodbc.Cursor):
+    # The parameters are described once per prepared statement and reused by later calls.
+    cursor.execute("create table t1(a int, s varchar(5))")
+    cursor.fast_executemany = True
+    sql = "insert into t1(a, s) values (?, ?)"
+    for i in range(3):
+        cursor.executemany(sql, [(i, 'abc'), (None, None)])
+        cursor.execute(sql, None, None)
+    assert cursor.connection.execute("select count(*) from t1").fetchval() == 9
+
+    # After the column is widened the saved description is too small.  The truncation error
+    # discards it, so executing again describes the parameters again.
+    cursor.connection.execute("alter table t1 alter column s varchar(20)")
+    try:
+        cursor.executemany(sql, [(10, 'x' * 15)])
+    except pyodbc.Error:
+        cursor.executemany(sql, [(10, 'x' * 15)])
+    assert cursor.execute("select s from t1 where a = 10").fetchval() == 'x' * 15
+
+@pytest.mark.parametrize('fast', [False, True])
+def test_parameter_subclasses(cursor: pyodbc.Cursor, fast):
+    # Parameter types are cached by type, so subclasses must still be converted like their base
+    # class, in both execution paths.
+    class MyInt(int):
+        pass
+
+    class MyStr(str):
+        pass
+
+    class MyDecimal(Decimal):
+        pass
+
+    cursor.execute("create table t1(i int, s varchar(20), d decimal(10, 2), u uniqueidentifier)")
+    cursor.fast_executemany = fast
+    value = uuid.uuid4()
+    params = [(MyInt(i), MyStr('s%d' % i), MyDecimal('%d.25' % i), value) for i in range(3)]
+    cursor.executemany("insert into t1(i, s, d, u) values (?, ?, ?, ?)", params)
+    pyodbc.native_uuid = True
+    rows = cursor.execute("select i, s, d, u from t1 order by i").fetchall()
+    assert [tuple(row) for row in rows] == [(i, 's%d' % i, Decimal('%d.25' % i), value) for i in range(3)]
+
+def test_parameter_kind_cache_bounded(cursor: pyodbc.Cursor):
+    # The cache of parameter types doesn't keep every type alive.
+    import gc
+    import weakref
+    refs = []
+    for i in range(200):
+        cls = type('MyInt%d' % i, (int,), {})
+        refs.append(weakref.ref(cls))
+        assert cursor.execute("select ?", cls(i)).fetchval() == i
+        del cls
+    gc.collect()
+    assert sum(1 for ref in refs if ref() is not None) <= 64
+
+def test_fast_executemany_batches(cursor: pyodbc.Cursor):
+    cursor.execute("create table t1(a int, b nvarchar(100))")
+    cursor.fast_executemany = True
+    cursor.fast_executemany_batch_rows = 7
+
+    # A generator is read a batch at a time.  The type change at row 50 forces a rebind.
+    rows = ((i, str(i) if i < 50 else None) for i in range(100))
+    cursor.executemany("insert into t1(a, b) values (?, ?)", rows)
+    assert cursor.rowcount == 100
+
+    # A type change right at a batch boundary (row 49 == 7 * 7).
+    rows = ((200 + i, str(i) if i < 49 else None) for i in range(100))
+    cursor.executemany("insert into t1(a, b) values (?, ?)", rows)
+    assert cursor.rowcount == 100
+    cursor.execute("delete from t1 where a >= 200")
+
+    cursor.fast_executemany_batch_rows = 0
+    cursor.fast_executemany_batch_bytes = 1
+    cursor.executemany("insert into t1(a, b) values (?, ?)", [(i, 'x') for i in range(100, 110)])
+    assert cursor.rowcount == 10
+
+    assert cursor.execute("select count(*), count(b), sum(a) from t1").fetchone() == (110, 60, sum(range(110)))
+
+@pytest.mark.parametrize('max_inline', [0, 100, 8000])
+def test_fast_executemany_max_types(cursor: pyodbc.Cursor, max_inline):
+    cursor.execute("create table t1(a int, s nvarchar(max), b varbinary(max))")
+    cursor.fast_executemany = True
+    cursor.fast_executemany_max_inline = max_inline
+
+    # Short values are bound inline and the long ones are sent with SQLPutData.
+    params = [(i, 'x' * (i * 97), b'y' * (i * 89)) for i in range(100)]
+    params[5] = (5, None, None)
+    cursor.executemany("insert into t1(a, s, b) values (?, ?, ?)", params)
+
+    rows = cursor.execute("select a, s, b from t1 order by a").fetchall()
+    assert [tuple(row) for row in rows] == params
+
 def test_executemany_failure(cursor: pyodbc.Cursor):
     """
     Ensure that an exception is raised if one query in an executemany fails.
@@ -987,6 +1251,228 @@ def test_skip(cursor: pyodbc.Cursor):
     assert cursor.fetchone()[0] == 4
 
 
+def test_rowsetsize(cursor: pyodbc.Cursor):
+    # Fetch more rows than fit in one rowset so we cross rowset boundaries with each of the
+    # fetch functions.
+    assert cursor.rowsetsize == 1
+
+    cursor.execute("create table t1(id int, s varchar(20), n nvarchar(20), d decimal(10,2), dt datetime, b varbinary(10))")
+    for i in range(1, 11):
+        cursor.execute("insert into t1 values(?, ?, ?, ?, ?, ?)",
+                       i, str(i), 'n%d' % i, Decimal('%d.25' % i), datetime(2020, 1, i), bytes([i]))
+    cursor.execute("insert into t1 values(11, null, null, null, null, null)")
+
+    cursor.rowsetsize = 4
+    expected = cursor.execute("select * from t1 order by id").fetchall()
+    assert [row.id for row in expected] == list(range(1, 12))
+    assert expected[2].s == '3'
+    assert expected[2].n == 'n3'
+    assert expected[2].d == Decimal('3.25')
+    assert expected[2].dt == datetime(2020, 1, 3)
+    assert expected[2].b == bytes([3])
+    assert tuple(expected[10]) == (11, None, None, None, None, None)
+
+    cursor.execute("select * from t1 order by id")
+    rows = cursor.fetchmany(3) + cursor.fetchmany(3)
+    assert cursor.fetchone().id == 7
+    cursor.skip(2)
+    rows += [row for row in cursor]
+    assert [row.id for row in rows] == [1, 2, 3, 4, 5, 6, 10, 11]
+
+    # A LOB column can't be bound, so only the columns before it are bound and the rest are
+    # read with SQLGetData.
+    cursor.execute("select id, s, cast(s as varchar(max)) as m from t1 order by id")
+    rows = cursor.fetchall()
+    assert [(row.id, row.m) for row in rows] == [(row.id, row.s) for row in expected]
+
+
+def test_varying_lengths(cursor: pyodbc.Cursor):
+    # Values are read into a buffer per column that is reused for each row and grows as
+    # needed, so make sure short values after long ones (and vice versa) are read correctly.
+    cursor.execute("create table t1(id int, s varchar(max), n nvarchar(max), b varbinary(max))")
+    lengths = [10, 5000, 3, 100000, 0, 20]
+    for i, length in enumerate(lengths):
+        cursor.execute("insert into t1 values(?, ?, ?, ?)",
+                       i, 'x' * length, 'é' * length, bytes([i]) * length)
+
+    rows = cursor.execute("select s, n, b from t1 order by id").fetchall()
+    for i, (row, length) in enumerate(zip(rows, lengths)):
+        assert row.s == 'x' * length
+        assert row.n == 'é' * length
+        assert row.b == bytes([i]) * length
+
+
+def test_fetch_arrow(cursor: pyodbc.Cursor):
+    pa = pytest.importorskip('pyarrow')
+
+    cursor.execute("""
+        create table t1(id int, s varchar(20), n nvarchar(20), d decimal(10,2), f float,
+                        dt datetime, dd date, b varbinary(10), bt bit)
+    """)
+    for i in range(1, 6):
+        cursor.execute("insert into t1 values(?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                       i, str(i), 'é%d' % i, Decimal('-%d.25' % i), i / 2,
+                       datetime(2020, 1, i, 1, 2, 3, 4000), date(2021, 2, i), bytes([i]), i % 2)
+    cursor.execute("insert into t1(id) values(6)")
+
+    cursor.execute("select * from t1 order by id")
+    table = pa.table(cursor.fetch_arrow(batch_rows=4))
+    assert table.num_rows == 6
+    assert table.column_names == ['id', 's', 'n', 'd', 'f', 'dt', 'dd', 'b', 'bt']
+    assert str(table.schema.field('d').type) == 'decimal128(10, 2)'
+
+    rows = table.to_pylist()
+    assert rows[2] == {
+        'id': 3, 's': '3', 'n': 'é3', 'd': Decimal('-3.25'), 'f': 1.5,
+        'dt': datetime(2020, 1, 3, 1, 2, 3, 3000), 'dd': date(2021, 2, 3), 'b': bytes([3]),
+        'bt': True
+    }
+    assert rows[5] == {'id': 6, 's': None, 'n': None, 'd': None, 'f': None, 'dt': None, 'dd': None,
+                       'b': None, 'bt': None}
+
+    # The stream can only be consumed once.
+    cursor.execute("select id from t1")
+    stream = cursor.fetch_arrow()
+    pa.table(stream)
+    with pytest.raises(pyodbc.ProgrammingError):
+        stream.__arrow_c_stream__()
+
+    # Executing the same statement again ends a stream, even though the description is reused.
+    sql = "select id from t1 where id > ?"
+    cursor.execute(sql, 0)
+    reader = pa.RecordBatchReader.from_stream(cursor.fetch_arrow(batch_rows=2))
+    reader.read_next_batch()
+    cursor.execute(sql, 0)
+    with pytest.raises(Exception, match='results changed'):
+        reader.read_next_batch()
+
+    # It reads the rows that have not been fetched yet.
+    cursor.rowsetsize = 4
+    cursor.execute("select id from t1 order by id")
+    cursor.fetchone()
+    assert pa.table(cursor.fetch_arrow()).column('id').to_pylist() == [2, 3, 4, 5, 6]
+
+
+def test_fetchnumpy(cursor: pyodbc.Cursor):
+    np = pytest.importorskip('numpy')
+
+    cursor.execute("create table t1(id int, big bigint, f float, bt bit, dt datetime, dd date, s varchar(10))")
+    cursor.executemany("insert into t1 values(?, ?, ?, ?, ?, ?, ?)",
+                       [(i, i * 10000000000, i / 4, i % 2, datetime(2020, 1, 1, 0, 0, i % 60), date(2021, 1, 1), str(i))
+                        for i in range(1, 2001)])
+    cursor.execute("insert into t1(id) values(2001)")
+
+    # More than the initial allocation so the arrays have to grow.
+    cursor.execute("select * from t1 order by id")
+    arrays = cursor.fetchnumpy()
+    assert sorted(arrays) == ['big', 'bt', 'dd', 'dt', 'f', 'id', 's']
+    assert arrays['id'].dtype == np.int64
+    assert arrays['id'].tolist() == list(range(1, 2002))
+    assert arrays['big'][1] == 20000000000
+    assert arrays['f'].dtype == np.float64
+    assert arrays['f'][2] == 0.75
+    assert arrays['bt'].dtype == np.bool_
+    assert arrays['bt'][:3].tolist() == [True, False, True]
+    assert arrays['dt'].dtype == np.dtype('datetime64[us]')
+    assert arrays['dt'][0] == np.datetime64('2020-01-01T00:00:01')
+    assert arrays['dd'][0] == np.datetime64('2021-01-01')
+    assert arrays['s'].dtype == object
+    assert arrays['s'][9] == '10'
+    for name in arrays:
+        assert arrays[name].mask[-1] == True        # noqa: E712
+        assert not arrays[name].mask[:-1].any()
+
+    # size limits the rows and the rest can still be fetched.
+    cursor.execute("select id from t1 order by id")
+    assert cursor.fetchnumpy(3)['id'].tolist() == [1, 2, 3]
+    assert cursor.fetchone()[0] == 4
+
+
+def test_executemany_columns(cursor: pyodbc.Cursor):
+    cursor.execute("create table t1(id int, big bigint, f float, bt bit)")
+
+    ids = array.array('i', range(1, 1001))
+    bigs = array.array('q', (i * 10000000000 for i in range(1, 1001)))
+    floats = array.array('d', (i / 4 for i in range(1, 1001)))
+    bits = memoryview(bytes(i % 2 for i in range(1, 1001))).cast('?')
+    nulls = bytes(i == 1000 for i in range(1, 1001))
+
+    cursor.executemany_columns("insert into t1 values(?, ?, ?, ?)", [ids, bigs, floats, bits],
+                               masks=[None, None, nulls, None])
+    assert cursor.rowcount == 1000
+
+    assert cursor.execute("select count(*) from t1").fetchval() == 1000
+    row = cursor.execute("select * from t1 where id = 3").fetchone()
+    assert row == (3, 30000000000, 0.75, True)
+    assert cursor.execute("select f from t1 where id = 1000").fetchval() is None
+
+    with pytest.raises(pyodbc.ProgrammingError):
+        cursor.executemany_columns("insert into t1(id) values(?)", [ids, ids])
+    with pytest.raises(ValueError):
+        cursor.executemany_columns("insert into t1(id, big) values(?, ?)", [ids, bigs[:10]])
+    with pytest.raises(TypeError):
+        cursor.executemany_columns("insert into t1(id) values(?)", [memoryview(b'abc').cast('c')])
+
+
+def test_executemany_columns_numpy(cursor: pyodbc.Cursor):
+    np = pytest.importorskip('numpy')
+
+    cursor.execute("create table t1(id bigint, f float)")
+    ids = np.arange(1, 101, dtype=np.int64)
+    floats = np.ma.masked_array(ids / 2, mask=ids % 10 == 0)
+    cursor.executemany_columns("insert into t1 values(?, ?)", [ids, floats])
+
+    cursor.execute("select * from t1 order by id")
+    arrays = cursor.fetchnumpy()
+    assert arrays['id'].tolist() == ids.tolist()
+    assert arrays['f'].mask.tolist() == floats.mask.tolist()
+    assert arrays['f'][0] == 0.5
+
+
+def test_executemany_arrow(cursor: pyodbc.Cursor):
+    pa = pytest.importorskip('pyarrow')
+
+    cursor.execute("create table t1(id int, f float, bt bit, s nvarchar(20), b varbinary(10), d date, dt datetime2)")
+
+    table = pa.table({
+        'id': pa.array(range(1, 301), pa.int32()),
+        'f': pa.array([i / 4 if i != 300 else None for i in range(1, 301)], pa.float64()),
+        'bt': pa.array([i % 2 == 1 for i in range(1, 301)]),
+        's': pa.array(['\u00e9t\u00e9 %d \U0001F600' % i for i in range(1, 300)] + [None]),
+        'b': pa.array([bytes([i % 256]) * (i % 10) for i in range(1, 301)], pa.binary()),
+        'd': pa.array([date(2020, 1, 1)] * 300, pa.date32()),
+        'dt': pa.array([datetime(2020, 1, 2, 3, 4, 5, 123456)] * 300, pa.timestamp('us')),
+    })
+
+    # Several batches so the conversion buffers are reused.
+    cursor.executemany_arrow("insert into t1 values(?, ?, ?, ?, ?, ?, ?)", table.to_reader(max_chunksize=128))
+    assert cursor.rowcount == 300
+
+    assert cursor.execute("select count(*) from t1").fetchval() == 300
+    row = cursor.execute("select * from t1 where id = 3").fetchone()
+    assert row.f == 0.75
+    assert row.bt is True
+    assert row.s == '\u00e9t\u00e9 3 \U0001F600'
+    assert row.b == b'\x03\x03\x03'
+    assert row.d == date(2020, 1, 1)
+    assert row.dt == datetime(2020, 1, 2, 3, 4, 5, 123456)
+
+    row = cursor.execute("select f, s from t1 where id = 300").fetchone()
+    assert row == (None, None)
+
+    with pytest.raises(pyodbc.ProgrammingError):
+        cursor.executemany_arrow("insert into t1(id) values(?)", table)
+
+    # A batch with a long value is split so the other rows don't all need room for it.
+    cursor.execute("create table t2(id int, s nvarchar(max))")
+    cursor.fast_executemany_batch_bytes = 100000
+    long = pa.table({'id': pa.array(range(100), pa.int32()),
+                     's': pa.array(['x' * 50000 if i == 50 else str(i) for i in range(100)])})
+    cursor.executemany_arrow("insert into t2 values(?, ?)", long)
+    assert cursor.rowcount == 100
+    assert cursor.execute("select count(*), sum(len(s)) from t2").fetchone() == (100, 50000 + sum(len(str(i)) for i in range(100) if i != 50))
+
+
 def test_timeout():
     cnxn = connect()
     assert cnxn.timeout == 0    # defaults to zero (off)
@@ -998,6 +1484,124 @@ def test_timeout():
     assert cnxn.timeout == 0
 
 
+def test_statement_cache(cursor: pyodbc.Cursor):
+    cnxn = cursor.connection
+    assert cnxn.statement_cache_size == 0    # off by default
+    cnxn.statement_cache_size = 2
+
+    cursor.execute("create table t1(n int, s varchar(10))")
+    cursor.executemany("insert into t1(n, s) values (?, ?)", [(i, str(i)) for i in range(5)])
+
+    # Equal SQL built separately each time, run on cursors that are closed and replaced, must
+    # reuse the cached statements and still return the right results.
+    table = 't1'
+    for i in range(5):
+        other = cnxn.cursor()
+        assert other.execute(f"select s from {table} where n = ?", i).fetchone()[0] == str(i)
+        assert other.execute(f"select count(*) from {table} where n < ?", i).fetchone()[0] == i
+        assert other.execute("select 1").fetchone()[0] == 1
+        other.close()
+
+    # Statements with a different number of parameters must not be confused.
+    assert cursor.execute(f"select n from {table} where n in (?, ?) order by n", 1, 3).fetchall() == [(1,), (3,)]
+    assert cursor.execute(f"select s from {table} where n = ?", None).fetchall() == []
+
+    cnxn.statement_cache_size = 0
+    assert cursor.execute(f"select s from {table} where n = ?", 2).fetchone()[0] == '2'
+
+    with pytest.raises(ValueError):
+        cnxn.statement_cache_size = -1
+
+
+def test_pool():
+    with pyodbc.Pool(CNXNSTR, min=2, max=3) as pool:
+        assert pool.size == 2 and pool.idle == 2
+
+        cnxn = pool.acquire()
+        cnxn.autocommit = True
+        cnxn.maxwrite = 100
+        cnxn.timeout = 30
+        cnxn.statement_cache_size = 5
+        assert cnxn.execute("select 1").fetchone()[0] == 1
+        cnxn.close()
+        assert cnxn.closed     # the caller's object can no longer be used
+        assert pool.idle == 2
+
+        # Returned connections are reset.
+        with pool.acquire() as cnxn:
+            assert not cnxn.autocommit
+            assert cnxn.maxwrite == 0
+            assert cnxn.timeout == 0
+            assert cnxn.statement_cache_size == 0
+        assert cnxn.closed
+
+        # The cursors of a returned connection are closed and the connection is reused.
+        with pool.acquire() as cnxn:
+            cursor = cnxn.cursor()
+            cursor.execute("select 1")
+        assert pool.size == 2 and pool.idle == 2
+        with pytest.raises(pyodbc.ProgrammingError):
+            cursor.execute("select 1")
+
+        held = [pool.acquire() for _ in range(3)]
+        with pytest.raises(pyodbc.OperationalError):
+            pool.acquire(timeout=0.1)
+        for cnxn in held:
+            cnxn.close()
+        assert pool.idle == 3
+
+    assert pool.closed and pool.size == 0
+    with pytest.raises(pyodbc.ProgrammingError):
+        pool.acquire()
+
+
+def test_info_cache(tmp_path):
+    path = tmp_path / 'cnxninfo'
+    pyodbc.info_cache = str(path)
+    try:
+        # The connection string must be new to this process so the driver is asked and the file
+        # is written.
+        cnxn = pyodbc.connect(CNXNSTR, app='pyodbc-info-cache-test')
+        assert cnxn.execute("select 1").fetchone()[0] == 1
+        cnxn.close()
+
+        text = path.read_text()
+        lines = text.splitlines()
+        assert len(lines) == 1 and len(lines[0].split()) == 10
+        assert 'pyodbc-info-cache-test' not in text
+    finally:
+        pyodbc.info_cache = None
+
+    # This process keeps the info in memory, so a new process is used to read the file.  The
+    # entry is changed to a datetime precision of 23, which truncates datetime parameters to
+    # milliseconds.
+    script = '\n'.join([
+        'import sys, pyodbc',
+        'from datetime import datetime',
+        'pyodbc.info_cache = sys.argv[1]',
+        'cnxn = pyodbc.connect(sys.argv[2], app="pyodbc-info-cache-test")',
+        'value = datetime(2020, 1, 2, 3, 4, 5, 123456)',
+        'print(cnxn.execute("select cast(? as datetime2(7))", value).fetchval().microsecond)',
+    ])
+    env = dict(os.environ, PYTHONPATH=os.path.dirname(pyodbc.__file__))
+
+    def connect_in_new_process(written):
+        fields = lines[0].split()
+        fields[1] = str(written)
+        fields[6] = '23'
+        path.write_text(' '.join(fields) + '\n')
+        result = subprocess.run([sys.executable, '-c', script, str(path), CNXNSTR], env=env,
+                                capture_output=True, text=True, check=True)
+        return int(result.stdout)
+
+    # A fresh entry is used instead of asking the driver.
+    assert connect_in_new_process(int(datetime.now().timestamp())) == 123000
+
+    # An entry older than info_cache_ttl is ignored and replaced.
+    assert connect_in_new_process(int(datetime.now().timestamp()) - 2 * 86400) == 123456
+    assert path.read_text().split()[6] != '23'
+
+
 def test_sets_execute(cursor: pyodbc.Cursor):
     # Only lists and tuples are allowed.
     cursor.execute("create table t1 (word varchar (100))")
@@ -1276,6 +1880,16 @@ def test_output_conversion():
     value = cursor.execute("select v from t1").fetchone()[0]
     assert value == '123.45'
 
+    # Converters are looked up when the query is executed, so changing them only affects
+    # result sets from later executes.
+    cursor.execute("select v from t1 union all select v from t1")
+    cnxn.add_output_converter(pyodbc.SQL_VARCHAR, convert1)
+    assert cursor.fetchone()[0] == '123.45'
+    cursor.execute("select v from t1 union all select v from t1")
+    assert cursor.fetchone()[0] == 'X123.45X'
+    cnxn.clear_output_converters()
+    assert cursor.fetchone()[0] == 'X123.45X'
+
 
 def test_too_large(cursor: pyodbc.Cursor):
     """Ensure error raised if insert fails due to truncation"""
@@ -1359,6 +1973,75 @@ def test_large_update_nodata(cursor: pyodbc.Cursor):
     cursor.execute('update t1 set a=? where 1=0', (hundredkb,))
 
 
+@pytest.mark.parametrize('length', [0, 1, 4095, 4096, 4097, 3 * 1024 * 1024 + 1])
+def test_varbinary_max_lengths(cursor: pyodbc.Cursor, length):
+    # Values longer than the first SQLGetData buffer are read directly into the bytes object.
+    cursor.execute('create table t1(a varbinary(max))')
+    value = bytes(i % 251 for i in range(length))
+    cursor.execute('insert into t1 values (?)', value)
+    assert cursor.execute('select a from t1').fetchval() == value
+
+
+def test_open_blob(cursor: pyodbc.Cursor):
+    cursor.execute('create table t1(id int, a varbinary(max), b int)')
+    value = bytes(i % 251 for i in range(1024 * 1024 + 3))
+    cursor.execute('insert into t1 values (1, ?, 10), (2, null, 20)', value)
+
+    cursor.execute('select id, a, b from t1 order by id')
+    with cursor.open_blob('a') as blob:
+        assert blob.values == (1,)
+        buf = bytearray(1000)
+        assert blob.readinto(buf) == 1000
+        assert bytes(buf) == value[:1000]
+        assert blob.read(10) == value[1000:1010]
+        assert blob.read() == value[1010:]
+        assert blob.read() == b''
+
+    blob = cursor.open_blob(1)
+    assert blob.values == (2,)
+    assert blob.read() == b''
+
+    assert cursor.open_blob(1) is None
+    with pytest.raises(pyodbc.ProgrammingError):
+        blob.read()
+
+
+def test_stream_parameters(cursor: pyodbc.Cursor):
+    cursor.execute('create table t1(b varbinary(max), s nvarchar(max))')
+    value = bytes(i % 251 for i in range(300 * 1024))
+    text = 'abc\u4e2d' * 50000
+
+    cursor.execute('insert into t1 values (?, ?)', io.BytesIO(value), (text[i:i + 1000] for i in range(0, len(text), 1000)))
+    cursor.execute('insert into t1 values (?, ?)', iter([b'', value[:10]]), iter(['']))
+
+    rows = cursor.execute('select b, s from t1').fetchall()
+    assert rows[0].b == value
+    assert rows[0].s == text
+    assert rows[1].b == value[:10]
+    assert rows[1].s == ''
+
+    with pytest.raises(TypeError):
+        cursor.execute('insert into t1(b) values (?)', iter([b'x', 'y']))
+
+
+def test_fast_executemany_stream_error(cursor: pyodbc.Cursor):
+    # If reading a stream fails, the execute is cancelled so the cursor can still be used.
+    class BadStream(io.RawIOBase):
+        def readable(self):
+            return True
+
+        def readinto(self, b):
+            raise OSError('read failed')
+
+    cursor.execute('create table t1(n int, b varbinary(max))')
+    cursor.fast_executemany = True
+    with pytest.raises(OSError):
+        cursor.executemany('insert into t1 values (?, ?)', [(1, BadStream())])
+
+    cursor.executemany('insert into t1 values (?, ?)', [(2, io.BytesIO(b'abc'))])
+    assert cursor.execute('select n, b from t1').fetchall() == [(2, b'abc')]
+
+
 def test_func_param(cursor: pyodbc.Cursor):
     try:
         cursor.execute("drop function func1")